@@ -289,6 +289,11 @@ static uint64_t default_hash(const char* key)
     return h;
 }
 
+uint64_t hashmap_default_hash(const char* key)
+{
+    return default_hash(key);
+}
+
 static int __allocate_hashmap(HashMap* h, uint64_t num_els)
 {
     hashmap_node** tmp =
@@ -104,6 +104,10 @@ DLL_PUBLIC void*  hashmap_get(HashMap* h, const char* key);
 DLL_PRIVATE void* hashmap_get_node(
     HashMap* h, const char* key, uint64_t hash, uint64_t* i, int* error);
 
+/* The hash function used when hashmap_init_alt() is called without one,
+   for callers which precompute hashes (see hashmap_get_by_hash64). */
+DLL_PUBLIC uint64_t hashmap_default_hash(const char* key);
+
 /*  Removes a key from the hashmap. NULL will be returned if it is not present.
     If it is designated to be cleaned up, the memory will be free'd and NULL
     returned. Otherwise, the pointer to the value will be returned.
@@ -178,6 +182,15 @@ static __inline__ void* hashmap_get_by_uint32(HashMap* h, uint32_t key)
 }
 
 
+static __inline__ void* hashmap_get_by_hash64(
+    HashMap* h, const char* key, uint64_t hash)
+{
+    int      e;
+    uint64_t i = hash % h->number_nodes;
+    return hashmap_get_node(h, key, hash, &i, &e);
+}
+
+
 static __inline__ void* hashmap_get_by_hash32(HashMap* h, uint32_t hash32)
 {
     char     buf[HASH_UINT32_KEY_LEN] = { 0 };
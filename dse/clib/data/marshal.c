@@ -2,9 +2,13 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#define LOG_MODULE "marshal"
+
 #include <assert.h>
 #include <errno.h>
 #include <string.h>
+#include <time.h>
+#include <inttypes.h>
 #include <dse/testing.h>
 #include <dse/platform.h>
 #include <dse/logger.h>
@@ -24,6 +28,65 @@ typedef struct IndexItem {
 } IndexItem;
 
 
+static MarshalStatsMode __stats_mode = MARSHAL_STATS_DISABLED;
+
+
+static inline uint64_t _stats_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_SOURCE, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+static inline MarshalStats* _stats_get(MarshalStats** stats)
+{
+    if (__stats_mode == MARSHAL_STATS_DISABLED) return NULL;
+    if (*stats == NULL) *stats = calloc(1, sizeof(MarshalStats));
+    return *stats;
+}
+
+
+static void _stats_release(
+    const char* kind, const char* name, MarshalStats** stats)
+{
+    if (*stats == NULL) return;
+    if (__stats_mode == MARSHAL_STATS_DUMP) {
+        MarshalStats* s = *stats;
+        log_notice("Marshal stats: %s %s", kind, name);
+        log_notice("  out: calls=%" PRIu64 " elements=%" PRIu64
+                   " bytes=%" PRIu64 " allocs=%" PRIu64 " ns=%" PRIu64,
+            s->out.calls, s->out.elements, s->out.bytes, s->out.allocs,
+            s->out.ns);
+        log_notice("  in:  calls=%" PRIu64 " elements=%" PRIu64
+                   " bytes=%" PRIu64 " allocs=%" PRIu64 " ns=%" PRIu64,
+            s->in.calls, s->in.elements, s->in.bytes, s->in.allocs, s->in.ns);
+    }
+    free(*stats);
+    *stats = NULL;
+}
+
+
+static inline size_t _scalar_copy_size(MarshalType type)
+{
+    switch (type) {
+    case MARSHAL_TYPE_UINT32:
+    case MARSHAL_TYPE_INT32:
+    case MARSHAL_TYPE_FLOAT:
+    case MARSHAL_TYPE_BYTE4:
+    case MARSHAL_TYPE_BOOL:
+        return sizeof(int32_t);
+    case MARSHAL_TYPE_UINT64:
+    case MARSHAL_TYPE_INT64:
+    case MARSHAL_TYPE_BYTE8:
+    case MARSHAL_TYPE_DOUBLE:
+        return sizeof(double);
+    default:
+        return 0;
+    }
+}
+
+
 static char* _default_string_encode(const char* source, size_t len)
 {
     if (source == NULL || len == 0) return NULL;
@@ -58,7 +121,7 @@ static char* _default_string_decode(const char* source, size_t* len)
 }
 
 
-static inline void _marshal_scalar_out(MarshalGroup* mg)
+static inline void _marshal_scalar_out(MarshalGroup* mg, MarshalCounters* c)
 {
     for (size_t i = 0; i < mg->count; i++) {
         switch (mg->type) {
@@ -88,10 +151,14 @@ static inline void _marshal_scalar_out(MarshalGroup* mg)
             break;
         }
     }
+    if (c) {
+        c->elements += mg->count;
+        c->bytes += mg->count * _scalar_copy_size(mg->type);
+    }
 }
 
 
-static inline void _marshal_scalar_in(MarshalGroup* mg)
+static inline void _marshal_scalar_in(MarshalGroup* mg, MarshalCounters* c)
 {
     for (size_t i = 0; i < mg->count; i++) {
         switch (mg->type) {
@@ -121,10 +188,14 @@ static inline void _marshal_scalar_in(MarshalGroup* mg)
             break;
         }
     }
+    if (c) {
+        c->elements += mg->count;
+        c->bytes += mg->count * _scalar_copy_size(mg->type);
+    }
 }
 
 
-static inline void _marshal_binary_out(MarshalGroup* mg)
+static inline void _marshal_binary_out(MarshalGroup* mg, MarshalCounters* c)
 {
     for (size_t i = 0; i < mg->count; i++) {
         switch (mg->type) {
@@ -149,6 +220,10 @@ static inline void _marshal_binary_out(MarshalGroup* mg)
             log_trace("  source[%d]->target[%d]:  %s (%p:%d)-> %s ",
                 mg->source.offset + i, i, source, source, source_len, target);
             mg->target._string[i] = target;
+            if (c && target) {
+                c->allocs++;
+                c->bytes += source_len;
+            }
         } break;
         case MARSHAL_TYPE_BINARY: {
             char*  source = (char*)mg->source.binary[mg->source.offset + i];
@@ -171,15 +246,20 @@ static inline void _marshal_binary_out(MarshalGroup* mg)
                 target_len);
             mg->target._binary[i] = target;
             mg->target._binary_len[i] = target_len;
+            if (c && target) {
+                c->allocs++;
+                c->bytes += target_len;
+            }
         } break;
         default:
             break;
         }
     }
+    if (c) c->elements += mg->count;
 }
 
 
-static inline void _marshal_binary_in(MarshalGroup* mg)
+static inline void _marshal_binary_in(MarshalGroup* mg, MarshalCounters* c)
 {
     for (size_t i = 0; i < mg->count; i++) {
         switch (mg->type) {
@@ -200,6 +280,10 @@ static inline void _marshal_binary_in(MarshalGroup* mg)
                 mg->source.offset + i, target, source, source, source_len);
             mg->source.binary[mg->source.offset + i] = source;
             mg->source.binary_len[mg->source.offset + i] = source_len;
+            if (c && source) {
+                c->allocs++;
+                c->bytes += source_len;
+            }
         } break;
         case MARSHAL_TYPE_BINARY: {
             char*  source = (char*)mg->source.binary[mg->source.offset + i];
@@ -221,11 +305,16 @@ static inline void _marshal_binary_in(MarshalGroup* mg)
                 mg->source.offset + i, target_len, source, source_len);
             mg->source.binary[mg->source.offset + i] = source;
             mg->source.binary_len[mg->source.offset + i] = source_len;
+            if (c && source) {
+                c->allocs++;
+                c->bytes += source_len;
+            }
         } break;
         default:
             break;
         }
     }
+    if (c) c->elements += mg->count;
 }
 
 
@@ -317,18 +406,25 @@ void marshal_group_out(MarshalGroup* mg_table)
         switch (mg->dir) {
         case MARSHAL_DIRECTION_TXRX:
         case MARSHAL_DIRECTION_TXONLY:
-        case MARSHAL_DIRECTION_PARAMETER:
+        case MARSHAL_DIRECTION_PARAMETER: {
+            MarshalStats*    stats = _stats_get(&mg->stats);
+            MarshalCounters* c = stats ? &stats->out : NULL;
+            uint64_t         t0 = stats ? _stats_now() : 0;
             switch (mg->kind) {
             case MARSHAL_KIND_PRIMITIVE:
-                _marshal_scalar_out(mg);
+                _marshal_scalar_out(mg, c);
                 break;
             case MARSHAL_KIND_BINARY:
-                _marshal_binary_out(mg);
+                _marshal_binary_out(mg, c);
                 break;
             default:
                 break;
             }
-            break;
+            if (c) {
+                c->calls++;
+                c->ns += _stats_now() - t0;
+            }
+        } break;
         default:
             continue;
         }
@@ -382,18 +478,25 @@ void marshal_group_in(MarshalGroup* mg_table)
         case MARSHAL_DIRECTION_TXRX:
         case MARSHAL_DIRECTION_RXONLY:
         case MARSHAL_DIRECTION_PARAMETER:
-        case MARSHAL_DIRECTION_LOCAL:
+        case MARSHAL_DIRECTION_LOCAL: {
+            MarshalStats*    stats = _stats_get(&mg->stats);
+            MarshalCounters* c = stats ? &stats->in : NULL;
+            uint64_t         t0 = stats ? _stats_now() : 0;
             switch (mg->kind) {
             case MARSHAL_KIND_PRIMITIVE:
-                _marshal_scalar_in(mg);
+                _marshal_scalar_in(mg, c);
                 break;
             case MARSHAL_KIND_BINARY:
-                _marshal_binary_in(mg);
+                _marshal_binary_in(mg, c);
                 break;
             default:
                 break;
             }
-            break;
+            if (c) {
+                c->calls++;
+                c->ns += _stats_now() - t0;
+            }
+        } break;
         default:
             continue;
         }
@@ -439,6 +542,7 @@ void marshal_group_destroy(MarshalGroup* mg_table)
         default:
             break;
         }
+        _stats_release("group", mg->name, &mg->stats);
         if (mg->name) free(mg->name);
         if (mg->target.ref) free(mg->target.ref);
         if (mg->target.ptr) free(mg->target.ptr);
@@ -450,6 +554,62 @@ void marshal_group_destroy(MarshalGroup* mg_table)
 }
 
 
+/**
+marshal_group_set_codec
+=======================
+
+Select the string codec of a `MarshalGroup` object (of type
+`MARSHAL_TYPE_STRING`). The codec functions are used for all elements of the
+group, replacing any previously set functions. Binary-to-text codecs are
+available with `dse_text_codec_find()` (i.e. "ascii85", "base64" or "z85").
+
+Parameters
+----------
+mg (MarshalGroup*)
+: A MarshalGroup object (i.e. an item of a MarshalGroup list).
+
+encode (MarshalStringEncode)
+: String encode function, or NULL to select the default encoding.
+
+decode (MarshalStringDecode)
+: String decode function, or NULL to select the default decoding.
+
+Returns
+-------
+0
+: The codec was selected.
+
+EINVAL
+: Invalid MarshalGroup object (or the group is not of type
+  `MARSHAL_TYPE_STRING`).
+
+ENOMEM
+: The function arrays could not be allocated.
+*/
+int marshal_group_set_codec(MarshalGroup* mg, MarshalStringEncode encode,
+    MarshalStringDecode decode)
+{
+    if (mg == NULL || mg->count == 0) return EINVAL;
+    if (mg->type != MARSHAL_TYPE_STRING) return EINVAL;
+
+    if (mg->functions.string_encode == NULL) {
+        mg->functions.string_encode =
+            calloc(mg->count, sizeof(MarshalStringEncode));
+        if (mg->functions.string_encode == NULL) return ENOMEM;
+    }
+    if (mg->functions.string_decode == NULL) {
+        mg->functions.string_decode =
+            calloc(mg->count, sizeof(MarshalStringDecode));
+        if (mg->functions.string_decode == NULL) return ENOMEM;
+    }
+    for (size_t i = 0; i < mg->count; i++) {
+        mg->functions.string_encode[i] = encode;
+        mg->functions.string_decode[i] = decode;
+    }
+    return 0;
+}
+
+
 /**
 marshal_generate_signalmap
 ==========================
@@ -573,6 +733,9 @@ void marshal_signalmap_out(MarshalSignalMap* map)
     log_trace("Marshal SignalMap OUT (signal -> source):");
 
     for (MarshalSignalMap* msm = map; msm && msm->name; msm++) {
+        MarshalStats*    stats = _stats_get(&msm->stats);
+        MarshalCounters* c = stats ? &stats->out : NULL;
+        uint64_t         t0 = stats ? _stats_now() : 0;
         for (size_t i = 0; i < msm->count; i++) {
             size_t sig_idx = msm->signal.index[i];
             size_t src_idx = msm->source.index[i];
@@ -597,6 +760,10 @@ void marshal_signalmap_out(MarshalSignalMap* map)
                         sig_binary_len[sig_idx]);
                     log_trace(
                         "    malloc(%p) %d", src_binary[src_idx], src_idx);
+                    if (c) {
+                        c->allocs++;
+                        c->bytes += sig_binary_len[sig_idx];
+                    }
                 }
                 log_trace("  signal[%d]->source[%d]: (%p:%d)->(%p:%d)", sig_idx,
                     src_idx, sig_binary[sig_idx], sig_binary_len[sig_idx],
@@ -605,8 +772,14 @@ void marshal_signalmap_out(MarshalSignalMap* map)
                 double* src_scalar = msm->source.scalar;
                 double* sig_scalar = msm->signal.scalar;
                 src_scalar[src_idx] = sig_scalar[sig_idx];
+                if (c) c->bytes += sizeof(double);
             }
         }
+        if (c) {
+            c->calls++;
+            c->elements += msm->count;
+            c->ns += _stats_now() - t0;
+        }
     }
 }
 
@@ -630,6 +803,9 @@ void marshal_signalmap_in(MarshalSignalMap* map)
     log_trace("Marshal SignalMap IN (source -> signal):");
 
     for (MarshalSignalMap* msm = map; msm && msm->name; msm++) {
+        MarshalStats*    stats = _stats_get(&msm->stats);
+        MarshalCounters* c = stats ? &stats->in : NULL;
+        uint64_t         t0 = stats ? _stats_now() : 0;
         for (size_t i = 0; i < msm->count; i++) {
             size_t sig_idx = msm->signal.index[i];
             size_t src_idx = msm->source.index[i];
@@ -645,9 +821,16 @@ void marshal_signalmap_in(MarshalSignalMap* map)
                 // Append (deep copy) source -> signal
                 // Note. Signal owns memory.
                 // Note: Source is managed in this module
+                uint32_t buffer_size = sig_binary_buffer_size[sig_idx];
                 dse_buffer_append(&sig_binary[sig_idx],
                     &sig_binary_len[sig_idx], &sig_binary_buffer_size[sig_idx],
                     src_binary[src_idx], src_binary_len[src_idx]);
+                if (c && src_binary[src_idx]) {
+                    if (sig_binary_buffer_size[sig_idx] != buffer_size) {
+                        c->allocs++;
+                    }
+                    c->bytes += src_binary_len[src_idx];
+                }
                 log_trace("  source[%d]->signal[%d]: (%p:%d) -> (%p:%d) ",
                     src_idx, sig_idx, src_binary[src_idx],
                     src_binary_len[src_idx], sig_binary[sig_idx],
@@ -656,8 +839,14 @@ void marshal_signalmap_in(MarshalSignalMap* map)
                 double* src_scalar = msm->source.scalar;
                 double* sig_scalar = msm->signal.scalar;
                 sig_scalar[sig_idx] = src_scalar[src_idx];
+                if (c) c->bytes += sizeof(double);
             }
         }
+        if (c) {
+            c->calls++;
+            c->elements += msm->count;
+            c->ns += _stats_now() - t0;
+        }
     }
 }
 
@@ -680,6 +869,78 @@ void marshal_signalmap_destroy(MarshalSignalMap* map)
     for (MarshalSignalMap* msm = map; msm && msm->name; msm++) {
         if (msm->signal.index) free(msm->signal.index);
         if (msm->source.index) free(msm->source.index);
+        _stats_release("signalmap", msm->name, &msm->stats);
     }
     if (map) free(map);
 }
+
+
+/**
+marshal_stats_mode
+==================
+
+Set the statistics mode of the Marshal API. When enabled, each `MarshalGroup`
+and `MarshalSignalMap` object collects counters (calls, elements, bytes copied,
+allocations and cumulative time) as it is marshalled. Statistics are released
+by `marshal_group_destroy()` and `marshal_signalmap_destroy()`, and logged at
+that time when the mode is `MARSHAL_STATS_DUMP`.
+
+The default mode is `MARSHAL_STATS_DISABLED`, in which case no statistics are
+collected.
+
+Parameters
+----------
+mode (MarshalStatsMode)
+: The statistics mode.
+*/
+void marshal_stats_mode(MarshalStatsMode mode)
+{
+    if (mode >= __MARSHAL_STATS_SIZE__) mode = MARSHAL_STATS_DISABLED;
+    __stats_mode = mode;
+}
+
+
+/**
+marshal_group_stats
+===================
+
+Return the statistics collected for a `MarshalGroup` object.
+
+Parameters
+----------
+mg (MarshalGroup*)
+: A MarshalGroup object (i.e. an item of a MarshalGroup list).
+
+Returns
+-------
+const MarshalStats*
+: The collected statistics, or NULL if no statistics were collected.
+*/
+const MarshalStats* marshal_group_stats(MarshalGroup* mg)
+{
+    if (mg == NULL) return NULL;
+    return mg->stats;
+}
+
+
+/**
+marshal_signalmap_stats
+=======================
+
+Return the statistics collected for a `MarshalSignalMap` object.
+
+Parameters
+----------
+msm (MarshalSignalMap*)
+: A MarshalSignalMap object (i.e. an item of a MarshalSignalMap list).
+
+Returns
+-------
+const MarshalStats*
+: The collected statistics, or NULL if no statistics were collected.
+*/
+const MarshalStats* marshal_signalmap_stats(MarshalSignalMap* msm)
+{
+    if (msm == NULL) return NULL;
+    return msm->stats;
+}
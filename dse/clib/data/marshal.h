@@ -130,6 +130,30 @@ typedef enum MarshalType {
 } MarshalType;
 
 
+/* Runtime statistics, see `marshal_stats_mode()`. */
+typedef struct MarshalCounters {
+    uint64_t calls;
+    uint64_t elements;
+    uint64_t bytes;  /* Bytes copied. */
+    uint64_t allocs; /* Allocations (malloc/calloc) made. */
+    uint64_t ns;     /* Cumulative time (nSec). */
+} MarshalCounters;
+
+typedef struct MarshalStats {
+    MarshalCounters out;
+    MarshalCounters in;
+} MarshalStats;
+
+typedef enum MarshalStatsMode {
+    MARSHAL_STATS_DISABLED = 0,
+    /* Collect statistics. */
+    MARSHAL_STATS_ENABLED,
+    /* Collect statistics, and log them when the object is destroyed. */
+    MARSHAL_STATS_DUMP,
+    __MARSHAL_STATS_SIZE__,
+} MarshalStatsMode;
+
+
 typedef struct MarshalGroup {
     char*       name;
     size_t      count;
@@ -171,8 +195,14 @@ typedef struct MarshalGroup {
         MarshalStringDecode* string_decode;
     } functions;
 
+    /* Statistics (allocated when enabled, released by destroy). */
+    union {
+        MarshalStats* stats;
+        uint64_t      __reserved_stats__;
+    };
+
     /* Reserved. */
-    uint64_t __reserved__[4];
+    uint64_t __reserved__[3];
 } MarshalGroup;
 
 
@@ -258,18 +288,20 @@ typedef struct MarshalSignalMap {
     /* Offset of source relative to its container. Logging only. */
     size_t offset;
 
-    /* Reserved. */
-#if defined(__x86_64__)
-#if __SIZEOF_POINTER__ == 8
-    uint64_t __reserved__[3];
-#else
+    /* Reserved (explicit padding, so that the following fields are 8 byte
+       aligned on all targets). */
+#if __SIZEOF_POINTER__ == 4
     uint32_t __reserved_4__;
-    uint64_t __reserved__[3];
-#endif
-#elif defined(__i386__)
-    uint32_t __reserved_4__;
-    uint64_t __reserved__[3];
 #endif
+
+    /* Statistics (allocated when enabled, released by destroy). */
+    union {
+        MarshalStats* stats;
+        uint64_t      __reserved_stats__;
+    };
+
+    /* Reserved. */
+    uint64_t __reserved__[2];
 } MarshalSignalMap;
 
 
@@ -280,6 +312,8 @@ DLL_PUBLIC size_t marshal_type_size(MarshalType type);
 DLL_PUBLIC void marshal_group_out(MarshalGroup* mg_table);
 DLL_PUBLIC void marshal_group_in(MarshalGroup* mg_table);
 DLL_PUBLIC void marshal_group_destroy(MarshalGroup* mg_table);
+DLL_PUBLIC int  marshal_group_set_codec(MarshalGroup* mg,
+    MarshalStringEncode encode, MarshalStringDecode decode);
 
 /* marshal.c : SIGNAL <-(MarshalSignalMap)-> SOURCE */
 DLL_PUBLIC void marshal_signalmap_out(MarshalSignalMap* map);
@@ -289,5 +323,10 @@ DLL_PUBLIC void marshal_signalmap_destroy(MarshalSignalMap* mg_table);
 DLL_PUBLIC MarshalSignalMap* marshal_generate_signalmap(MarshalMapSpec signal,
     MarshalMapSpec source, SimpleSet* ex_signals, bool is_binary);
 
+/* marshal.c : Statistics. */
+DLL_PUBLIC void                marshal_stats_mode(MarshalStatsMode mode);
+DLL_PUBLIC const MarshalStats* marshal_group_stats(MarshalGroup* mg);
+DLL_PUBLIC const MarshalStats* marshal_signalmap_stats(MarshalSignalMap* msm);
+
 
 #endif  // DSE_CLIB_DATA_MARSHAL_H_
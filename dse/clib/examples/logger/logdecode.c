@@ -0,0 +1,47 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <dse/logger.h>
+#include <dse/clib/util/logger.h>
+
+uint8_t __log_level__ = LOG_INFO;
+
+/* Decode a binary trace (written by the logger) to text.
+ *
+ *      $ logdecode [-t] <trace file>
+ *
+ * Options:
+ *      -t  Prefix each line with the timestamp of the log call.
+ */
+int main(int argc, char** argv)
+{
+    bool        timestamp = false;
+    const char* path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0) {
+            timestamp = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == NULL) {
+        fprintf(stderr, "Usage: %s [-t] <trace file>\n", argv[0]);
+        return EINVAL;
+    }
+
+    FILE* trace = fopen(path, "rb");
+    if (trace == NULL) {
+        perror(path);
+        return errno;
+    }
+    int rc = dse_logger_decode(trace, stdout, timestamp);
+    fclose(trace);
+    if (rc) fprintf(stderr, "%s: %s\n", path, strerror(rc));
+    return rc;
+}
@@ -0,0 +1,42 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#define LOG_MODULE "example"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <dse/logger.h>
+#include <dse/clib/util/logger.h>
+
+uint8_t __log_level__ = LOG_INFO;
+
+/* Written to the working directory, decode with:
+ *      $ logdecode trace.bin */
+#define TRACE_FILE "trace.bin"
+
+int main(void)
+{
+    FILE* trace = fopen(TRACE_FILE, "wb");
+    if (trace == NULL) return 1;
+
+    // Start the logger, writing a binary trace.
+    DseLoggerConfig config = {
+        .stream = trace,
+        .policy = DSE_LOGGER_BLOCK,
+        .format = DSE_LOGGER_BINARY,
+    };
+    dse_logger_start(&config);
+
+    // Trace this module only, other modules use the global log level.
+    dse_logger_set_module_level("example", LOG_TRACE);
+    for (int step = 0; step < 10; step++) {
+        log_trace("step %d: signal %s = %f", step, "foo", step * 0.1);
+    }
+    log_info("Trace complete");
+
+    dse_logger_stop();
+    fclose(trace);
+    printf("Trace written to %s\n", TRACE_FILE);
+    return 0;
+}
@@ -2,11 +2,269 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#define LOG_MODULE "functional"
+
+#include <errno.h>
+#include <stdbool.h>
 #include <dse/logger.h>
 #include <dse/clib/collections/hashlist.h>
 #include <dse/clib/functional/functor.h>
 
 
+#define FUSED_ARRAY_SIZE 64
+
+
+typedef struct FusedPipeline {
+    FunctorFunc* stages;
+    size_t       count;
+    void*        reference;
+    size_t       typesize;
+    /* Resultant, an array (for a fold to array/ntlist) otherwise a list. */
+    uint8_t*       array;
+    size_t         length;
+    size_t         size;
+    HashList*      list;
+    FunctorDestroy destroy;
+} FusedPipeline;
+
+
+/* Reserve space in the resultant array for length elements (and a
+terminating element). */
+static int _fused_reserve(FusedPipeline* p, size_t length)
+{
+    if (length < p->size) return 0;
+    size_t size = p->size * 2;
+    while (size <= length) size *= 2;
+    uint8_t* array = realloc(p->array, size * p->typesize);
+    if (array == NULL) return ENOMEM;
+    memset(array + p->size * p->typesize, 0, (size - p->size) * p->typesize);
+    p->array = array;
+    p->size = size;
+    return 0;
+}
+
+
+static void _fused_emit(FusedPipeline* p, void* o, FunctorDestroy destroy)
+{
+    if (p->list) {
+        hashlist_append(p->list, o);
+        p->destroy = destroy;
+        return;
+    }
+
+    /* Fold is a shallow copy, only delete the object container. */
+    if (_fused_reserve(p, p->length + 1)) return;
+    memcpy(p->array + p->length * p->typesize, o, p->typesize);
+    p->length++;
+    if (destroy) free(o);
+}
+
+
+/* Apply the stages, from stage, to an object. The object is the result of
+the previous stage (and is destroyed after the stage), or an element of the
+start object (destroy is NULL). */
+static void _fused_apply(
+    FusedPipeline* p, size_t stage, void* o, FunctorDestroy destroy)
+{
+    for (; stage < p->count; stage++) {
+        FunctorType _f = p->stages[stage](o, p->reference);
+        if (destroy) destroy(o);
+        if (_f.__object__ == NULL) return;
+        o = _f.__object__;
+        destroy = _f.destroy;
+    }
+    _fused_emit(p, o, destroy);
+}
+
+
+#ifdef FUNCTIONAL_PARALLEL
+typedef struct FusedParallel {
+    FunctorType*   start;
+    FusedPipeline* chunks;
+} FusedParallel;
+
+
+static void _fused_chunk(void* data, size_t chunk, size_t begin, size_t end)
+{
+    FusedParallel* fp = data;
+    FusedPipeline* p = &fp->chunks[chunk];
+    uint8_t*       o = fp->start->__object__;
+    for (size_t i = begin; i < end; i++) {
+        _fused_apply(p, 0, o + i * p->typesize, NULL);
+    }
+}
+
+
+/* Each chunk of the array is passed through the stages to its own resultant,
+which are then joined (in order). */
+static void _fused_join(FusedPipeline* p, FusedPipeline* c)
+{
+    if (c->array) {
+        if (_fused_reserve(p, p->length + c->length + 1) == 0) {
+            memcpy(p->array + p->length * p->typesize, c->array,
+                c->length * c->typesize);
+            p->length += c->length;
+        }
+    } else {
+        for (size_t j = 0; j < hashlist_length(c->list); j++) {
+            hashlist_append(p->list, hashlist_at(c->list, j));
+        }
+    }
+    if (c->destroy) p->destroy = c->destroy;
+}
+
+
+static int _fused_parallel(FusedPipeline* p, FunctorType* start, size_t chunks)
+{
+    FusedParallel fp = {
+        .start = start,
+        .chunks = calloc(chunks, sizeof(FusedPipeline)),
+    };
+    if (fp.chunks == NULL) return ENOMEM;
+    size_t size = start->count / chunks + 2;
+    int    rc = 0;
+    for (size_t i = 0; i < chunks && rc == 0; i++) {
+        FusedPipeline* c = &fp.chunks[i];
+        *c = (FusedPipeline){
+            .stages = p->stages,
+            .count = p->count,
+            .reference = p->reference,
+            .typesize = p->typesize,
+        };
+        if (p->array) {
+            c->size = size;
+            c->array = calloc(size, c->typesize);
+            if (c->array == NULL) rc = ENOMEM;
+        } else {
+            c->list = calloc(1, sizeof(HashList));
+            if (c->list == NULL) rc = ENOMEM;
+            if (c->list) hashlist_init(c->list, size);
+        }
+    }
+    if (rc == 0) {
+        log_trace("Operator FUSED parallel (%zu chunks):", chunks);
+        functional_parallel_run(start, start->count, chunks, _fused_chunk, &fp);
+    }
+
+    for (size_t i = 0; i < chunks; i++) {
+        FusedPipeline* c = &fp.chunks[i];
+        if (rc == 0) _fused_join(p, c);
+        free(c->array);
+        if (c->list) {
+            hashlist_destroy(c->list);
+            free(c->list);
+        }
+    }
+    free(fp.chunks);
+    return rc;
+}
+#endif
+
+
+static FunctorType _operation_fused(
+    FunctorType* start, void* reference, va_list args)
+{
+    FunctorFold   fold = start->fold;
+    FusedPipeline p = {
+        .reference = reference,
+        .typesize = start->__typesize__,
+    };
+
+    /* Stages. */
+    va_list _args;
+    va_copy(_args, args);
+    while (va_arg(_args, FunctorFunc)) p.count++;
+    va_end(_args);
+    p.stages = calloc(p.count + 1, sizeof(FunctorFunc));
+    for (size_t i = 0; i < p.count; i++) {
+        p.stages[i] = va_arg(args, FunctorFunc);
+    }
+
+    /* Resultant. */
+    if (fold == functional_fold_array || fold == functional_fold_ntlist) {
+        p.size = FUSED_ARRAY_SIZE;
+        if (start->map == functional_map_array && start->count >= p.size) {
+            p.size = start->count + 1;
+        }
+        p.array = calloc(p.size, p.typesize);
+    } else {
+        p.list = calloc(1, sizeof(HashList));
+        hashlist_init(p.list, FUSED_ARRAY_SIZE);
+    }
+
+    /* Apply the stages to each element. */
+    uint8_t* o = start->__object__;
+    bool     parallel = false;
+#ifdef FUNCTIONAL_PARALLEL
+    if (start->map == functional_map_array && functional_parallel_chunks) {
+        size_t chunks = functional_parallel_chunks(start, start->count);
+        if (chunks) parallel = (_fused_parallel(&p, start, chunks) == 0);
+    }
+#endif
+    if (parallel) {
+        /* Mapped in parallel, otherwise sequential (below). */
+    } else if (start->map == functional_map_array) {
+        for (size_t i = 0; i < start->count; i++) {
+            _fused_apply(&p, 0, o + i * p.typesize, NULL);
+        }
+    } else if (start->map == functional_map_hashlist) {
+        for (size_t i = 0; i < hashlist_length(start->__object__); i++) {
+            _fused_apply(&p, 0, hashlist_at(start->__object__, i), NULL);
+        }
+    } else {
+        uint8_t* zero_block = calloc(p.typesize, sizeof(uint8_t));
+        for (; memcmp(o, zero_block, p.typesize); o += p.typesize) {
+            if (p.count == 0) {
+                _fused_emit(&p, o, NULL);
+                continue;
+            }
+            FunctorType _f = p.stages[0](o, reference);
+            if (_f.__object__ == NULL) continue;
+            if (_f.count) {
+                // Single object.
+                _fused_apply(&p, 1, _f.__object__, _f.destroy);
+            } else {
+                // Hashlist of objects.
+                for (size_t i = 0; i < hashlist_length(_f.__object__); i++) {
+                    void* _o = hashlist_at(_f.__object__, i);
+                    _fused_apply(&p, 1, _o, _f.destroy);
+                }
+                hashlist_destroy(_f.__object__);
+                free(_f.__object__);
+            }
+        }
+        free(zero_block);
+    }
+    free(p.stages);
+
+    if (p.array) {
+        return (FunctorType){
+            .__object__ = p.array,
+            .__typesize__ = p.typesize,
+            .count = p.length,
+        };
+    }
+    FunctorType functor = {
+        .__object__ = p.list,
+        .__typesize__ = p.typesize,
+        .map = functional_map_hashlist,
+        .destroy = p.destroy,
+    };
+    if (fold == NULL) return functor;
+
+    /* Other fold functions, as operation(). */
+    FunctorType folded = fold(&functor);
+    if (functor.destroy) {
+        for (size_t i = 0; i < hashlist_length(functor.__object__); i++) {
+            free(hashlist_at(functor.__object__, i));
+        }
+    }
+    hashlist_destroy(functor.__object__);
+    free(functor.__object__);
+    return folded;
+}
+
+
 FunctorType(operation)(FunctorType* start, void* reference, ...)
 {
     FunctorFold fold = start->fold;
@@ -14,6 +272,15 @@ FunctorType(operation)(FunctorType* start, void* reference, ...)
 
     va_list args;
     va_start(args, reference);
+    if ((start->flags & FUNCTOR_FUSED) &&
+        (start->map == functional_map_array ||
+            start->map == functional_map_ntlist ||
+            start->map == functional_map_hashlist)) {
+        log_trace("Operator call functor FUSED:");
+        FunctorType fused = _operation_fused(start, reference, args);
+        va_end(args);
+        return fused;
+    }
     FunctorFunc f;
     int         count = 0;
     while ((f = va_arg(args, FunctorFunc))) {
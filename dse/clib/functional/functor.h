@@ -17,11 +17,33 @@ typedef FunctorType (*FunctorFunc)(void* o, void* r);
 typedef FunctorType (*FunctorMap)(FunctorFunc f, FunctorType* t, void* r);
 typedef FunctorType (*FunctorFold)(FunctorType* t);
 typedef void (*FunctorDestroy)(void* o);
+typedef void (*FunctorChunkFunc)(
+    void* data, size_t chunk, size_t begin, size_t end);
 
 
 #define NVA_ARGS(...) (sizeof((int[]){ 0, ##__VA_ARGS__ }) / sizeof(int) - 1)
 
 
+/* Operation flags (set on the start functor of an operation).
+
+FUNCTOR_FUSED
+: Chained map stages are applied to each element in turn, and the result
+  passed directly to the fold, without intermediate HashLists. Requires a
+  map function of this library (array, ntlist or hashlist).
+
+FUNCTOR_PARALLEL
+: Array elements are mapped in parallel, on the thread pool of the start
+  functor (`pool`), when the array has at least `threshold` elements
+  (default FUNCTOR_PARALLEL_THRESHOLD). The order of the resultant is
+  preserved. Map functions must be independent of each other (pure). The
+  pool may be shared, an operation only waits for its own jobs. Requires
+  `parallel.c` (and `util/threadpool.c`, pthread), otherwise operations are
+  sequential. */
+#define FUNCTOR_FUSED              0x01
+#define FUNCTOR_PARALLEL           0x02
+#define FUNCTOR_PARALLEL_THRESHOLD 1024
+
+
 typedef struct FunctorType {
     uint32_t       __typehash__;
     size_t         __typesize__;
@@ -35,6 +57,10 @@ typedef struct FunctorType {
     FunctorMap     map;
     FunctorFold    fold;
     FunctorDestroy destroy;  // called per object.
+    uint32_t       flags;
+    /* Parallel map (FUNCTOR_PARALLEL). */
+    struct DseThreadPool* pool;
+    size_t                threshold;
 } FunctorType;
 
 
@@ -71,4 +97,15 @@ FunctorType functional_fold_ntlist(FunctorType* t);
 FunctorType functional_hashlist_fold(FunctorType* t);
 
 
+/* parallel.c (optional, weak references). Without weak references the
+operations are sequential. */
+#if defined(__GNUC__) && !defined(_WIN32)
+#define FUNCTIONAL_PARALLEL 1
+size_t functional_parallel_chunks(FunctorType* t, size_t count)
+    __attribute__((weak));
+void   functional_parallel_run(FunctorType* t, size_t count, size_t chunks,
+    FunctorChunkFunc func, void* data) __attribute__((weak));
+#endif
+
+
 #endif  // DSE_CLIB_FUNCTIONAL_FUNCTOR_H_
@@ -2,6 +2,8 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#define LOG_MODULE "functional"
+
 #include <assert.h>
 #include <stdlib.h>
 #include <dse/logger.h>
@@ -9,11 +11,89 @@
 #include <dse/clib/functional/functor.h>
 
 
+#ifdef FUNCTIONAL_PARALLEL
+typedef struct MapArrayParallel {
+    FunctorFunc     f;
+    FunctorType*    t;
+    void*           r;
+    void**          objects;
+    FunctorDestroy* destroy; /* Per chunk. */
+} MapArrayParallel;
+
+
+static void _map_array_chunk(void* data, size_t chunk, size_t begin, size_t end)
+{
+    MapArrayParallel* m = data;
+    for (size_t i = begin; i < end; i++) {
+        uint8_t* array_element = (uint8_t*)m->t->__object__;
+        array_element += (i * m->t->__typesize__);
+        FunctorType _f = m->f(array_element, m->r);
+        m->objects[i] = _f.__object__;
+        if (_f.__object__) m->destroy[chunk] = _f.destroy;
+    }
+}
+
+
+static FunctorType _map_array_parallel(
+    FunctorFunc f, FunctorType* t, void* r, size_t chunks)
+{
+    log_trace("  Map array (parallel, %zu chunks):", chunks);
+
+    MapArrayParallel m = {
+        .f = f,
+        .t = t,
+        .r = r,
+        .objects = calloc(t->count, sizeof(void*)),
+        .destroy = calloc(chunks, sizeof(FunctorDestroy)),
+    };
+    if (m.objects == NULL || m.destroy == NULL) {
+        /* The caller maps the array sequentially. */
+        free(m.objects);
+        free(m.destroy);
+        return (FunctorType){ 0 };
+    }
+    functional_parallel_run(t, t->count, chunks, _map_array_chunk, &m);
+
+    /* Resultant, in order. */
+    FunctorDestroy destroy_func = NULL;
+    HashList*      list = calloc(1, sizeof(HashList));
+    hashlist_init(list, t->count);
+    for (size_t i = 0; i < t->count; i++) {
+        if (m.objects[i]) hashlist_append(list, m.objects[i]);
+    }
+    for (size_t i = 0; i < chunks; i++) {
+        if (m.destroy[i]) destroy_func = m.destroy[i];
+    }
+    free(m.objects);
+    free(m.destroy);
+
+    FunctorType ret_t = {
+        .__object__ = list,
+        .__typesize__ = t->__typesize__,
+        .map = functional_map_hashlist,
+        .destroy = destroy_func,
+    };
+    return ret_t;
+}
+#endif
+
+
 FunctorType functional_map_array(FunctorFunc f, FunctorType* t, void* r)
 {
     assert(t->__object__);
     assert(t->__typesize__);
 
+#ifdef FUNCTIONAL_PARALLEL
+    size_t chunks = 0;
+    if (functional_parallel_chunks) {
+        chunks = functional_parallel_chunks(t, t->count);
+    }
+    if (chunks) {
+        FunctorType ret_t = _map_array_parallel(f, t, r, chunks);
+        if (ret_t.__object__) return ret_t;
+    }
+#endif
+
     log_trace("  Map array:");
 
     FunctorDestroy destroy_func = NULL;
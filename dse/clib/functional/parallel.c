@@ -0,0 +1,115 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#define LOG_MODULE "functional"
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <dse/logger.h>
+#include <dse/clib/util/threadpool.h>
+#include <dse/clib/functional/functor.h>
+
+
+#define PARALLEL_CHUNKS_PER_THREAD 4
+#define PARALLEL_CHUNK_MIN         256
+
+
+/* Counts the chunks of one call which have not completed, the pool may be
+shared with other operations (or other users). */
+typedef struct ParallelLatch {
+    pthread_mutex_t lock;
+    pthread_cond_t  done;
+    size_t          pending;
+} ParallelLatch;
+
+typedef struct ParallelJob {
+    FunctorChunkFunc func;
+    void*            data;
+    size_t           chunk;
+    size_t           begin;
+    size_t           end;
+    ParallelLatch*   latch;
+} ParallelJob;
+
+
+static void _parallel_job(void* arg)
+{
+    ParallelJob* job = arg;
+    job->func(job->data, job->chunk, job->begin, job->end);
+
+    ParallelLatch* latch = job->latch;
+    pthread_mutex_lock(&latch->lock);
+    if (--latch->pending == 0) pthread_cond_signal(&latch->done);
+    pthread_mutex_unlock(&latch->lock);
+}
+
+
+/* Number of chunks for a parallel operation over count elements, or 0 if the
+operation should not run in parallel. */
+size_t functional_parallel_chunks(FunctorType* t, size_t count)
+{
+    if ((t->flags & FUNCTOR_PARALLEL) == 0 || t->pool == NULL) return 0;
+    size_t threshold = t->threshold ? t->threshold : FUNCTOR_PARALLEL_THRESHOLD;
+    if (count < threshold) return 0;
+
+    size_t chunks =
+        (dse_threadpool_size(t->pool) + 1) * PARALLEL_CHUNKS_PER_THREAD;
+    if (chunks > count / PARALLEL_CHUNK_MIN) {
+        chunks = count / PARALLEL_CHUNK_MIN;
+    }
+    return chunks ? chunks : 1;
+}
+
+
+/* Run func for each chunk (a contiguous range of the count elements) on the
+thread pool, and wait for those chunks to complete. The calling thread runs
+the last chunk, and then other queued jobs of the pool while it waits. */
+void functional_parallel_run(FunctorType* t, size_t count, size_t chunks,
+    FunctorChunkFunc func, void* data)
+{
+    ParallelJob* jobs = calloc(chunks, sizeof(ParallelJob));
+    if (jobs == NULL) {
+        log_debug("Parallel map: no memory, run on the calling thread");
+        for (size_t i = 0; i < chunks; i++) {
+            func(data, i, count * i / chunks, count * (i + 1) / chunks);
+        }
+        return;
+    }
+
+    ParallelLatch latch = { .pending = chunks };
+    pthread_mutex_init(&latch.lock, NULL);
+    pthread_cond_init(&latch.done, NULL);
+    for (size_t i = 0; i < chunks; i++) {
+        jobs[i] = (ParallelJob){
+            .func = func,
+            .data = data,
+            .chunk = i,
+            .begin = count * i / chunks,
+            .end = count * (i + 1) / chunks,
+            .latch = &latch,
+        };
+        if (i == chunks - 1 ||
+            dse_threadpool_submit(t->pool, _parallel_job, &jobs[i])) {
+            _parallel_job(&jobs[i]);
+        }
+    }
+
+    /* Help the pool until none of the chunks remain queued, then wait for
+    the chunks which are still running. */
+    for (;;) {
+        pthread_mutex_lock(&latch.lock);
+        size_t pending = latch.pending;
+        pthread_mutex_unlock(&latch.lock);
+        if (pending == 0) break;
+        if (dse_threadpool_run_one(t->pool)) continue;
+
+        pthread_mutex_lock(&latch.lock);
+        while (latch.pending) pthread_cond_wait(&latch.done, &latch.lock);
+        pthread_mutex_unlock(&latch.lock);
+        break;
+    }
+    pthread_cond_destroy(&latch.done);
+    pthread_mutex_destroy(&latch.lock);
+    free(jobs);
+}
@@ -4,21 +4,483 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#include <dse/clib/collections/hashmap.h>
 #include <dse/clib/collections/vector.h>
 #include <dse/clib/util/strings.h>
 #include <dse/clib/ini/ini.h>
 
 
-#define UNUSED(x)     ((void)x)
-#define LINE_MAX_SIZE 1024
+#define UNUSED(x)         ((void)x)
+#define LINE_MAX_SIZE     1024
+#define INDEX_MAP_SIZE    64
+#define INDEX_COMPACT_MIN 64
+#define INDEX_SEP         '\x1f'
+
+
+/* Lines are stored in slots of the lines vector (in the order they were
+added) and are linked in file order. The slot of a line does not change until
+the lines are compacted, so a line can be added anywhere in the file without
+moving other lines. Links, and the head/tail/global fields of IniDesc, hold
+the slot + 1 of a line (0 for none). */
+typedef struct IniLine {
+    char*  line;    /* NULL for a deleted line (a tombstone). */
+    size_t next;    /* The following line. */
+    size_t section; /* The section line (a section line references itself). */
+    size_t last;    /* Section lines only: the last line of the section. */
+} IniLine;
+
+
+static IniLine* __ini_slot(IniDesc* ini, size_t slot)
+{
+    return vector_at(&ini->lines, slot, NULL);
+}
+
+
+static char* __ini_line(IniDesc* ini, size_t slot)
+{
+    IniLine* _ = __ini_slot(ini, slot);
+    return _ ? _->line : NULL;
+}
+
+
+static size_t __ini_insert(IniDesc* ini, size_t after, char* line)
+{
+    /* Link the line following the line at slot after - 1 (or as the first
+    line when after is 0). */
+    IniLine item = { .line = line };
+    vector_push(&ini->lines, &item);
+    size_t   slot = vector_len(&ini->lines) - 1;
+    IniLine* l = __ini_slot(ini, slot);
+    if (after) {
+        IniLine* prev = __ini_slot(ini, after - 1);
+        l->next = prev->next;
+        prev->next = slot + 1;
+    } else {
+        l->next = ini->head;
+        ini->head = slot + 1;
+    }
+    if (l->next == 0) ini->tail = slot + 1;
+    return slot;
+}
+
+
+static void __ini_free_line(IniDesc* ini, char* line)
+{
+    /* Lines loaded by ini_open() may reference the mapped file. */
+    if (ini->map && line >= ini->map && line < ini->map + ini->map_size) {
+        return;
+    }
+    free(line);
+}
+
+
+static void __ini_unmap(IniDesc* ini)
+{
+#ifndef _WIN32
+    if (ini->map) munmap(ini->map, ini->map_size);
+#endif
+    ini->map = NULL;
+    ini->map_size = 0;
+}
+
+
+static void __ini_detach(IniDesc* ini)
+{
+    /* Copy lines which reference the mapped file, and release the mapping
+    (i.e. before the file is written, which would truncate the mapping). */
+    if (ini->map == NULL) return;
+    for (size_t i = 0; i < vector_len(&ini->lines); i++) {
+        IniLine* l = __ini_slot(ini, i);
+        if (l->line == NULL) continue;
+        if (l->line < ini->map || l->line >= ini->map + ini->map_size) {
+            continue;
+        }
+        l->line = strdup(l->line);
+    }
+    __ini_unmap(ini);
+    /* Index keys are copies, the index remains valid. */
+}
+
+
+static const char* __ini_section_name(const char* line, size_t* len)
+{
+    /* Section lines have the form "[name]". */
+    if (line == NULL || line[0] != '[') return NULL;
+    const char* end = strchr(line, ']');
+    if (end == NULL) return NULL;
+    *len = end - (line + 1);
+    return line + 1;
+}
+
+
+static size_t __ini_key_len(const char* line)
+{
+    const char* pos = strpbrk(line, "=");
+    return pos ? (size_t)(pos - line) : SIZE_MAX;
+}
+
+
+/* Index keys:
+    key                 -> "key" (the first line with key, in any section)
+    key in section      -> "section\x1fkey"
+    section             -> "section" (in the section map)
+*/
+static char* __ini_index_key(char* buf, const char* section, size_t section_len,
+    const char* key, size_t key_len)
+{
+    size_t len = (section ? section_len + 1 : 0) + key_len + 1;
+    char*  index_key = (len <= LINE_MAX_SIZE) ? buf : malloc(len);
+    if (index_key == NULL) return NULL;
+    char* p = index_key;
+    if (section) {
+        memcpy(p, section, section_len);
+        p += section_len;
+        *p++ = INDEX_SEP;
+    }
+    memcpy(p, key, key_len);
+    p[key_len] = '\0';
+    return index_key;
+}
+
+
+static bool __ini_precedes(IniDesc* ini, size_t slot, size_t other)
+{
+    /* Sections are only added at the end of the file, and keys at the end of
+    their section, so a line added later precedes an indexed line only when
+    its section precedes (section lines are ordered by slot). */
+    return __ini_slot(ini, slot)->section < __ini_slot(ini, other)->section;
+}
+
+
+static void __ini_index_set(
+    IniDesc* ini, HashMap* map, char* index_key, char* buf, size_t slot)
+{
+    if (index_key == NULL) return;
+    uintptr_t indexed = (uintptr_t)hashmap_get(map, index_key);
+    if (indexed == 0 || __ini_precedes(ini, slot, indexed - 1)) {
+        hashmap_set(map, index_key, (void*)(uintptr_t)(slot + 1));
+    }
+    if (indexed) ini->duplicates = true;
+    if (index_key != buf) free(index_key);
+}
+
+
+static size_t __ini_index_get(
+    HashMap* map, const char* section, const char* key, size_t key_len)
+{
+    char   buf[LINE_MAX_SIZE];
+    size_t section_len = section ? strlen(section) : 0;
+    char*  index_key = __ini_index_key(buf, section, section_len, key, key_len);
+    if (index_key == NULL) return 0;
+    uintptr_t slot = (uintptr_t)hashmap_get(map, index_key);
+    if (index_key != buf) free(index_key);
+    return slot;
+}
+
+
+/* The key index maps each key to the slot (+1) of its line in the lines
+vector. Deleted lines leave a NULL line (a tombstone) so that the slots of
+other lines remain valid, tombstones are removed when they exceed half of the
+lines. When a key appears on several lines, the first line is indexed. */
+static void __ini_index_line(
+    IniDesc* ini, size_t slot, const char* section, size_t section_len)
+{
+    char  buf[LINE_MAX_SIZE];
+    char* line = __ini_line(ini, slot);
+    if (line == NULL) return;
+
+    size_t      name_len;
+    const char* name = __ini_section_name(line, &name_len);
+    if (name) {
+        char* index_key = __ini_index_key(buf, NULL, 0, name, name_len);
+        __ini_index_set(ini, &ini->sections, index_key, buf, slot);
+        return;
+    }
+    size_t key_len = __ini_key_len(line);
+    if (key_len == SIZE_MAX) return;
+    char* index_key = __ini_index_key(buf, NULL, 0, line, key_len);
+    __ini_index_set(ini, &ini->index, index_key, buf, slot);
+    if (section) {
+        index_key = __ini_index_key(buf, section, section_len, line, key_len);
+        __ini_index_set(ini, &ini->index, index_key, buf, slot);
+    }
+}
+
+
+static void __ini_index(IniDesc* ini)
+{
+    /* Build the index on first use (i.e. IniDesc not from ini_open()). */
+    if (ini->index.nodes != NULL) return;
+    hashmap_init_alt(&ini->index, INDEX_MAP_SIZE, NULL);
+    hashmap_init_alt(&ini->sections, INDEX_MAP_SIZE, NULL);
+    ini->tombstones = 0;
+    ini->duplicates = false;
+    ini->global = 0;
+    const char* section = NULL;
+    size_t      section_len = 0;
+    size_t      section_slot = 0;
+    for (size_t s = ini->head; s; s = __ini_slot(ini, s - 1)->next) {
+        IniLine*    l = __ini_slot(ini, s - 1);
+        size_t      name_len;
+        const char* name = __ini_section_name(l->line, &name_len);
+        if (name) {
+            section = name;
+            section_len = name_len;
+            section_slot = s;
+        }
+        /* Section membership, and the end of each section. */
+        l->section = section_slot;
+        if (section_slot) {
+            __ini_slot(ini, section_slot - 1)->last = s;
+        } else {
+            ini->global = s;
+        }
+        if (l->line == NULL) {
+            ini->tombstones++;
+            continue;
+        }
+        __ini_index_line(ini, s - 1, section, section_len);
+    }
+}
+
+
+static void __ini_reindex(IniDesc* ini)
+{
+    if (ini->index.nodes) hashmap_destroy(&ini->index);
+    if (ini->sections.nodes) hashmap_destroy(&ini->sections);
+    ini->index = (HashMap){ 0 };
+    ini->sections = (HashMap){ 0 };
+    __ini_index(ini);
+}
+
+
+static void __ini_compact(IniDesc* ini)
+{
+    if (ini->tombstones < INDEX_COMPACT_MIN) return;
+    if (ini->tombstones * 2 < vector_len(&ini->lines)) return;
+
+    /* Remove the tombstones (lines are stored in file order), then reindex. */
+    size_t length = vector_len(&ini->lines) - ini->tombstones;
+    Vector lines = vector_make(sizeof(IniLine), length, NULL);
+    for (size_t s = ini->head; s;) {
+        IniLine* l = __ini_slot(ini, s - 1);
+        s = l->next;
+        if (l->line == NULL) continue;
+        IniLine item = { .line = l->line, .next = vector_len(&lines) + 2 };
+        vector_push(&lines, &item);
+    }
+    length = vector_len(&lines);
+    if (length) {
+        IniLine* l = vector_at(&lines, length - 1, NULL);
+        l->next = 0;
+    }
+    vector_reset(&ini->lines);
+    ini->lines = lines;
+    ini->head = length ? 1 : 0;
+    ini->tail = length;
+    __ini_reindex(ini);
+}
+
+
+static const char* __ini_section_of(IniDesc* ini, size_t slot, size_t* len)
+{
+    size_t section = __ini_slot(ini, slot)->section;
+    if (section == 0) return NULL;
+    return __ini_section_name(__ini_line(ini, section - 1), len);
+}
+
+
+static size_t __ini_add(IniDesc* ini, char* line, size_t section)
+{
+    /* Add a line at the end of a section (the slot + 1 of the section line,
+    or 0 for the lines before the first section). A section line is added at
+    the end of the file. */
+    size_t      len = 0;
+    const char* name = __ini_section_name(line, &len);
+    size_t      after = ini->global;
+    if (name) {
+        after = ini->tail;
+    } else if (section) {
+        after = __ini_slot(ini, section - 1)->last;
+    }
+    size_t slot = __ini_insert(ini, after, line);
+    if (name) section = slot + 1;
+    __ini_slot(ini, slot)->section = section;
+    if (section) {
+        __ini_slot(ini, section - 1)->last = slot + 1;
+        name = __ini_section_of(ini, slot, &len);
+    } else {
+        ini->global = slot + 1;
+    }
+    __ini_index_line(ini, slot, name, len);
+    return slot;
+}
+
+
+static void __ini_reindex_key(IniDesc* ini, const char* section,
+    const char* key, size_t key_len, size_t slot)
+{
+    /* After a delete, the key may also appear on a following line. */
+    char buf[LINE_MAX_SIZE];
+    for (size_t s = __ini_slot(ini, slot)->next; s;
+         s = __ini_slot(ini, s - 1)->next) {
+        size_t i = s - 1;
+        char*  line = __ini_line(ini, i);
+        if (line == NULL) continue;
+        size_t len;
+        if (__ini_section_name(line, &len)) {
+            if (section) return;
+            continue;
+        }
+        if (__ini_key_len(line) != key_len) continue;
+        if (strncmp(line, key, key_len) != 0) continue;
+        char* index_key = __ini_index_key(
+            buf, section, section ? strlen(section) : 0, key, key_len);
+        __ini_index_set(ini, &ini->index, index_key, buf, i);
+        return;
+    }
+}
+
+
+static void __ini_delete_line(IniDesc* ini, size_t slot)
+{
+    char buf[LINE_MAX_SIZE];
+    char name[LINE_MAX_SIZE];
+    char key[LINE_MAX_SIZE];
+
+    char*  line = __ini_line(ini, slot);
+    size_t key_len = __ini_key_len(line);
+    if (key_len >= sizeof(key)) key_len = sizeof(key) - 1;
+    memcpy(key, line, key_len);
+    key[key_len] = '\0';
+    size_t      name_len = 0;
+    const char* section = __ini_section_of(ini, slot, &name_len);
+    if (section) {
+        if (name_len >= sizeof(name)) name_len = sizeof(name) - 1;
+        memcpy(name, section, name_len);
+        name[name_len] = '\0';
+        section = name;
+    }
+
+    /* Replace the line with a tombstone. */
+    __ini_slot(ini, slot)->line = NULL;
+    __ini_free_line(ini, line);
+    ini->tombstones++;
+
+    /* Remove the index keys which reference the line. */
+    for (int i = 0; i < 2; i++) {
+        const char* s = i ? section : NULL;
+        if (i && s == NULL) break;
+        if (__ini_index_get(&ini->index, s, key, key_len) != slot + 1) {
+            continue;
+        }
+        char* index_key =
+            __ini_index_key(buf, s, s ? name_len : 0, key, key_len);
+        if (index_key == NULL) continue;
+        hashmap_remove(&ini->index, index_key);
+        if (index_key != buf) free(index_key);
+        if (ini->duplicates) {
+            __ini_reindex_key(ini, s, key, key_len, slot);
+        }
+    }
+    __ini_compact(ini);
+}
+
+
+static char* __ini_make_line(const char* key, const char* val)
+{
+    size_t line_length = strlen(key) + strlen(val) + 2;
+    char*  line = calloc(line_length, sizeof(char));
+    if (line) snprintf(line, line_length, "%s=%s", key, val);
+    return line;
+}
+
+
+static void __ini_add_line(IniDesc* ini, char* line, bool copy)
+{
+    while (*line == ' ') {
+        line++;
+    } /* Trim leading space characters. */
+    size_t len;
+    if (strpbrk(line, "=") == NULL && __ini_section_name(line, &len) == NULL) {
+        return; /* Not key=value pair, or section. */
+    }
+    if (copy) line = strdup(line);
+    __ini_insert(ini, ini->tail, line);
+}
+
+
+#ifndef _WIN32
+static bool __ini_load_mmap(IniDesc* ini, const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+    /* A private (copy-on-write) mapping, lines are terminated in place. */
+    char* map = mmap(
+        NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+    ini->map = map;
+    ini->map_size = st.st_size;
+
+    char* p = map;
+    char* end = map + st.st_size;
+    while (p < end) {
+        char* line = p;
+        char* eol = memchr(p, '\n', end - p);
+        if (eol == NULL) {
+            /* Last line without a newline, no space to terminate. */
+            line = strndup(line, end - line);
+            if (line == NULL) break;
+            line[strcspn(line, "\r")] = 0; /* Remove CR. */
+            __ini_add_line(ini, line, true);
+            free(line);
+            break;
+        }
+        *eol = '\0';
+        p = eol + 1;
+        line[strcspn(line, "\r")] = 0; /* Remove CR. */
+        __ini_add_line(ini, line, false);
+    }
+    return true;
+}
+#else
+static bool __ini_load_mmap(IniDesc* ini, const char* path)
+{
+    /* Not mapped, the file is read with the stdio loader. */
+    UNUSED(ini);
+    UNUSED(path);
+    return false;
+}
+#endif
 
 
 /**
 ini_open
 ========
 
-Configure and load an INI File object.
+Configure and load an INI File object. The file is mapped into memory and the
+lines of the file are referenced in place (until modified). On Windows the
+file is read line by line instead. Lines of the form
+`[section]` start a section, keys of a section can be accessed with the
+`ini_*_section_*()` functions.
 
 Parameters
 ----------
@@ -32,49 +494,42 @@ IniDesc (struct)
 */
 IniDesc ini_open(const char* path)
 {
-    IniDesc ini = { .lines = vector_make(sizeof(char*), 0, NULL) };
-    if (path == NULL) return ini;
+    IniDesc ini = { .lines = vector_make(sizeof(IniLine), 0, NULL) };
+    if (path == NULL || __ini_load_mmap(&ini, path)) {
+        __ini_index(&ini);
+        return ini;
+    }
 
     FILE* f = fopen(path, "r");
-    if (f == NULL) return ini; /* Return an empty INI object. */
+    if (f == NULL) {
+        /* Return an empty INI object. */
+        __ini_index(&ini);
+        return ini;
+    }
 
     char line[LINE_MAX_SIZE] = { 0 };
     while (fgets(line, LINE_MAX_SIZE, f) != NULL) {
-        if (strpbrk(line, "=") == NULL) continue; /* Not key=value pair. */
-        line[strcspn(line, "\r\n")] = 0;          /* Remove newline. */
-        char* pos = line;
-        while (*pos == ' ') {
-            pos++;
-        } /* Trim leading space characters. */
-        pos = strdup(pos);
-        vector_push(&ini.lines, &pos);
+        line[strcspn(line, "\r\n")] = 0; /* Remove newline. */
+        __ini_add_line(&ini, line, true);
     }
     fclose(f);
+    __ini_index(&ini);
     return ini;
 }
 
-static size_t __ini_find_line(IniDesc* ini, const char* key, char** line)
+
+static size_t __ini_find_line(
+    IniDesc* ini, const char* section, const char* key, char** line)
 {
     /* Set the return condition (for no match). */
     *line = NULL;
 
-    /* Search for the line. */
-    for (size_t i = 0; i < vector_len(&ini->lines); i++) {
-        char** _ = vector_at(&ini->lines, i, NULL);
-        if (_ == NULL || *_ == NULL) break;
-        char* _line = *_;
-        if (strncmp(_line, key, strlen(key)) == 0) {
-            /* Is the next character an '='? */
-            const char* pos = strpbrk(_line, "=");
-            if (pos != NULL && pos == _line + strlen(key)) {
-                /* Match, key found. */
-                *line = _line;
-                return i;
-            }
-        }
-    }
-    /* No match, **line is NULL to indicate. */
-    return 0;
+    /* Lookup the line in the index. */
+    __ini_index(ini);
+    size_t slot = __ini_index_get(&ini->index, section, key, strlen(key));
+    if (slot == 0) return 0;
+    *line = __ini_line(ini, slot - 1);
+    return slot - 1;
 }
 
 
@@ -94,13 +549,36 @@ key (const char*)
 */
 void ini_delete_key(IniDesc* ini, const char* key)
 {
-    if (ini == NULL) return;
+    ini_delete_section_key(ini, NULL, key);
+}
+
+
+/**
+ini_delete_section_key
+======================
+
+Delete the specified key, of a section, from the INI File object.
+
+Parameters
+----------
+ini (IniDesc*)
+: INI File object.
+
+section (const char*)
+: The section of the key. When NULL, the first line with the key (in any
+  section) is deleted.
+
+key (const char*)
+: The key to delete.
+*/
+void ini_delete_section_key(IniDesc* ini, const char* section, const char* key)
+{
+    if (ini == NULL || key == NULL) return;
 
     char*  line = NULL;
-    size_t i = __ini_find_line(ini, key, &line);
+    size_t i = __ini_find_line(ini, section, key, &line);
     if (line != NULL) {
-        vector_delete_at(&ini->lines, i);
-        free(line);
+        __ini_delete_line(ini, i);
     }
 }
 
@@ -129,10 +607,40 @@ char*
 */
 const char* ini_get_val(IniDesc* ini, const char* key)
 {
-    if (ini == NULL) return NULL;
+    return ini_get_section_val(ini, NULL, key);
+}
+
+
+/**
+ini_get_section_val
+===================
+
+Get the value of a key, of a section, from the INI File object.
+
+Parameters
+----------
+ini (IniDesc*)
+: INI File object.
+
+section (const char*)
+: The section of the key. When NULL, the first line with the key (in any
+  section) is used.
+
+key (const char*)
+: The key to get.
+
+Returns
+-------
+char*
+: The corresponding value of key, or NULL if key is was not found.
+*/
+const char* ini_get_section_val(
+    IniDesc* ini, const char* section, const char* key)
+{
+    if (ini == NULL || key == NULL) return NULL;
 
     char* line = NULL;
-    __ini_find_line(ini, key, &line);
+    __ini_find_line(ini, section, key, &line);
     if (line != NULL) {
         /* Return the value, right of "=". */
         return strpbrk(line, "=") + 1;
@@ -164,25 +672,71 @@ overwrite (bool)
 */
 void ini_set_val(IniDesc* ini, const char* key, const char* val, bool overwrite)
 {
-    if (ini == NULL) return;
+    ini_set_section_val(ini, NULL, key, val, overwrite);
+}
+
+
+/**
+ini_set_section_val
+===================
+
+Set a key-value pair, of a section, on the INI File object. A new key is
+added at the end of its section (the section is added if necessary).
+
+Parameters
+----------
+ini (IniDesc*)
+: INI File object.
+
+section (const char*)
+: The section of the key. When NULL, the first line with the key (in any
+  section) is updated, otherwise a new key is added before the first section.
+
+key (const char*)
+: The key to set.
+
+val (const char*)
+: The corresponding value to set.
+
+overwrite (bool)
+: When true, if the key already exists then overwrite with the provided value.
+*/
+void ini_set_section_val(IniDesc* ini, const char* section, const char* key,
+    const char* val, bool overwrite)
+{
+    if (ini == NULL || key == NULL) return;
 
     /* Calculate the new line.*/
-    const char* new_val = ini_get_val(ini, key);
+    const char* new_val = ini_get_section_val(ini, section, key);
     if (new_val == NULL || overwrite == true) {
         new_val = val;
     }
-    size_t line_length = strlen(key) + strlen(new_val) + 2;
-    char*  new_line = calloc(line_length, sizeof(char));
-    snprintf(new_line, line_length, "%s=%s", key, new_val);
+    char* new_line = __ini_make_line(key, new_val);
+    if (new_line == NULL) return;
     /* Replace, or add, the new line. */
     char*  line = NULL;
-    size_t index = __ini_find_line(ini, key, &line);
+    size_t index = __ini_find_line(ini, section, key, &line);
     if (line != NULL) {
-        vector_set_at(&ini->lines, index, &new_line);
-        free(line);
-    } else {
-        vector_push(&ini->lines, &new_line);
+        __ini_slot(ini, index)->line = new_line;
+        __ini_free_line(ini, line);
+        return;
+    }
+    uintptr_t section_slot = 0;
+    if (section) {
+        section_slot = (uintptr_t)hashmap_get(&ini->sections, section);
+    }
+    if (section_slot == 0 && section) {
+        /* New section, at the end. */
+        size_t len = strlen(section) + 3;
+        char*  section_line = calloc(len, sizeof(char));
+        if (section_line == NULL) {
+            free(new_line);
+            return;
+        }
+        snprintf(section_line, len, "[%s]", section);
+        section_slot = __ini_add(ini, section_line, 0) + 1;
     }
+    __ini_add(ini, new_line, section_slot);
 }
 
 
@@ -207,28 +761,38 @@ void ini_expand_vars(IniDesc* ini)
 {
     if (ini == NULL) return;
 
+    /* One environment snapshot for all lines. */
+    DseEnvSnapshot* env = dse_env_snapshot_create();
     for (size_t i = 0; i < vector_len(&ini->lines); i++) {
-        char** _ = vector_at(&ini->lines, i, NULL);
-        if (_ == NULL || *_ == NULL) continue;
-        char* line = *_;
+        char* line = __ini_line(ini, i);
+        if (line == NULL) continue;
 
         /* Determine the key/val. */
+        size_t name_len;
+        if (__ini_section_name(line, &name_len)) continue;
         const char* pos = strpbrk(line, "=");
         if (pos == NULL) continue;
+        if (strstr(pos + 1, "${") == NULL) continue;
         size_t key_length = pos - line;
-        char*  new_val = dse_expand_vars(pos + 1);
+        size_t val_length = 0;
+        char*  new_val = dse_expand_vars_env(pos + 1, env, &val_length);
+        if (new_val == NULL) continue;
 
         /* Calculate the new line. */
-        size_t line_length = key_length + strlen(new_val) + 1;
-        char*  new_line = calloc(line_length + 1, sizeof(char));
-        strncat(new_line, line, key_length + 1); /* Key + "=". */
-        strncat(new_line, new_val, line_length);
+        char* new_line = malloc(key_length + 1 + val_length + 1);
+        if (new_line == NULL) {
+            free(new_val);
+            continue;
+        }
+        memcpy(new_line, line, key_length + 1); /* Key + "=". */
+        memcpy(new_line + key_length + 1, new_val, val_length + 1);
         free(new_val);
 
         /* Update/replace the line. */
-        vector_set_at(&ini->lines, i, &new_line);
-        free(line);
+        __ini_slot(ini, i)->line = new_line;
+        __ini_free_line(ini, line);
     }
+    dse_env_snapshot_destroy(env);
 }
 
 
@@ -236,7 +800,9 @@ void ini_expand_vars(IniDesc* ini)
 ini_write
 =========
 
-Write the key-value pair of the INI File object to the named file.
+Write the key-value pair of the INI File object to the named file. Any lines
+which reference the loaded (mapped) file are first copied, so that the loaded
+file may be overwritten.
 
 Parameters
 ----------
@@ -249,14 +815,14 @@ path (const char*)
 void ini_write(IniDesc* ini, const char* path)
 {
     if (ini == NULL) return;
+    __ini_detach(ini);
 
     FILE* f = fopen(path, "w");
     if (f == 0) return;
 
-    for (size_t i = 0; i < vector_len(&ini->lines); i++) {
-        char** _ = vector_at(&ini->lines, i, NULL);
-        if (_ == NULL || *_ == NULL) continue;
-        char* line = *_;
+    for (size_t s = ini->head; s; s = __ini_slot(ini, s - 1)->next) {
+        char* line = __ini_line(ini, s - 1);
+        if (line == NULL) continue;
         fputs(line, f);
         fputs("\n", f);
     }
@@ -265,8 +831,7 @@ void ini_write(IniDesc* ini, const char* path)
 
 static void __free_line(void* item, void* data)
 {
-    UNUSED(data);
-    if (item) free(*(char**)item);
+    if (item) __ini_free_line(data, ((IniLine*)item)->line);
 }
 
 
@@ -284,6 +849,16 @@ ini (IniDesc*)
 void ini_close(IniDesc* ini)
 {
     if (ini == NULL) return;
-    vector_clear(&ini->lines, __free_line, NULL);
+    vector_clear(&ini->lines, __free_line, ini);
     vector_reset(&ini->lines);
+    if (ini->index.nodes) hashmap_destroy(&ini->index);
+    if (ini->sections.nodes) hashmap_destroy(&ini->sections);
+    __ini_unmap(ini);
+    ini->index = (HashMap){ 0 };
+    ini->sections = (HashMap){ 0 };
+    ini->head = 0;
+    ini->tail = 0;
+    ini->global = 0;
+    ini->tombstones = 0;
+    ini->duplicates = false;
 }
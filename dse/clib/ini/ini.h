@@ -6,6 +6,7 @@
 #define DSE_CLIB_INI_INI_H_
 
 #include <stdbool.h>
+#include <dse/clib/collections/hashmap.h>
 #include <dse/clib/collections/vector.h>
 
 
@@ -35,7 +36,18 @@ The following example demonstrates how to use the INI File API.
 
 
 typedef struct IniDesc {
-    Vector lines;
+    Vector  lines;
+    /* Line order, and the key and section index (see ini.c). */
+    size_t  head;
+    size_t  tail;
+    size_t  global;
+    HashMap index;
+    HashMap sections;
+    size_t  tombstones;
+    bool    duplicates;
+    /* The mapped INI file, lines may reference the mapping. */
+    char*   map;
+    size_t  map_size;
 } IniDesc;
 
 DLL_PRIVATE IniDesc     ini_open(const char* path);
@@ -43,6 +55,12 @@ DLL_PRIVATE void        ini_delete_key(IniDesc* ini, const char* key);
 DLL_PRIVATE const char* ini_get_val(IniDesc* ini, const char* key);
 DLL_PRIVATE void        ini_set_val(
            IniDesc* ini, const char* key, const char* val, bool overwrite);
+DLL_PRIVATE void ini_delete_section_key(
+    IniDesc* ini, const char* section, const char* key);
+DLL_PRIVATE const char* ini_get_section_val(
+    IniDesc* ini, const char* section, const char* key);
+DLL_PRIVATE void ini_set_section_val(IniDesc* ini, const char* section,
+    const char* key, const char* val, bool overwrite);
 DLL_PRIVATE void ini_expand_vars(IniDesc* ini);
 DLL_PRIVATE void ini_write(IniDesc* ini, const char* path);
 DLL_PRIVATE void ini_close(IniDesc* ini);
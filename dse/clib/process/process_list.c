@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <string.h>
+#include <yaml.h>
 #include <dse/clib/collections/hashmap.h>
 #include <dse/clib/process/process.h>
 #include <dse/clib/util/yaml.h>
@@ -30,9 +31,15 @@ DseProcessDesc* dse_process_load_process_list(const char* filename)
 {
     log_debug("Load process list from file:  %s", filename);
 
-    YamlNode* process_doc = dse_yaml_load_single_doc(filename);
-    YamlNode* list = dse_yaml_find_node(process_doc, "process");
-    size_t    process_count = hashlist_length(&list->sequence);
+    /* Only the first "process" key (of the first document which has one) is
+    materialised, the process descriptors reference its scalars. */
+    const char* path[] = { "process" };
+    YamlNode*   list = NULL;
+    dse_yaml_query_file(filename, path, &list, 1);
+    size_t process_count = 0;
+    if (list && list->node_type == YAML_SEQUENCE_NODE) {
+        process_count = hashlist_length(&list->sequence);
+    }
 
     log_debug("  count :  %d", process_count);
 
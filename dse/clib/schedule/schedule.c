@@ -3,13 +3,566 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
+#include <dse/clib/util/threadpool.h>
 #include <dse/clib/schedule/schedule.h>
 
 
-#define UNUSED(x)    ((void)x)
-#define DEFAULT_BEAT 0.001
+#define UNUSED(x)                ((void)x)
+#define DEFAULT_BEAT             0.001
+#define PROFILE_SIGNALS_PER_TASK 4
+
+
+static inline int64_t _to_ns(double t)
+{
+    return (int64_t)(t * 1e9 + ((t < 0.0) ? -0.5 : 0.5));
+}
+
+
+/* Event queue. Tasks with the same period and phase (i.e. the same
+   schedule_beats and next due tick) are held in a bucket, and the buckets are
+   held in a binary min-heap ordered by due tick. A tick pops the due buckets
+   and executes their tasks in schedule list order (buckets hold ascending
+   list indexes, which are merged), so the cost of a tick is proportional to
+   the number of tasks due, plus O(log b) for each of the b due buckets.
+
+   Buckets are found (when a task is added) with an open addressing table
+   keyed by period and due tick. The table is hashed by period and phase
+   (due % period), which does not change when a bucket is rescheduled. A task
+   added while a bucket of the same period and phase is due (on this tick) is
+   due one period later, and is held in another bucket. */
+
+typedef struct ScheduleBucket {
+    uint32_t  beats;
+    uint32_t  due;
+    uint32_t* index; /* Ascending Schedule.list indexes. */
+    size_t    count;
+    size_t    size;
+    size_t    pos; /* Merge cursor. */
+    bool      is_due;
+} ScheduleBucket;
+
+
+static inline bool _event_lt(ScheduleEvent a, ScheduleEvent b)
+{
+    if (a.due != b.due) return a.due < b.due;
+    return a.index < b.index;
+}
+
+
+static void _eventq_push(Schedule* s, uint32_t due, uint32_t index)
+{
+    if (s->eventq.count == s->eventq.size) {
+        s->eventq.size = s->eventq.size ? s->eventq.size * 2 : 16;
+        s->eventq.heap =
+            realloc(s->eventq.heap, s->eventq.size * sizeof(ScheduleEvent));
+    }
+    ScheduleEvent* heap = s->eventq.heap;
+    ScheduleEvent  e = { .due = due, .index = index };
+    size_t         i = s->eventq.count++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!_event_lt(e, heap[parent])) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = e;
+}
+
+
+static ScheduleEvent _eventq_pop(Schedule* s)
+{
+    ScheduleEvent* heap = s->eventq.heap;
+    ScheduleEvent  top = heap[0];
+    ScheduleEvent  e = heap[--s->eventq.count];
+    size_t         n = s->eventq.count;
+    size_t         i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && _event_lt(heap[child + 1], heap[child])) child++;
+        if (!_event_lt(heap[child], e)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (n) heap[i] = e;
+    return top;
+}
+
+
+static inline size_t _bucket_hash(Schedule* s, uint32_t beats, uint32_t due)
+{
+    uint64_t key = ((uint64_t)beats << 32) | (due % beats);
+    size_t   mask = s->eventq.bucket_map_size - 1;
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+
+/* Slot of the bucket map for a period and due tick, either the slot holding
+   that bucket or the (empty) slot where it would be inserted. */
+static size_t _bucket_slot(Schedule* s, uint32_t beats, uint32_t due)
+{
+    ScheduleBucket* bucket = s->eventq.bucket;
+    uint32_t*       map = s->eventq.bucket_map;
+    size_t          mask = s->eventq.bucket_map_size - 1;
+    size_t          slot = _bucket_hash(s, beats, due);
+    for (; map[slot]; slot = (slot + 1) & mask) {
+        ScheduleBucket* b = &bucket[map[slot] - 1];
+        if (b->beats == beats && b->due == due) break;
+    }
+    return slot;
+}
+
+
+static void _bucket_map_grow(Schedule* s)
+{
+    /* Load factor below 1/2. */
+    size_t size = s->eventq.bucket_map_size;
+    if (2 * (s->eventq.bucket_count + 1) <= size) return;
+    size = size ? size * 2 : 16;
+    free(s->eventq.bucket_map);
+    s->eventq.bucket_map = calloc(size, sizeof(uint32_t));
+    s->eventq.bucket_map_size = size;
+    ScheduleBucket* bucket = s->eventq.bucket;
+    for (size_t i = 0; i < s->eventq.bucket_count; i++) {
+        /* Buckets may have the same due tick (after being rescheduled). */
+        size_t mask = size - 1;
+        size_t slot = _bucket_hash(s, bucket[i].beats, bucket[i].due);
+        while (s->eventq.bucket_map[slot]) slot = (slot + 1) & mask;
+        s->eventq.bucket_map[slot] = i + 1;
+    }
+}
+
+
+static void _eventq_add(Schedule* s, uint32_t due, uint32_t index)
+{
+    uint32_t beats = s->list[index].schedule_beats;
+    _bucket_map_grow(s);
+
+    /* Find the bucket for this period and due tick. */
+    size_t          slot = _bucket_slot(s, beats, due);
+    ScheduleBucket* bucket = s->eventq.bucket;
+    ScheduleBucket* b;
+    if (s->eventq.bucket_map[slot]) {
+        b = &bucket[s->eventq.bucket_map[slot] - 1];
+    } else {
+        if (s->eventq.bucket_count == s->eventq.bucket_size) {
+            s->eventq.bucket_size =
+                s->eventq.bucket_size ? s->eventq.bucket_size * 2 : 8;
+            s->eventq.bucket = realloc(s->eventq.bucket,
+                s->eventq.bucket_size * sizeof(ScheduleBucket));
+            bucket = s->eventq.bucket;
+        }
+        b = &bucket[s->eventq.bucket_count];
+        *b = (ScheduleBucket){ .beats = beats, .due = due };
+        s->eventq.bucket_map[slot] = s->eventq.bucket_count + 1;
+        _eventq_push(s, due, s->eventq.bucket_count++);
+    }
+
+    if (b->count == b->size) {
+        b->size = b->size ? b->size * 2 : 8;
+        b->index = realloc(b->index, b->size * sizeof(uint32_t));
+    }
+    if (index >= s->eventq.item_size) {
+        size_t size = s->eventq.item_size ? s->eventq.item_size : 64;
+        while (size <= index) size *= 2;
+        s->eventq.item_bucket =
+            realloc(s->eventq.item_bucket, size * sizeof(uint32_t));
+        s->eventq.item_size = size;
+    }
+    s->eventq.item_bucket[index] = b - bucket;
+    /* Items are usually added in list order, otherwise insert. */
+    size_t i = b->count++;
+    while (i > 0 && b->index[i - 1] > index) {
+        b->index[i] = b->index[i - 1];
+        i--;
+    }
+    b->index[i] = index;
+}
+
+
+static void _eventq_seed(Schedule* s)
+{
+    /* Items added since the previous tick are first due one period after the
+       current tick (equivalent to the alarm counter being loaded). */
+    for (size_t i = s->eventq.seeded; i < s->count; i++) {
+        if (s->list[i].schedule_beats == 0) continue;
+        _eventq_add(s, s->tick + s->list[i].schedule_beats, i);
+    }
+    s->eventq.seeded = s->count;
+}
+
+
+/* Parallel execution, grouped tasks which are due on a tick are collected and
+   then dispatched (one job per group) to the thread pool. The pool may be
+   shared, so a tick waits (with a latch) only for its own jobs. */
+
+typedef struct ScheduleDue {
+    uint32_t group;
+    uint32_t index;
+} ScheduleDue;
+
+typedef struct ScheduleLatch {
+    pthread_mutex_t lock;
+    pthread_cond_t  done;
+    size_t          pending;
+} ScheduleLatch;
+
+typedef struct ScheduleGroupJob {
+    Schedule*      s;
+    ScheduleDue*   due;
+    size_t         count;
+    ScheduleLatch* latch;
+} ScheduleGroupJob;
+
+
+static int _due_compar(const void* a, const void* b)
+{
+    const ScheduleDue* l = a;
+    const ScheduleDue* r = b;
+    if (l->group != r->group) return (l->group < r->group) ? -1 : 1;
+    if (l->index != r->index) return (l->index < r->index) ? -1 : 1;
+    return 0;
+}
+
+
+static size_t _default_threads(void)
+{
+#if defined _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 1) return n - 1;
+#endif
+    return 1;
+}
+
+
+/* Profile. */
+
+static inline uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_SOURCE, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+static inline uint64_t _profile_now(Schedule* s)
+{
+    return s->profile.clock_ns ? s->profile.clock_ns() : _now_ns();
+}
+
+
+static inline size_t _bucket_index(uint64_t v)
+{
+    if (v < 16) return v;
+    unsigned e = 63 - __builtin_clzll(v);
+    size_t   i = 16 + (e - 4) * 8 + ((v >> (e - 3)) & 7);
+    return (i < SCHEDULE_PROFILE_BUCKETS) ? i : SCHEDULE_PROFILE_BUCKETS - 1;
+}
+
+
+static inline uint64_t _bucket_value(size_t i)
+{
+    /* Lowest value represented by the bucket. */
+    if (i < 16) return i;
+    unsigned e = (i - 16) / 8 + 4;
+    uint64_t sub = (i - 16) % 8;
+    return (1ULL << e) | (sub << (e - 3));
+}
+
+
+static void _profile_record(ScheduleProfile* p, uint64_t ns, uint64_t budget)
+{
+    if (p->count == 0 || ns < p->min_ns) p->min_ns = ns;
+    if (ns > p->max_ns) p->max_ns = ns;
+    if (p->count) {
+        /* Jitter estimator (as RFC 3550), J += (|D| - J) / 16. */
+        int64_t d = (ns > p->last_ns) ? ns - p->last_ns : p->last_ns - ns;
+        int64_t j = (int64_t)p->jitter_ns;
+        p->jitter_ns = j + (d - j) / 16;
+    }
+    p->last_ns = ns;
+    p->count++;
+    p->total_ns += ns;
+    if (budget && ns > budget) p->overruns++;
+    p->histogram[_bucket_index(ns)]++;
+}
+
+
+static inline uint64_t _profile_budget(Schedule* s)
+{
+    return s->profile.budget_ns ? s->profile.budget_ns : s->beat_ns;
+}
+
+
+static void _profile_reserve(Schedule* s)
+{
+    if (s->profile.task_count >= s->count) return;
+    s->profile.task =
+        realloc(s->profile.task, s->count * sizeof(ScheduleProfile));
+    memset(&s->profile.task[s->profile.task_count], 0,
+        (s->count - s->profile.task_count) * sizeof(ScheduleProfile));
+    s->profile.task_count = s->count;
+}
+
+
+static void _profile_release(Schedule* s)
+{
+    for (size_t i = 0; i < s->profile.signal_count; i++) {
+        free((char*)s->profile.signal[i]);
+    }
+    free(s->profile.signal);
+    free(s->profile.scalar);
+    free(s->profile.task);
+    s->profile.signal = NULL;
+    s->profile.scalar = NULL;
+    s->profile.signal_count = 0;
+    s->profile.task = NULL;
+    s->profile.task_count = 0;
+    memset(&s->profile.beat, 0, sizeof(ScheduleProfile));
+}
+
+
+static inline void _exec_task(Schedule* s, size_t index)
+{
+    if ((s->flags & SCHEDULE_FLAG_PROFILE) && index < s->profile.task_count) {
+        uint64_t t0 = _profile_now(s);
+        s->task_vtable.exec(s->list[index].task);
+        _profile_record(
+            &s->profile.task[index], _profile_now(s) - t0, _profile_budget(s));
+    } else {
+        s->task_vtable.exec(s->list[index].task);
+    }
+}
+
+
+static inline void _exec_item(Schedule* s, size_t index)
+{
+    ScheduleItem* item = &s->list[index];
+    if ((s->flags & SCHEDULE_FLAG_PARALLEL) && item->group) {
+        if (s->parallel.due_count == s->parallel.due_size) {
+            s->parallel.due_size =
+                s->parallel.due_size ? s->parallel.due_size * 2 : 16;
+            s->parallel.due = realloc(
+                s->parallel.due, s->parallel.due_size * sizeof(ScheduleDue));
+        }
+        ScheduleDue* due = s->parallel.due;
+        due[s->parallel.due_count++] =
+            (ScheduleDue){ .group = item->group, .index = index };
+    } else {
+        _exec_task(s, index);
+    }
+}
+
+
+static void _group_job(void* arg)
+{
+    ScheduleGroupJob* job = arg;
+    for (size_t i = 0; i < job->count; i++) {
+        _exec_task(job->s, job->due[i].index);
+    }
+
+    ScheduleLatch* latch = job->latch;
+    pthread_mutex_lock(&latch->lock);
+    latch->pending -= job->count;
+    if (latch->pending == 0) pthread_cond_signal(&latch->done);
+    pthread_mutex_unlock(&latch->lock);
+}
+
+
+static void _dispatch_groups(Schedule* s)
+{
+    size_t count = s->parallel.due_count;
+    if (count == 0) return;
+    s->parallel.due_count = 0;
+
+    ScheduleDue* due = s->parallel.due;
+    qsort(due, count, sizeof(ScheduleDue), _due_compar);
+    if (s->parallel.jobs_size < count) {
+        s->parallel.jobs_size = count;
+        s->parallel.jobs =
+            realloc(s->parallel.jobs, count * sizeof(ScheduleGroupJob));
+    }
+    if (s->parallel.pool == NULL) {
+        s->parallel.pool = dse_threadpool_create(_default_threads());
+        s->parallel.pool_owned = true;
+    }
+
+    /* One job per group, the latch counts the tasks which have not run. */
+    ScheduleGroupJob* jobs = s->parallel.jobs;
+    size_t            job_count = 0;
+    ScheduleLatch     latch = { .pending = count };
+    pthread_mutex_init(&latch.lock, NULL);
+    pthread_cond_init(&latch.done, NULL);
+    for (size_t i = 0; i < count;) {
+        size_t j = i + 1;
+        while (j < count && due[j].group == due[i].group) j++;
+        jobs[job_count] = (ScheduleGroupJob){
+            .s = s, .due = &due[i], .count = j - i, .latch = &latch };
+        if (s->parallel.pool == NULL ||
+            dse_threadpool_submit(
+                s->parallel.pool, _group_job, &jobs[job_count])) {
+            _group_job(&jobs[job_count]);
+        }
+        job_count++;
+        i = j;
+    }
+
+    /* Help the pool until none of the jobs remain queued, then wait for the
+       jobs which are still running. */
+    for (;;) {
+        pthread_mutex_lock(&latch.lock);
+        size_t pending = latch.pending;
+        pthread_mutex_unlock(&latch.lock);
+        if (pending == 0) break;
+        if (dse_threadpool_run_one(s->parallel.pool)) continue;
+
+        pthread_mutex_lock(&latch.lock);
+        while (latch.pending) pthread_cond_wait(&latch.done, &latch.lock);
+        pthread_mutex_unlock(&latch.lock);
+        break;
+    }
+    pthread_cond_destroy(&latch.done);
+    pthread_mutex_destroy(&latch.lock);
+}
+
+
+static void _parallel_release(Schedule* s)
+{
+    if (s->parallel.pool_owned) dse_threadpool_destroy(s->parallel.pool);
+    s->parallel.pool = NULL;
+    s->parallel.pool_owned = false;
+    free(s->parallel.due);
+    s->parallel.due = NULL;
+    s->parallel.due_count = 0;
+    s->parallel.due_size = 0;
+    free(s->parallel.jobs);
+    s->parallel.jobs = NULL;
+    s->parallel.jobs_size = 0;
+}
+
+
+/* Catch-up, advance the schedule over (up to max) ticks on which no task
+   would be due, returns the number of ticks advanced. */
+
+static uint32_t _skip_quiet_ticks(Schedule* s, uint32_t max)
+{
+    if (s->list == NULL || s->init_tick_done == false) return 0;
+
+    /* Ticks until the next alarm. Items which have not been processed by a
+       tick must first be loaded by a tick, in which case nothing is skipped. */
+    uint32_t next = UINT32_MAX;
+    if (s->flags & SCHEDULE_FLAG_EVENTQ) {
+        if (s->eventq.seeded < s->count) return 0;
+        if (s->eventq.count) {
+            if (s->eventq.heap[0].due <= s->tick) return 0;
+            next = s->eventq.heap[0].due - s->tick;
+        }
+    } else {
+        /* Next alarm as calculated by the previous (default) tick. */
+        if (s->alarm_count == 0 || s->alarm_count != s->count) return 0;
+        next = s->alarm_next;
+    }
+    if (next <= 1) return 0;
+    uint32_t n = (next - 1 < max) ? next - 1 : max;
+
+    /* Advance. */
+    s->tick += n;
+    if ((s->flags & SCHEDULE_FLAG_EVENTQ) == 0) {
+        for (ScheduleItem* item = s->list; item && item->task; item++) {
+            if (item->schedule_beats) item->alarm -= n;
+        }
+        s->alarm_next -= n;
+    }
+    return n;
+}
+
+
+static void _eventq_run(Schedule* s)
+{
+    _eventq_seed(s);
+
+    /* Collect the due buckets. */
+    size_t nd = 0;
+    while (s->eventq.count && s->eventq.heap[0].due <= s->tick) {
+        if (nd == s->eventq.due_size) {
+            s->eventq.due_size =
+                s->eventq.due_size ? s->eventq.due_size * 2 : 8;
+            s->eventq.due =
+                realloc(s->eventq.due, s->eventq.due_size * sizeof(uint32_t));
+        }
+        s->eventq.due[nd++] = _eventq_pop(s).index;
+    }
+    if (nd == 0) return;
+
+    /* Execute the tasks in list order. Task exec may call schedule_add(), so
+       always index into the list. */
+    ScheduleBucket* bucket = s->eventq.bucket;
+    uint32_t*       due = s->eventq.due;
+    size_t          k = 0;
+    for (size_t d = 0; d < nd; d++) k += bucket[due[d]].count;
+    if (nd == 1) {
+        ScheduleBucket* b = &bucket[due[0]];
+        for (size_t i = 0; i < b->count; i++) {
+            _exec_item(s, b->index[i]);
+        }
+    } else if (k >= s->eventq.seeded / 8) {
+        /* Many tasks are due, a scan of the list is cheaper than a merge. */
+        for (size_t d = 0; d < nd; d++) bucket[due[d]].is_due = true;
+        size_t count = s->eventq.seeded;
+        for (size_t i = 0; i < count; i++) {
+            if (s->list[i].schedule_beats == 0) continue;
+            if (bucket[s->eventq.item_bucket[i]].is_due) _exec_item(s, i);
+        }
+        for (size_t d = 0; d < nd; d++) bucket[due[d]].is_due = false;
+    } else {
+        for (size_t d = 0; d < nd; d++) bucket[due[d]].pos = 0;
+        for (;;) {
+            ScheduleBucket* next = NULL;
+            for (size_t d = 0; d < nd; d++) {
+                ScheduleBucket* b = &bucket[due[d]];
+                if (b->pos == b->count) continue;
+                if (next == NULL ||
+                    b->index[b->pos] < next->index[next->pos]) {
+                    next = b;
+                }
+            }
+            if (next == NULL) break;
+            _exec_item(s, next->index[next->pos++]);
+        }
+    }
+
+    /* Reschedule. */
+    for (size_t d = 0; d < nd; d++) {
+        ScheduleBucket* b = &bucket[due[d]];
+        b->due = s->tick + b->beats;
+        _eventq_push(s, b->due, due[d]);
+    }
+}
+
+
+static void _eventq_release(Schedule* s)
+{
+    ScheduleBucket* bucket = s->eventq.bucket;
+    for (size_t i = 0; i < s->eventq.bucket_count; i++) {
+        free(bucket[i].index);
+    }
+    free(s->eventq.bucket);
+    free(s->eventq.heap);
+    free(s->eventq.due);
+    free(s->eventq.item_bucket);
+    free(s->eventq.bucket_map);
+    memset(&s->eventq, 0, sizeof(s->eventq));
+}
 
 
 /**
@@ -58,6 +611,7 @@ void schedule_configure(Schedule* s, ScheduleVTable vtable,
     } else {
         s->beat = DEFAULT_BEAT;
     }
+    s->beat_ns = _to_ns(s->beat);
     if (s->vtable.tick == NULL) {
         s->vtable.tick = schedule_default_tick;
     }
@@ -87,6 +641,41 @@ schedule_beats (uint32_t)
   tasks.
 */
 void schedule_add(Schedule* s, ScheduleTask task, uint32_t schedule_beats)
+{
+    schedule_add_group(s, task, schedule_beats, 0);
+}
+
+
+/**
+schedule_add_group
+==================
+
+Add a task to the schedule, and tag it with a group. When the schedule is
+configured with `SCHEDULE_FLAG_PARALLEL` the tasks of each group, which are
+due on a tick, are executed (in schedule order) by a thread pool. Tasks in
+different groups must be independent of each other (and of untagged tasks).
+
+> Note: Tasks executed in parallel must not modify the schedule (e.g. call
+  `schedule_add()`).
+
+Parameters
+----------
+s (Schedule*)
+: A schedule descriptor object.
+
+task (ScheduleTask)
+: A task object (void*).
+
+schedule_beats (uint32_t)
+: Indicates the schedule of the task in beats. Set to 0 for initialisation
+  tasks.
+
+group (uint32_t)
+: The group of the task. Set to 0 for an untagged task, untagged tasks are
+  always executed sequentially by the thread calling `schedule_tick()`.
+*/
+void schedule_add_group(Schedule* s, ScheduleTask task,
+    uint32_t schedule_beats, uint32_t group)
 {
     assert(s);
 
@@ -102,18 +691,373 @@ void schedule_add(Schedule* s, ScheduleTask task, uint32_t schedule_beats)
         .task = task,
         .schedule_beats = schedule_beats,
         .alarm = 0,
+        .group = group,
     };
     /* Null terminate the list. */
     s->list[s->count] = (ScheduleItem){ 0 };
 }
 
 
+/**
+schedule_set_flags
+==================
+
+Set the options of a schedule (see `ScheduleFlag`). The schedule may be
+switched between modes at any time, the state of pending tasks is converted
+so that the execution pattern of the schedule is not changed.
+
+When `SCHEDULE_FLAG_EVENTQ` is set the `ScheduleItem.alarm` counters are not
+maintained, instead tasks with the same period and phase are held in a
+bucket, and the buckets are held in a min-heap which is keyed by the tick on
+which the bucket is next due. A tick then costs O(k + b log b) for k due
+tasks in b due buckets (rather than O(n)), and `schedule_will_alarm` only
+inspects the head of the heap.
+
+Parameters
+----------
+s (Schedule*)
+: A schedule descriptor object.
+
+flags (uint32_t)
+: Bitmask of `ScheduleFlag` values.
+*/
+void schedule_set_flags(Schedule* s, uint32_t flags)
+{
+    assert(s);
+
+    bool eventq_was = s->flags & SCHEDULE_FLAG_EVENTQ;
+    bool eventq_now = flags & SCHEDULE_FLAG_EVENTQ;
+    s->flags = flags;
+    if (eventq_was == eventq_now) return;
+
+    if (eventq_now) {
+        /* Alarm counters -> events. Items which have not yet been processed
+           by a tick (alarm == 0) are at the end of the list and will be seeded
+           on the next tick. */
+        _eventq_release(s);
+        size_t i = 0;
+        for (; i < s->count; i++) {
+            ScheduleItem* item = &s->list[i];
+            if (item->schedule_beats == 0) continue;
+            if (item->alarm == 0) break;
+            _eventq_add(s, s->tick + item->alarm, i);
+        }
+        s->eventq.seeded = i;
+    } else {
+        /* Events -> alarm counters. */
+        ScheduleBucket* bucket = s->eventq.bucket;
+        for (size_t b = 0; b < s->eventq.bucket_count; b++) {
+            for (size_t i = 0; i < bucket[b].count; i++) {
+                s->list[bucket[b].index[i]].alarm = bucket[b].due - s->tick;
+            }
+        }
+        _eventq_release(s);
+        s->alarm_count = 0;
+    }
+}
+
+
+/**
+schedule_set_threadpool
+=======================
+
+Set the thread pool used for parallel execution of tasks (see
+`SCHEDULE_FLAG_PARALLEL`). If no thread pool is set, then a thread pool is
+created (and owned by the schedule) when first required. A thread pool which
+is set remains owned by the caller, it may be shared between schedules (and
+other users). A tick waits only for the jobs of its own schedule, while
+waiting it may run other queued jobs of the pool.
+
+Parameters
+----------
+s (Schedule*)
+: A schedule descriptor object.
+
+pool (DseThreadPool*)
+: A thread pool object, or NULL.
+*/
+void schedule_set_threadpool(Schedule* s, DseThreadPool* pool)
+{
+    assert(s);
+
+    if (s->parallel.pool_owned) dse_threadpool_destroy(s->parallel.pool);
+    s->parallel.pool = pool;
+    s->parallel.pool_owned = false;
+}
+
+
+static inline void _marshal_out(Schedule* s, uint32_t batched)
+{
+    if (s->vtable.marshal_out == NULL) return;
+    if (batched) {
+        /* Marshal out already done for this batch. */
+        s->marshal_batch.saved_out++;
+        return;
+    }
+    s->vtable.marshal_out(s, s->vtable.data);
+}
+
+
+static inline void _marshal_in(Schedule* s, uint32_t* batched)
+{
+    if (s->flags & SCHEDULE_FLAG_MARSHAL_BATCH) {
+        /* Deferred until the end of schedule_tick(). */
+        *batched += 1;
+        return;
+    }
+    if (s->vtable.marshal_in) s->vtable.marshal_in(s, s->vtable.data);
+}
+
+
+/**
+schedule_profile_reset
+======================
+
+Reset the profile of a schedule (see `SCHEDULE_FLAG_PROFILE`).
+
+Parameters
+----------
+s (Schedule*)
+: A schedule descriptor object.
+*/
+void schedule_profile_reset(Schedule* s)
+{
+    assert(s);
+
+    memset(&s->profile.beat, 0, sizeof(ScheduleProfile));
+    if (s->profile.task) {
+        memset(s->profile.task, 0,
+            s->profile.task_count * sizeof(ScheduleProfile));
+    }
+}
+
+
+/**
+schedule_profile_task
+=====================
+
+Parameters
+----------
+s (Schedule*)
+: A schedule descriptor object.
+
+index (size_t)
+: Index of the task in the schedule (i.e. the order in which tasks were
+  added).
+
+Returns
+-------
+ScheduleProfile* (pointer)
+: The profile of the task.
+
+NULL
+: The task has no profile (i.e. the schedule has not ticked with
+  `SCHEDULE_FLAG_PROFILE` set, or the index is out of range).
+*/
+const ScheduleProfile* schedule_profile_task(Schedule* s, size_t index)
+{
+    assert(s);
+
+    if (index >= s->profile.task_count) return NULL;
+    return &s->profile.task[index];
+}
+
+
+/**
+schedule_profile_percentile
+===========================
+
+Calculate a percentile of a profile from its histogram. The result has the
+precision of the histogram (12.5%), and will not exceed the maximum
+recorded value.
+
+Parameters
+----------
+p (const ScheduleProfile*)
+: A profile object.
+
+percentile (double)
+: The percentile, in the range 0 to 100.
+
+Returns
+-------
+uint64_t
+: The value (nSec) at the requested percentile, or 0 if the profile is empty.
+*/
+uint64_t schedule_profile_percentile(
+    const ScheduleProfile* p, double percentile)
+{
+    if (p == NULL || p->count == 0) return 0;
+    if (percentile >= 100.0) return p->max_ns;
+
+    uint64_t target = (uint64_t)(p->count * (percentile / 100.0) + 0.5);
+    if (target == 0) target = 1;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < SCHEDULE_PROFILE_BUCKETS; i++) {
+        sum += p->histogram[i];
+        if (sum >= target) {
+            /* Highest value of the bucket. */
+            uint64_t v = (i + 1 < SCHEDULE_PROFILE_BUCKETS)
+                             ? _bucket_value(i + 1) - 1
+                             : p->max_ns;
+            if (v > p->max_ns) v = p->max_ns;
+            if (v < p->min_ns) v = p->min_ns;
+            return v;
+        }
+    }
+    return p->max_ns;
+}
+
+
+static const char* _task_name(Schedule* s, size_t index, char* buf, size_t len)
+{
+    if (s->task_vtable.name && index < s->count) {
+        const char* name = s->task_vtable.name(s->list[index].task);
+        if (name) return name;
+    }
+    snprintf(buf, len, "task_%zu", index);
+    return buf;
+}
+
+
+static void _write_csv_row(
+    FILE* f, const char* name, const ScheduleProfile* p)
+{
+    fprintf(f,
+        "%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+        ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+        name, p->count, p->count ? p->min_ns : 0,
+        p->count ? p->total_ns / p->count : 0,
+        schedule_profile_percentile(p, 50.0),
+        schedule_profile_percentile(p, 99.0), p->max_ns, p->jitter_ns,
+        p->overruns);
+}
+
+
+/**
+schedule_profile_write_csv
+==========================
+
+Write the profile of a schedule as CSV, one row for the (alarmed) beats of
+the schedule followed by a row for each task. Times are in nSec.
+
+Parameters
+----------
+s (Schedule*)
+: A schedule descriptor object.
+
+f (FILE*)
+: The stream to write to.
+
+Returns
+-------
+0
+: The profile was written.
+
+-EINVAL
+: Bad arguments.
+*/
+int schedule_profile_write_csv(Schedule* s, FILE* f)
+{
+    if (s == NULL || f == NULL) return -EINVAL;
+
+    fprintf(f, "name,count,min_ns,mean_ns,p50_ns,p99_ns,max_ns,jitter_ns,"
+               "overruns\n");
+    _write_csv_row(f, "beat", &s->profile.beat);
+    for (size_t i = 0; i < s->profile.task_count; i++) {
+        char buf[32];
+        _write_csv_row(
+            f, _task_name(s, i, buf, sizeof(buf)), &s->profile.task[i]);
+    }
+    return 0;
+}
+
+
+/**
+schedule_profile_signals
+========================
+
+Update, and return, a signal/scalar representation of the profile. The arrays
+are owned by the schedule and remain valid until the number of tasks changes
+(or the schedule is destroyed), they may be used to configure an
+`MdfChannelGroup` for recording. Each task (and the beat) is represented
+with the signals `<name>.mean_ns`, `<name>.max_ns`, `<name>.jitter_ns` and
+`<name>.overruns`.
+
+Parameters
+----------
+s (Schedule*)
+: A schedule descriptor object.
+
+signal (const char***)
+: Pointer to receive the signal names, may be NULL.
+
+scalar (double**)
+: Pointer to receive the signal values, may be NULL.
+
+Returns
+-------
+size_t
+: The number of signals.
+*/
+size_t schedule_profile_signals(
+    Schedule* s, const char*** signal, double** scalar)
+{
+    assert(s);
+
+    size_t count = (s->profile.task_count + 1) * PROFILE_SIGNALS_PER_TASK;
+    if (count != s->profile.signal_count) {
+        static const char* suffix[PROFILE_SIGNALS_PER_TASK] = {
+            "mean_ns", "max_ns", "jitter_ns", "overruns"
+        };
+        for (size_t i = 0; i < s->profile.signal_count; i++) {
+            free((char*)s->profile.signal[i]);
+        }
+        s->profile.signal = realloc(s->profile.signal, count * sizeof(char*));
+        s->profile.scalar = realloc(s->profile.scalar, count * sizeof(double));
+        for (size_t i = 0; i < count; i++) {
+            size_t      t = i / PROFILE_SIGNALS_PER_TASK;
+            char        buf[32];
+            const char* name =
+                t ? _task_name(s, t - 1, buf, sizeof(buf)) : "beat";
+            size_t len = strlen(name) + 16;
+            char*  sig = malloc(len);
+            snprintf(sig, len, "%s.%s", name,
+                suffix[i % PROFILE_SIGNALS_PER_TASK]);
+            s->profile.signal[i] = sig;
+        }
+        s->profile.signal_count = count;
+    }
+
+    for (size_t t = 0; t <= s->profile.task_count; t++) {
+        const ScheduleProfile* p =
+            t ? &s->profile.task[t - 1] : &s->profile.beat;
+        double* v = &s->profile.scalar[t * PROFILE_SIGNALS_PER_TASK];
+        v[0] = p->count ? (double)p->total_ns / p->count : 0.0;
+        v[1] = p->max_ns;
+        v[2] = p->jitter_ns;
+        v[3] = p->overruns;
+    }
+
+    if (signal) *signal = s->profile.signal;
+    if (scalar) *scalar = s->profile.scalar;
+    return count;
+}
+
+
 /**
 schedule_tick
 =============
 
 Tick the schedule items, and execute tasks as required.
 
+When `SCHEDULE_FLAG_MARSHAL_BATCH` is set, and several beats alarm during
+one call, then `marshal_out` is called before the first alarmed beat and
+`marshal_in` after the last alarmed beat (rather than for each beat). Tasks
+of later beats will not observe marshalled data from earlier beats, the
+integration should only set this flag when that is acceptable. The number of
+calls saved is available in `Schedule.marshal_batch`.
+
 Parameters
 ----------
 s (Schedule*)
@@ -135,36 +1079,65 @@ void schedule_tick(Schedule* s, double simulation_time)
 
     /* Marshal data that must be handled each model_step(). */
     if (s->vtable.marshal_noop) s->vtable.marshal_noop(s, s->vtable.data);
+    bool profile = s->flags & SCHEDULE_FLAG_PROFILE;
+    if (profile) _profile_reserve(s);
 
     /* Determine if the schedule should tick. */
     double schedule_time = simulation_time;
     if (s->delay) schedule_time -= *(s->delay);
 
     /* Catch the transition to/past 0.0 and run init tasks. */
+    uint32_t batched = 0;
     if (s->init_tick_done == false && schedule_time >= 0.0) {
         log_trace(
             "simulation_time = %f, schedule_time = %f, init_tick_done = %d",
             simulation_time, schedule_time, s->init_tick_done);
-        if (s->vtable.marshal_out) s->vtable.marshal_out(s, s->vtable.data);
+        _marshal_out(s, batched);
         if (s->vtable.tick) s->vtable.tick(s, s->vtable.data);
-        if (s->vtable.marshal_in) s->vtable.marshal_in(s, s->vtable.data);
+        _marshal_in(s, &batched);
         s->init_tick_done = true;
     }
 
-    int ticks = (((schedule_time - (s->tick * s->beat)) / s->beat) * 1.01);
+    int ticks;
+    if ((s->flags & SCHEDULE_FLAG_INTEGER_TIME) && s->beat_ns) {
+        int64_t schedule_ns = _to_ns(schedule_time);
+        int64_t beat_ns = (int64_t)s->beat_ns;
+        ticks = (schedule_ns > 0) ? (schedule_ns / beat_ns) - s->tick : 0;
+    } else {
+        ticks = (((schedule_time - (s->tick * s->beat)) / s->beat) * 1.01);
+    }
     log_trace("simulation_time = %f, schedule_time = %f, ticks = %d",
         simulation_time, schedule_time, ticks);
+    bool skip = (s->flags & SCHEDULE_FLAG_CATCHUP_SKIP) &&
+                (s->vtable.tick == schedule_default_tick);
     for (int t = 0; t < ticks; t++) {
+        if (skip) {
+            t += _skip_quiet_ticks(s, ticks - t);
+            if (t == ticks) break;
+        }
         s->tick++;
         /* Tick the schedule. */
         if (schedule_will_alarm(s)) {
-            if (s->vtable.marshal_out) s->vtable.marshal_out(s, s->vtable.data);
+            uint64_t t0 = profile ? _profile_now(s) : 0;
+            _marshal_out(s, batched);
             if (s->vtable.tick) s->vtable.tick(s, s->vtable.data);
-            if (s->vtable.marshal_in) s->vtable.marshal_in(s, s->vtable.data);
+            _marshal_in(s, &batched);
+            if (profile) {
+                _profile_record(
+                    &s->profile.beat, _profile_now(s) - t0, _profile_budget(s));
+            }
         } else {
             if (s->vtable.tick) s->vtable.tick(s, s->vtable.data);
         }
     }
+
+    /* Complete a batch (marshal_in once for all alarmed beats). */
+    if (batched) {
+        if (s->vtable.marshal_in) {
+            s->vtable.marshal_in(s, s->vtable.data);
+            s->marshal_batch.saved_in += batched - 1;
+        }
+    }
 }
 
 
@@ -206,6 +1179,10 @@ void schedule_destroy(Schedule* s)
     free(s->list);
     s->list = NULL;
     s->count = 0;
+    s->alarm_count = 0;
+    _eventq_release(s);
+    _parallel_release(s);
+    _profile_release(s);
 }
 
 
@@ -221,6 +1198,9 @@ bool schedule_will_alarm(Schedule* s)
         /* Initial tick always alarms (so that tasks run). */
         return true;
     }
+    if (s->flags & SCHEDULE_FLAG_EVENTQ) {
+        return (s->eventq.count && s->eventq.heap[0].due <= s->tick);
+    }
     for (ScheduleItem* item = s->list; item && item->task; item++) {
         if (item->alarm == 1) {
             /* Alarm counter would transition to 0 on next tick. */
@@ -253,12 +1233,20 @@ void schedule_default_tick(Schedule* s, void* data)
     if (s->tick == 0) {
         for (ScheduleItem* item = s->list; item && item->task; item++) {
             if (item->schedule_beats == 0) {
-                s->task_vtable.exec(item->task);
+                _exec_item(s, item - s->list);
             }
         }
     }
 
+    /* Run tasks (event queue). */
+    if (s->flags & SCHEDULE_FLAG_EVENTQ) {
+        _eventq_run(s);
+        _dispatch_groups(s);
+        return;
+    }
+
     /* Run tasks. */
+    uint32_t alarm_next = UINT32_MAX;
     for (ScheduleItem* item = s->list; item && item->task; item++) {
         if (item->schedule_beats == 0) continue;
 
@@ -266,12 +1254,16 @@ void schedule_default_tick(Schedule* s, void* data)
             item->alarm--;
             /* Catch the 0 transition ... and run the task. */
             if (item->alarm == 0) {
-                s->task_vtable.exec(item->task);
+                _exec_item(s, item - s->list);
             }
         }
         /* Reset the alarm? */
         if (item->alarm == 0) {
             item->alarm = item->schedule_beats;
         }
+        if (item->alarm < alarm_next) alarm_next = item->alarm;
     }
+    s->alarm_next = alarm_next;
+    s->alarm_count = s->count;
+    _dispatch_groups(s);
 }
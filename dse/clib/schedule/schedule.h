@@ -7,6 +7,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <dse/platform.h>
 
 
@@ -22,6 +23,34 @@ schedule behaviour, these include:
 * `ScheduleTaskVTable` - Support custom task call interfaces, the default is a
   simple `void (*)(void)` function call.
 
+Optional behaviour is selected with `schedule_set_flags()`:
+
+* `SCHEDULE_FLAG_EVENTQ` - Tasks with the same period and phase are held in a
+  bucket, and the buckets in an event queue (min-heap ordered by due tick).
+  The cost of a tick is then proportional to the number of tasks which are due
+  (plus O(log b) for each of the b due buckets), rather than the number of
+  tasks in the schedule.
+* `SCHEDULE_FLAG_PARALLEL` - Tasks added with `schedule_add_group()` are
+  executed on a thread pool. Tasks of the same group run sequentially (in
+  schedule order), different groups run in parallel. Untagged tasks are
+  executed first, sequentially and in schedule order, on the calling thread.
+  All tasks complete before `marshal_in` is called.
+* `SCHEDULE_FLAG_INTEGER_TIME` - The number of ticks due is calculated with an
+  integer nanosecond time base (rather than floating point), so that the
+  schedule does not drift on long runs or large catch-up windows.
+* `SCHEDULE_FLAG_CATCHUP_SKIP` - When a call to `schedule_tick()` spans
+  several ticks, ticks on which no task is due are skipped (rather than
+  calling `ScheduleVTable.tick` for each). Only applies when the default
+  `tick` function (`schedule_default_tick`) is configured.
+* `SCHEDULE_FLAG_MARSHAL_BATCH` - When a call to `schedule_tick()` spans
+  several alarmed beats, marshalling is coalesced: `marshal_out` is called
+  once before the first beat and `marshal_in` once after the last beat.
+* `SCHEDULE_FLAG_PROFILE` - Task execution time and alarmed beat duration are
+  recorded (histogram, min/mean/max, jitter and budget overruns). Results are
+  exported with `schedule_profile_write_csv()`, or as signals with
+  `schedule_profile_signals()` (e.g. for an `MdfChannelGroup`). When this flag
+  is not set no measurements are taken.
+
 
 Component Diagram
 -----------------
@@ -82,10 +111,12 @@ typedef void* ScheduleTask;
 typedef void (*ScheduleTaskExec)(ScheduleTask task);
 typedef void (*ScheduleTaskInfo)(ScheduleTask task);
 typedef void (*ScheduleTaskFree)(ScheduleTask task);
+typedef const char* (*ScheduleTaskName)(ScheduleTask task);
 typedef struct ScheduleTaskVTable {
     ScheduleTaskExec exec;
     ScheduleTaskInfo info;
     ScheduleTaskFree free;
+    ScheduleTaskName name; /* Optional, used by profile export. */
 } ScheduleTaskVTable;
 
 
@@ -104,10 +135,41 @@ typedef struct ScheduleVTable {
 
 /* Schedule Objects. */
 
+typedef enum ScheduleFlag {
+    SCHEDULE_FLAG_NONE = 0,
+    SCHEDULE_FLAG_EVENTQ = 1 << 0,
+    SCHEDULE_FLAG_PARALLEL = 1 << 1,
+    SCHEDULE_FLAG_INTEGER_TIME = 1 << 2,
+    SCHEDULE_FLAG_CATCHUP_SKIP = 1 << 3,
+    SCHEDULE_FLAG_MARSHAL_BATCH = 1 << 4,
+    SCHEDULE_FLAG_PROFILE = 1 << 5,
+} ScheduleFlag;
+
+typedef struct ScheduleEvent {
+    uint32_t due;   /* Tick at which the tasks are due. */
+    uint32_t index; /* Index of the task bucket (same period and phase). */
+} ScheduleEvent;
+
+/* HDR-style histogram: values < 16 nSec have a bucket each, then each power
+   of 2 is divided into 8 linear sub-buckets (12.5% precision). */
+#define SCHEDULE_PROFILE_BUCKETS 256
+
+typedef struct ScheduleProfile {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t last_ns;
+    uint64_t jitter_ns; /* Smoothed variation of consecutive samples. */
+    uint64_t overruns;  /* Samples exceeding the budget. */
+    uint32_t histogram[SCHEDULE_PROFILE_BUCKETS];
+} ScheduleProfile;
+
 typedef struct ScheduleItem {
     ScheduleTask task;
     uint32_t     schedule_beats;
     uint32_t     alarm;
+    uint32_t     group; /* 0 = untagged, see SCHEDULE_FLAG_PARALLEL. */
 } ScheduleItem;
 
 typedef struct Schedule {
@@ -120,11 +182,66 @@ typedef struct Schedule {
     double   schedule_time; /* Schedule time: sim_time - delay. */
     double*  delay;
     double   beat;
-    uint32_t tick; /* Schedule Tick (mSec). */
+    uint64_t beat_ns; /* Beat in nSec (SCHEDULE_FLAG_INTEGER_TIME). */
+    uint32_t tick;    /* Schedule Tick (mSec). */
     bool     init_tick_done;
+    uint32_t alarm_next;  /* Lowest alarm counter after the last tick. */
+    size_t   alarm_count; /* Items counted by alarm_next (0 = not valid). */
 
     /* Task callbacks. */
     ScheduleTaskVTable task_vtable;
+
+    /* Schedule options (ScheduleFlag). */
+    uint32_t flags;
+
+    /* Event queue (SCHEDULE_FLAG_EVENTQ). */
+    struct {
+        ScheduleEvent* heap;
+        size_t         count;
+        size_t         size;
+        void*          bucket; /* Tasks with the same period and phase. */
+        size_t         bucket_count;
+        size_t         bucket_size;
+        uint32_t*      bucket_map; /* Bucket (index + 1) by period/due. */
+        size_t         bucket_map_size;
+        uint32_t*      due; /* Buckets due on this tick. */
+        size_t         due_size;
+        uint32_t*      item_bucket; /* Bucket of each item (indexed as list). */
+        size_t         item_size;
+        size_t         seeded; /* Items of list[] which are in a bucket. */
+    } eventq;
+
+    /* Parallel execution (SCHEDULE_FLAG_PARALLEL). */
+    struct {
+        struct DseThreadPool* pool;
+        bool                  pool_owned;
+        /* Grouped tasks which are due on this tick. */
+        void*                 due;
+        size_t                due_count;
+        size_t                due_size;
+        void*                 jobs;
+        size_t                jobs_size;
+    } parallel;
+
+    /* Marshal calls saved by batching (SCHEDULE_FLAG_MARSHAL_BATCH). */
+    struct {
+        uint64_t saved_out;
+        uint64_t saved_in;
+    } marshal_batch;
+
+    /* Profile (SCHEDULE_FLAG_PROFILE). */
+    struct {
+        uint64_t         budget_ns; /* Overrun threshold, 0 = beat. */
+        /* Clock (nSec), NULL = monotonic. Called from the thread pool with
+           SCHEDULE_FLAG_PARALLEL, so must then be thread safe. */
+        uint64_t (*clock_ns)(void);
+        ScheduleProfile  beat;      /* Duration of alarmed beats. */
+        ScheduleProfile* task;      /* Indexed as list. */
+        size_t           task_count;
+        const char**     signal;
+        double*          scalar;
+        size_t           signal_count;
+    } profile;
 } Schedule;
 
 
@@ -134,6 +251,19 @@ DLL_PUBLIC void schedule_configure(Schedule* s, ScheduleVTable vtable,
     ScheduleTaskVTable task_vtable, double beat, double* delay);
 DLL_PUBLIC void schedule_add(
     Schedule* s, ScheduleTask task, uint32_t schedule_beats);
+DLL_PUBLIC void schedule_add_group(Schedule* s, ScheduleTask task,
+    uint32_t schedule_beats, uint32_t group);
+DLL_PUBLIC void schedule_set_flags(Schedule* s, uint32_t flags);
+DLL_PUBLIC void schedule_set_threadpool(
+    Schedule* s, struct DseThreadPool* pool);
+DLL_PUBLIC void schedule_profile_reset(Schedule* s);
+DLL_PUBLIC const ScheduleProfile* schedule_profile_task(
+    Schedule* s, size_t index);
+DLL_PUBLIC uint64_t schedule_profile_percentile(
+    const ScheduleProfile* p, double percentile);
+DLL_PUBLIC int    schedule_profile_write_csv(Schedule* s, FILE* f);
+DLL_PUBLIC size_t schedule_profile_signals(
+    Schedule* s, const char*** signal, double** scalar);
 DLL_PUBLIC void schedule_tick(Schedule* s, double simulation_time);
 DLL_PUBLIC void schedule_info(Schedule* s);
 DLL_PUBLIC void schedule_destroy(Schedule* s);
@@ -7,60 +7,376 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <dse/clib/util/strings.h>
+
+
+#define A85_GROUP_BYTES 4
+#define A85_GROUP_CHARS 5
+#define A85_BLOCK       8 /* Groups per block (fast path). */
+
+
+/* The codec processes blocks of several groups per iteration. The groups of
+a block are independent of each other which allows the compiler to interleave
+the base-85 conversion. Blocks containing a zero group (which may be encoded
+as 'z') are processed group by group. */
+
+/* Character pairs for the values 0..85^2-1, generated at compile time. */
+#define A85_PAIR(h, l)  { (h) + 33, (l) + 33 },
+#define A85_P5(h, l)                                                           \
+    A85_PAIR(h, l) A85_PAIR(h, l + 1) A85_PAIR(h, l + 2) A85_PAIR(h, l + 3)    \
+        A85_PAIR(h, l + 4)
+#define A85_P85(h)                                                             \
+    A85_P5(h, 0) A85_P5(h, 5) A85_P5(h, 10) A85_P5(h, 15) A85_P5(h, 20)        \
+        A85_P5(h, 25) A85_P5(h, 30) A85_P5(h, 35) A85_P5(h, 40) A85_P5(h, 45) \
+            A85_P5(h, 50) A85_P5(h, 55) A85_P5(h, 60) A85_P5(h, 65)           \
+                A85_P5(h, 70) A85_P5(h, 75) A85_P5(h, 80)
+#define A85_R5(h)                                                              \
+    A85_P85(h) A85_P85(h + 1) A85_P85(h + 2) A85_P85(h + 3) A85_P85(h + 4)
+
+static const char __a85_pair[85 * 85][2] = { A85_R5(0) A85_R5(5) A85_R5(10)
+        A85_R5(15) A85_R5(20) A85_R5(25) A85_R5(30) A85_R5(35) A85_R5(40)
+            A85_R5(45) A85_R5(50) A85_R5(55) A85_R5(60) A85_R5(65) A85_R5(70)
+                A85_R5(75) A85_R5(80) };
+
+
+static __inline__ uint32_t _load_be32(const uint8_t* p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 |
+           (uint32_t)p[3];
+}
+
+
+static __inline__ void _store_be32(uint8_t* p, uint32_t x)
+{
+    p[0] = x >> 24;
+    p[1] = x >> 16;
+    p[2] = x >> 8;
+    p[3] = x;
+}
+
+
+static __inline__ void _encode_group(char* en, uint32_t x)
+{
+    /* x = a * 85^4 + b * 85^2 + c, where b and c are encoded as pairs. */
+    uint32_t t = x / (85 * 85);
+    uint32_t c = x - t * (85 * 85);
+    uint32_t a = t / (85 * 85);
+    uint32_t b = t - a * (85 * 85);
+    en[0] = a + 33;
+    memcpy(en + 1, __a85_pair[b], 2);
+    memcpy(en + 3, __a85_pair[c], 2);
+}
+
+
+static __inline__ uint32_t _decode_group(const char* src)
+{
+    uint32_t x = (uint8_t)src[0] - 33;
+    x = x * 85 + ((uint8_t)src[1] - 33);
+    x = x * 85 + ((uint8_t)src[2] - 33);
+    x = x * 85 + ((uint8_t)src[3] - 33);
+    x = x * 85 + ((uint8_t)src[4] - 33);
+    return x;
+}
+
+
+/* A zero group is encoded as 'z' only when it is followed by (at least) 4
+more source bytes, therefore zero groups are held by the stream until the
+next group is complete. */
+static __inline__ char* _encode_next(
+    DseAscii85Stream* s, uint32_t x, char* en)
+{
+    if (s->zero) {
+        *en++ = 'z';
+        s->zero = false;
+    }
+    if (x == 0) {
+        s->zero = true;
+    } else {
+        _encode_group(en, x);
+        en += A85_GROUP_CHARS;
+    }
+    return en;
+}
 
 
 /**
- *  dse_ascii85_encode
+ *  dse_ascii85_stream_init
  *
- *  Encode a binary string with ASCII85 encoding (to a null-terminated string).
+ *  Initialise (or reset) an ASCII85 stream. The same stream object is used
+ *  for either encoding or decoding (not both at once).
+ *
+ *  Parameters
+ *  ----------
+ *  s : DseAscii85Stream*
+ *      The stream object.
+ */
+DLL_PUBLIC void dse_ascii85_stream_init(DseAscii85Stream* s)
+{
+    memset(s, 0, sizeof(DseAscii85Stream));
+}
+
+
+/**
+ *  dse_ascii85_encode_update
+ *
+ *  Encode a chunk of binary data to a caller provided buffer. Partial groups
+ *  are held by the stream and encoded by a following call (or by
+ *  `dse_ascii85_encode_final()`).
  *
  *  Parameters
  *  ----------
+ *  s : DseAscii85Stream*
+ *      The stream object.
+ *
+ *  source : const void*
+ *      The binary data to be encoded.
+ *
+ *  source_len : size_t
+ *      The length of the binary data.
+ *
+ *  target : char*
+ *      Buffer to receive the encoded characters, with at least
+ *      `DSE_ASCII85_ENCODE_SIZE(source_len)` bytes. The characters are not
+ *      null-terminated.
+ *
+ *  Returns
+ *  -------
+ *      size_t : The number of characters written to target.
+ */
+DLL_PUBLIC size_t dse_ascii85_encode_update(DseAscii85Stream* s,
+    const void* source, size_t source_len, char* target)
+{
+    const uint8_t* src = source;
+    char*          en = target;
+
+    /* Complete a held partial group. */
+    if (s->count) {
+        while (s->count < A85_GROUP_BYTES && source_len) {
+            s->data[s->count++] = *src++;
+            source_len--;
+        }
+        if (s->count < A85_GROUP_BYTES) return 0;
+        en = _encode_next(s, _load_be32((uint8_t*)s->data), en);
+        s->count = 0;
+    }
+
+    /* Blocks of groups. */
+    while (source_len >= A85_BLOCK * A85_GROUP_BYTES) {
+        uint32_t x[A85_BLOCK];
+        bool     zero = s->zero;
+        for (int i = 0; i < A85_BLOCK; i++) {
+            x[i] = _load_be32(src + i * A85_GROUP_BYTES);
+            zero |= (x[i] == 0);
+        }
+        if (zero) {
+            for (int i = 0; i < A85_BLOCK; i++) {
+                en = _encode_next(s, x[i], en);
+            }
+        } else {
+            for (int i = 0; i < A85_BLOCK; i++) {
+                _encode_group(en + i * A85_GROUP_CHARS, x[i]);
+            }
+            en += A85_BLOCK * A85_GROUP_CHARS;
+        }
+        src += A85_BLOCK * A85_GROUP_BYTES;
+        source_len -= A85_BLOCK * A85_GROUP_BYTES;
+    }
+
+    /* Remaining groups, and a partial group. */
+    while (source_len >= A85_GROUP_BYTES) {
+        en = _encode_next(s, _load_be32(src), en);
+        src += A85_GROUP_BYTES;
+        source_len -= A85_GROUP_BYTES;
+    }
+    memcpy(s->data, src, source_len);
+    s->count = source_len;
+
+    return en - target;
+}
+
+
+/**
+ *  dse_ascii85_encode_final
+ *
+ *  Complete an encode stream, writing any held groups to target. The stream
+ *  may be reused after calling `dse_ascii85_stream_init()`.
+ *
+ *  Parameters
+ *  ----------
+ *  s : DseAscii85Stream*
+ *      The stream object.
+ *
+ *  target : char*
+ *      Buffer to receive the encoded characters, with at least
+ *      `DSE_ASCII85_ENCODE_SIZE(0)` bytes. The characters are not
+ *      null-terminated.
+ *
+ *  Returns
+ *  -------
+ *      size_t : The number of characters written to target.
+ */
+DLL_PUBLIC size_t dse_ascii85_encode_final(DseAscii85Stream* s, char* target)
+{
+    char* en = target;
+
+    /* A held zero group, not followed by 4 bytes, is encoded in full. */
+    if (s->zero) {
+        _encode_group(en, 0);
+        en += A85_GROUP_CHARS;
+        s->zero = false;
+    }
+    /* The partial group is padded (with 0), the padding is not encoded. */
+    if (s->count) {
+        char group[A85_GROUP_CHARS];
+        memset(s->data + s->count, 0, A85_GROUP_BYTES - s->count);
+        _encode_group(group, _load_be32((uint8_t*)s->data));
+        memcpy(en, group, s->count + 1);
+        en += s->count + 1;
+        s->count = 0;
+    }
+
+    return en - target;
+}
+
+
+/**
+ *  dse_ascii85_decode_update
+ *
+ *  Decode a chunk of ASCII85 characters to a caller provided buffer. Partial
+ *  groups are held by the stream and decoded by a following call (or by
+ *  `dse_ascii85_decode_final()`).
+ *
+ *  Parameters
+ *  ----------
+ *  s : DseAscii85Stream*
+ *      The stream object.
+ *
  *  source : const char*
- *      The binary string to be encoded.
+ *      The ASCII85 characters to be decoded.
  *
  *  source_len : size_t
- *      The length of the binary source string.
+ *      The number of characters.
+ *
+ *  target : void*
+ *      Buffer to receive the decoded data, with at least
+ *      `DSE_ASCII85_DECODE_SIZE(source_len)` bytes.
  *
  *  Returns
  *  -------
- *      char* : ASCII85 encoded string. Caller to free.
+ *      size_t : The number of bytes written to target.
  */
-char* dse_ascii85_encode(const char* source, size_t source_len)
+DLL_PUBLIC size_t dse_ascii85_decode_update(DseAscii85Stream* s,
+    const char* source, size_t source_len, void* target)
 {
-    int required = (source_len + 3) / 4 * 5;
-    int padding = (source_len % 4) ? 4 - (source_len % 4) : 0;
+    uint8_t* de = target;
 
-    /* Encode the source. */
-    char* en = calloc(required + 1, sizeof(char));
-    char* en_save = en;
     while (source_len) {
-        uint32_t x = 0;
-        for (int chunk = 3; chunk >= 0; chunk--) {
-            x |= (uint8_t)*source << (chunk * 8);
-            source++;
-            /* Stop chunking if no more characters are available. */
-            if (--source_len == 0) break;
-        }
-        /* Special Case zero. */
-        if (x == 0 && source_len >= 4) {
-            en[0] = 'z';
-            en += 1;
-            continue;
+        /* Blocks of groups (without 'z'). */
+        if (s->count == 0) {
+            while (source_len >= A85_BLOCK * A85_GROUP_CHARS &&
+                   memchr(source, 'z', A85_BLOCK * A85_GROUP_CHARS) == NULL) {
+                uint32_t x[A85_BLOCK];
+                for (int i = 0; i < A85_BLOCK; i++) {
+                    x[i] = _decode_group(source + i * A85_GROUP_CHARS);
+                }
+                for (int i = 0; i < A85_BLOCK; i++) {
+                    _store_be32(de + i * A85_GROUP_BYTES, x[i]);
+                }
+                de += A85_BLOCK * A85_GROUP_BYTES;
+                source += A85_BLOCK * A85_GROUP_CHARS;
+                source_len -= A85_BLOCK * A85_GROUP_CHARS;
+            }
+            if (source_len == 0) break;
         }
-        for (int byte = 4; byte >= 0; byte--) {
-            en[byte] = (x % 85) + 33;
-            x /= 85;
+
+        /* Single characters. */
+        if (s->count == 0 && *source == 'z') {
+            memset(de, 0, A85_GROUP_BYTES);
+            de += A85_GROUP_BYTES;
+        } else {
+            s->data[s->count++] = *source;
+            if (s->count == A85_GROUP_CHARS) {
+                _store_be32(de, _decode_group(s->data));
+                de += A85_GROUP_BYTES;
+                s->count = 0;
+            }
         }
-        en += 5;
+        source++;
+        source_len--;
     }
 
-    /* Remove (essentially) the padded characters. */
-    for (int i = 1; i <= padding; i++) {
-        en_save[strlen(en_save) - 1] = '\0';
+    return de - (uint8_t*)target;
+}
+
+
+/**
+ *  dse_ascii85_decode_final
+ *
+ *  Complete a decode stream, writing any held partial group to target. The
+ *  stream may be reused after calling `dse_ascii85_stream_init()`.
+ *
+ *  Parameters
+ *  ----------
+ *  s : DseAscii85Stream*
+ *      The stream object.
+ *
+ *  target : void*
+ *      Buffer to receive the decoded data, with at least
+ *      `DSE_ASCII85_DECODE_SIZE(0)` bytes.
+ *
+ *  Returns
+ *  -------
+ *      size_t : The number of bytes written to target.
+ */
+DLL_PUBLIC size_t dse_ascii85_decode_final(DseAscii85Stream* s, void* target)
+{
+    size_t len = 0;
+
+    /* The partial group is padded (with 'u'), the padding is not decoded. */
+    if (s->count) {
+        uint8_t group[A85_GROUP_BYTES];
+        memset(s->data + s->count, 'u', A85_GROUP_CHARS - s->count);
+        _store_be32(group, _decode_group(s->data));
+        len = s->count - 1;
+        memcpy(target, group, len);
+        s->count = 0;
     }
 
-    return en_save;
+    return len;
+}
+
+
+/**
+ *  dse_ascii85_encode
+ *
+ *  Encode a binary string with ASCII85 encoding (to a null-terminated string).
+ *
+ *  Parameters
+ *  ----------
+ *  source : const char*
+ *      The binary string to be encoded.
+ *
+ *  source_len : size_t
+ *      The length of the binary source string.
+ *
+ *  Returns
+ *  -------
+ *      char* : ASCII85 encoded string. Caller to free.
+ */
+DLL_PUBLIC char* dse_ascii85_encode(const char* source, size_t source_len)
+{
+    /* Each group encodes to at most 5 characters. */
+    size_t required = (source_len + 3) / 4 * 5;
+    char*  en = malloc(required + 1);
+    if (en == NULL) return NULL;
+
+    DseAscii85Stream s;
+    dse_ascii85_stream_init(&s);
+    size_t len = dse_ascii85_encode_update(&s, source, source_len, en);
+    len += dse_ascii85_encode_final(&s, en + len);
+    en[len] = '\0';
+
+    return en;
 }
 
 
@@ -80,59 +396,32 @@ char* dse_ascii85_encode(const char* source, size_t source_len)
  *
  *  Returns
  *  -------
- *      char* : Binary string decoded from source. Caller to free.
+ *      char* : Binary string decoded from source (null-terminated). Caller to
+ *              free.
  */
-char* dse_ascii85_decode(const char* source, size_t* len)
+DLL_PUBLIC char* dse_ascii85_decode(const char* source, size_t* len)
 {
     /*
-    Decode is 5 -> 4, or 1 -> 4 for 'z' case. Calculate parameters with
-    necessary corrections.
+    Decode is 5 -> 4, or 1 -> 4 for 'z' case. Calculate the required size
+    with necessary corrections.
     */
-    int z_count = 0;
-    for (const char* p = source; *p; p++) {
-        if (*p == 'z') z_count++;
-    }
-    int required = (strlen(source) - z_count + 4) / 5 * 4 + z_count * 4;
-    int source_len = strlen(source) + z_count * 4;
-    int padding = (source_len % 5) ? (5 - (source_len % 5)) : 0;
-
-    /* Pad the source string. */
-    int   padded_len = strlen(source) + padding;
-    char* source_padded = calloc(padded_len + 1, sizeof(char));
-    snprintf(source_padded, padded_len + 1, "%s", source);
-    for (int i = 0; i < padding; i++) {
-        source_padded[strlen(source) + i] = 'u';
+    size_t source_len = strlen(source);
+    size_t z_count = 0;
+    for (const char* p = source; (p = memchr(p, 'z', source + source_len - p));
+         p++) {
+        z_count++;
     }
+    size_t required = (source_len - z_count + 4) / 5 * 4 + z_count * 4;
+    char*  de = malloc(required + 1);
+    if (de == NULL) return NULL;
 
-    /* Decode the source. */
-    char* en = calloc(required + 1, sizeof(char));
-    char* en_walker = en;
-    char* src_walker = source_padded;
-    while (padded_len > 0) {
-        uint32_t x = 0;
-        if (src_walker[0] == 'z') {
-            padded_len--;
-            src_walker += 1;
-        } else {
-            for (int chunk = 0; chunk <= 4; chunk++) {
-                x = x * 85 + (src_walker[chunk] - 33);
-                padded_len--;
-            }
-            src_walker += 5;
-        }
-        for (int byte = 3; byte >= 0; byte--) {
-            *en_walker = x >> (byte * 8);
-            en_walker++;
-        }
-    }
-    free(source_padded);
-
-    /* Correct the padding. */
-    for (int i = 1; i <= padding; i++) {
-        en[required - i] = '\0';
-    }
+    DseAscii85Stream s;
+    dse_ascii85_stream_init(&s);
+    size_t _len = dse_ascii85_decode_update(&s, source, source_len, de);
+    _len += dse_ascii85_decode_final(&s, de + _len);
+    de[_len] = '\0';
 
     /* Return the decoded binary string, and length. */
-    *len = required - padding;
-    return en;
+    *len = _len;
+    return de;
 }
@@ -5,6 +5,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <dse/testing.h>
 #include <dse/clib/util/strings.h>
 
@@ -12,7 +13,8 @@
 /**
  *  dse_buffer_append
  *
- *  Append a binary object to a buffer. Resize the buffer if necessary.
+ *  Append a binary object to a buffer. Resize the buffer if necessary, the
+ *  buffer grows geometrically (so that repeated appends are amortised).
  *
  *  Parameters
  *  ----------
@@ -34,13 +36,202 @@ void dse_buffer_append(void** buffer, uint32_t* size, uint32_t* buffer_size,
 {
     if (buffer == NULL) return;
     if (binary == NULL) return;
-    /* Resize the buffer if necessary. */
+    /* Resize the buffer if necessary (with geometric growth). */
     uint32_t _required_size = *size + binary_size;
     if (_required_size > *buffer_size) {
-        *buffer = realloc(*buffer, _required_size);
-        *buffer_size = _required_size;
+        size_t _size = dse_buffer_grow(*buffer_size, _required_size);
+        if (_size > UINT32_MAX) _size = _required_size;
+        void* _buffer = realloc(*buffer, _size);
+        if (_buffer == NULL) return;
+        *buffer = _buffer;
+        *buffer_size = _size;
     }
     /* Append the binary object to the buffer. */
     memcpy((*buffer + *size), binary, binary_size);
     *size += binary_size;
 }
+
+
+/**
+ *  dse_bytebuf_init
+ *
+ *  Initialise a byte buffer (empty, held inline). A zero initialised
+ *  DseByteBuf object is also a valid (empty) byte buffer.
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseByteBuf*
+ *      The byte buffer.
+ */
+void dse_bytebuf_init(DseByteBuf* b)
+{
+    if (b == NULL) return;
+    memset(b, 0, sizeof(DseByteBuf));
+}
+
+
+/**
+ *  dse_bytebuf_reserve
+ *
+ *  Ensure that the byte buffer can hold the given length without further
+ *  allocation. Storage grows geometrically.
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseByteBuf*
+ *      The byte buffer.
+ *  len : size_t
+ *      Length of the content.
+ *
+ *  Returns
+ *  -------
+ *      0 : The storage is available.
+ *      ENOMEM : The storage could not be allocated.
+ */
+int dse_bytebuf_reserve(DseByteBuf* b, size_t len)
+{
+    if (b == NULL) return EINVAL;
+    if (b->heap == NULL && len <= DSE_BUF_INLINE_SIZE) return 0;
+    if (b->heap && len <= b->size) return 0;
+
+    size_t   size =
+        dse_buffer_grow(b->size ? b->size : DSE_BUF_INLINE_SIZE, len);
+    uint8_t* heap = realloc(b->heap, size);
+    if (heap == NULL) return ENOMEM;
+    if (b->heap == NULL) memcpy(heap, b->inline_data, b->len);
+    b->heap = heap;
+    b->size = size;
+    return 0;
+}
+
+
+/**
+ *  dse_bytebuf_append
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseByteBuf*
+ *      The byte buffer.
+ *  data : const void*
+ *      The data to append.
+ *  n : size_t
+ *      Length of the data.
+ *
+ *  Returns
+ *  -------
+ *      0 : The data was appended.
+ *      ENOMEM : The storage could not be allocated.
+ */
+int dse_bytebuf_append(DseByteBuf* b, const void* data, size_t n)
+{
+    if (b == NULL || (data == NULL && n)) return EINVAL;
+    int rc = dse_bytebuf_reserve(b, b->len + n);
+    if (rc) return rc;
+    if (n) memcpy((uint8_t*)dse_bytebuf_data(b) + b->len, data, n);
+    b->len += n;
+    return 0;
+}
+
+
+/**
+ *  dse_bytebuf_clear
+ *
+ *  Set the length of the byte buffer to 0 (storage is retained).
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseByteBuf*
+ *      The byte buffer.
+ */
+void dse_bytebuf_clear(DseByteBuf* b)
+{
+    if (b == NULL) return;
+    b->len = 0;
+}
+
+
+/**
+ *  dse_bytebuf_shrink
+ *
+ *  Release unused storage of the byte buffer (the content is moved inline
+ *  when it fits).
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseByteBuf*
+ *      The byte buffer.
+ *
+ *  Returns
+ *  -------
+ *      0 : The storage was shrunk (or not necessary).
+ *      ENOMEM : The storage could not be reallocated.
+ */
+int dse_bytebuf_shrink(DseByteBuf* b)
+{
+    if (b == NULL) return EINVAL;
+    if (b->heap == NULL) return 0;
+    if (b->len <= DSE_BUF_INLINE_SIZE) {
+        memcpy(b->inline_data, b->heap, b->len);
+        free(b->heap);
+        b->heap = NULL;
+        b->size = 0;
+        return 0;
+    }
+    uint8_t* heap = realloc(b->heap, b->len);
+    if (heap == NULL) return ENOMEM;
+    b->heap = heap;
+    b->size = b->len;
+    return 0;
+}
+
+
+/**
+ *  dse_bytebuf_release
+ *
+ *  Release the content from the byte buffer, the byte buffer is then reset
+ *  (empty).
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseByteBuf*
+ *      The byte buffer.
+ *  len : size_t*
+ *      Optional, set to the length of the released content.
+ *
+ *  Returns
+ *  -------
+ *      void* : The content. Caller to free.
+ *      NULL : The content could not be allocated (or is empty and inline).
+ */
+void* dse_bytebuf_release(DseByteBuf* b, size_t* len)
+{
+    if (b == NULL) return NULL;
+    uint8_t* data = b->heap;
+    if (data == NULL && b->len) {
+        data = malloc(b->len);
+        if (data == NULL) return NULL;
+        memcpy(data, b->inline_data, b->len);
+    }
+    if (len) *len = b->len;
+    dse_bytebuf_init(b);
+    return data;
+}
+
+
+/**
+ *  dse_bytebuf_destroy
+ *
+ *  Release the storage of the byte buffer, the byte buffer is then reset
+ *  (empty).
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseByteBuf*
+ *      The byte buffer.
+ */
+void dse_bytebuf_destroy(DseByteBuf* b)
+{
+    if (b == NULL) return;
+    free(b->heap);
+    dse_bytebuf_init(b);
+}
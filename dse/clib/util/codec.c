@@ -0,0 +1,483 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dse/clib/util/strings.h>
+
+
+#define B64_BLOCK 4 /* Groups per block (fast path). */
+#define Z85_BLOCK 8 /* Groups per block (fast path). */
+
+
+/* Character pairs for the values 0..4095 (12 bits), generated at compile
+time. */
+#define B64_CHAR(v)                                                            \
+    ((v) < 26 ? 'A' + (v) : (v) < 52 ? 'a' + (v) - 26                          \
+        : (v) < 62 ? '0' + (v) - 52 : (v) == 62 ? '+' : '/')
+#define B64_PAIR(h, l) { B64_CHAR(h), B64_CHAR(l) },
+#define B64_P4(h, l)                                                           \
+    B64_PAIR(h, l) B64_PAIR(h, l + 1) B64_PAIR(h, l + 2) B64_PAIR(h, l + 3)
+#define B64_P16(h, l)                                                          \
+    B64_P4(h, l) B64_P4(h, l + 4) B64_P4(h, l + 8) B64_P4(h, l + 12)
+#define B64_P64(h)                                                             \
+    B64_P16(h, 0) B64_P16(h, 16) B64_P16(h, 32) B64_P16(h, 48)
+#define B64_R4(h) B64_P64(h) B64_P64(h + 1) B64_P64(h + 2) B64_P64(h + 3)
+#define B64_R16(h) B64_R4(h) B64_R4(h + 4) B64_R4(h + 8) B64_R4(h + 12)
+
+static const char __b64_pair[64 * 64][2] = { B64_R16(0) B64_R16(16)
+        B64_R16(32) B64_R16(48) };
+
+static const uint8_t __b64_value[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b,
+    0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+    0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20,
+    0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+    0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+static const char __z85_alphabet[] =
+    "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ.-:+=^!/*?&"
+    "<>()[]{}@%$#";
+
+static const uint8_t __z85_value[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x44, 0xff, 0x54, 0x53, 0x52, 0x48, 0xff,
+    0x4b, 0x4c, 0x46, 0x41, 0xff, 0x3f, 0x3e, 0x45,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x40, 0xff, 0x49, 0x42, 0x4a, 0x47,
+    0x51, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a,
+    0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32,
+    0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a,
+    0x3b, 0x3c, 0x3d, 0x4d, 0xff, 0x4e, 0x43, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+    0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+    0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20,
+    0x21, 0x22, 0x23, 0x4f, 0xff, 0x50, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+
+/* The codecs process blocks of several groups per iteration. The groups of
+a block are independent of each other which allows the compiler to interleave
+the conversions, invalid characters are detected once per block. */
+
+static __inline__ void _b64_encode_group(char* en, const uint8_t* src)
+{
+    uint32_t x = (uint32_t)src[0] << 16 | (uint32_t)src[1] << 8 | src[2];
+    memcpy(en, __b64_pair[x >> 12], 2);
+    memcpy(en + 2, __b64_pair[x & 0xfff], 2);
+}
+
+
+static __inline__ uint32_t _b64_decode_group(const char* src, uint8_t* check)
+{
+    uint8_t a = __b64_value[(uint8_t)src[0]];
+    uint8_t b = __b64_value[(uint8_t)src[1]];
+    uint8_t c = __b64_value[(uint8_t)src[2]];
+    uint8_t d = __b64_value[(uint8_t)src[3]];
+    *check |= a | b | c | d;
+    return (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | d;
+}
+
+
+static __inline__ void _z85_encode_group(char* en, const uint8_t* src)
+{
+    uint32_t x = (uint32_t)src[0] << 24 | (uint32_t)src[1] << 16 |
+                 (uint32_t)src[2] << 8 | (uint32_t)src[3];
+    /* x = a * 85^4 + b * 85^2 + c, b and c are then split into digits. */
+    uint32_t t = x / (85 * 85);
+    uint32_t c = x - t * (85 * 85);
+    uint32_t a = t / (85 * 85);
+    uint32_t b = t - a * (85 * 85);
+    en[0] = __z85_alphabet[a];
+    en[1] = __z85_alphabet[b / 85];
+    en[2] = __z85_alphabet[b % 85];
+    en[3] = __z85_alphabet[c / 85];
+    en[4] = __z85_alphabet[c % 85];
+}
+
+
+static __inline__ uint64_t _z85_decode_group(const char* src, uint8_t* check)
+{
+    uint8_t d0 = __z85_value[(uint8_t)src[0]];
+    uint8_t d1 = __z85_value[(uint8_t)src[1]];
+    uint8_t d2 = __z85_value[(uint8_t)src[2]];
+    uint8_t d3 = __z85_value[(uint8_t)src[3]];
+    uint8_t d4 = __z85_value[(uint8_t)src[4]];
+    *check |= d0 | d1 | d2 | d3 | d4;
+    return (((((uint64_t)d0 * 85 + d1) * 85 + d2) * 85 + d3) * 85) + d4;
+}
+
+
+static __inline__ void _store_be32(uint8_t* p, uint32_t x)
+{
+    p[0] = x >> 24;
+    p[1] = x >> 16;
+    p[2] = x >> 8;
+    p[3] = x;
+}
+
+
+/**
+ *  dse_base64_encode
+ *
+ *  Encode a binary string with Base64 encoding (RFC 4648, with padding) to a
+ *  null-terminated string.
+ *
+ *  Parameters
+ *  ----------
+ *  source : const char*
+ *      The binary string to be encoded.
+ *
+ *  source_len : size_t
+ *      The length of the binary source string.
+ *
+ *  Returns
+ *  -------
+ *      char* : Base64 encoded string. Caller to free.
+ */
+DLL_PUBLIC char* dse_base64_encode(const char* source, size_t source_len)
+{
+    const uint8_t* src = (const uint8_t*)source;
+    char*          en = malloc((source_len + 2) / 3 * 4 + 1);
+    char*          en_save = en;
+    if (en == NULL) return NULL;
+
+    /* Blocks of groups, then remaining groups. */
+    while (source_len >= B64_BLOCK * 3) {
+        for (int i = 0; i < B64_BLOCK; i++) {
+            _b64_encode_group(en + i * 4, src + i * 3);
+        }
+        en += B64_BLOCK * 4;
+        src += B64_BLOCK * 3;
+        source_len -= B64_BLOCK * 3;
+    }
+    while (source_len >= 3) {
+        _b64_encode_group(en, src);
+        en += 4;
+        src += 3;
+        source_len -= 3;
+    }
+
+    /* Partial group, padded with '='. */
+    if (source_len) {
+        uint8_t group[3] = { src[0], (source_len > 1) ? src[1] : 0, 0 };
+        _b64_encode_group(en, group);
+        en[3] = '=';
+        if (source_len == 1) en[2] = '=';
+        en += 4;
+    }
+    *en = '\0';
+
+    return en_save;
+}
+
+
+/**
+ *  dse_base64_decode
+ *
+ *  Decode a Base64 encoded string into a binary string (may contain null
+ *  characters). The padding characters are optional.
+ *
+ *  Parameters
+ *  ----------
+ *  source : const char*
+ *      The Base64 string to be decoded.
+ *
+ *  len : size_t*
+ *      Pointer which should receive the length of the resultant binary string.
+ *
+ *  Returns
+ *  -------
+ *      char* : Binary string decoded from source (null-terminated). Caller to
+ *              free.
+ *      NULL : The source is not valid Base64, errno is set to EINVAL.
+ */
+DLL_PUBLIC char* dse_base64_decode(const char* source, size_t* len)
+{
+    *len = 0;
+    if (source == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
+    size_t source_len = strlen(source);
+    for (int i = 0; i < 2 && source_len && source[source_len - 1] == '='; i++) {
+        source_len--;
+    }
+    if (source_len % 4 == 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+    uint8_t* de = malloc(source_len / 4 * 3 + 3);
+    uint8_t* de_save = de;
+    uint8_t  check = 0;
+    if (de == NULL) return NULL;
+
+    /* Blocks of groups, then remaining groups. */
+    while (source_len >= B64_BLOCK * 4) {
+        uint32_t x[B64_BLOCK];
+        for (int i = 0; i < B64_BLOCK; i++) {
+            x[i] = _b64_decode_group(source + i * 4, &check);
+        }
+        for (int i = 0; i < B64_BLOCK; i++) {
+            de[i * 3] = x[i] >> 16;
+            de[i * 3 + 1] = x[i] >> 8;
+            de[i * 3 + 2] = x[i];
+        }
+        de += B64_BLOCK * 3;
+        source += B64_BLOCK * 4;
+        source_len -= B64_BLOCK * 4;
+    }
+    while (source_len >= 4) {
+        uint32_t x = _b64_decode_group(source, &check);
+        de[0] = x >> 16;
+        de[1] = x >> 8;
+        de[2] = x;
+        de += 3;
+        source += 4;
+        source_len -= 4;
+    }
+
+    /* Partial group (2 or 3 characters). */
+    if (source_len) {
+        char group[4] = { source[0], source[1],
+            (source_len > 2) ? source[2] : 'A', 'A' };
+        uint32_t x = _b64_decode_group(group, &check);
+        *de++ = x >> 16;
+        if (source_len > 2) *de++ = x >> 8;
+    }
+    if (check & 0x80) {
+        free(de_save);
+        errno = EINVAL;
+        return NULL;
+    }
+    *de = '\0';
+
+    *len = de - de_save;
+    return (char*)de_save;
+}
+
+
+/**
+ *  dse_z85_encode
+ *
+ *  Encode a binary string with Z85 encoding (ZeroMQ RFC 32) to a
+ *  null-terminated string. A source length which is not a multiple of 4 is
+ *  padded (with 0) and the padding is not encoded (as with ASCII85).
+ *
+ *  Parameters
+ *  ----------
+ *  source : const char*
+ *      The binary string to be encoded.
+ *
+ *  source_len : size_t
+ *      The length of the binary source string.
+ *
+ *  Returns
+ *  -------
+ *      char* : Z85 encoded string. Caller to free.
+ */
+DLL_PUBLIC char* dse_z85_encode(const char* source, size_t source_len)
+{
+    const uint8_t* src = (const uint8_t*)source;
+    char*          en = malloc((source_len + 3) / 4 * 5 + 1);
+    char*          en_save = en;
+    if (en == NULL) return NULL;
+
+    /* Blocks of groups, then remaining groups. */
+    while (source_len >= Z85_BLOCK * 4) {
+        for (int i = 0; i < Z85_BLOCK; i++) {
+            _z85_encode_group(en + i * 5, src + i * 4);
+        }
+        en += Z85_BLOCK * 5;
+        src += Z85_BLOCK * 4;
+        source_len -= Z85_BLOCK * 4;
+    }
+    while (source_len >= 4) {
+        _z85_encode_group(en, src);
+        en += 5;
+        src += 4;
+        source_len -= 4;
+    }
+
+    /* Partial group, the padding is not encoded. */
+    if (source_len) {
+        uint8_t group[4] = { 0 };
+        char    chars[5];
+        memcpy(group, src, source_len);
+        _z85_encode_group(chars, group);
+        memcpy(en, chars, source_len + 1);
+        en += source_len + 1;
+    }
+    *en = '\0';
+
+    return en_save;
+}
+
+
+/**
+ *  dse_z85_decode
+ *
+ *  Decode a Z85 encoded string into a binary string (may contain null
+ *  characters).
+ *
+ *  Parameters
+ *  ----------
+ *  source : const char*
+ *      The Z85 string to be decoded.
+ *
+ *  len : size_t*
+ *      Pointer which should receive the length of the resultant binary string.
+ *
+ *  Returns
+ *  -------
+ *      char* : Binary string decoded from source (null-terminated). Caller to
+ *              free.
+ *      NULL : The source is not valid Z85, errno is set to EINVAL.
+ */
+DLL_PUBLIC char* dse_z85_decode(const char* source, size_t* len)
+{
+    *len = 0;
+    if (source == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
+    size_t source_len = strlen(source);
+    if (source_len % 5 == 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+    uint8_t* de = malloc(source_len / 5 * 4 + 4);
+    uint8_t* de_save = de;
+    uint8_t  check = 0;
+    uint64_t over = 0;
+    if (de == NULL) return NULL;
+
+    /* Blocks of groups, then remaining groups. */
+    while (source_len >= Z85_BLOCK * 5) {
+        uint64_t x[Z85_BLOCK];
+        for (int i = 0; i < Z85_BLOCK; i++) {
+            x[i] = _z85_decode_group(source + i * 5, &check);
+            over |= x[i] >> 32;
+        }
+        for (int i = 0; i < Z85_BLOCK; i++) {
+            _store_be32(de + i * 4, x[i]);
+        }
+        de += Z85_BLOCK * 4;
+        source += Z85_BLOCK * 5;
+        source_len -= Z85_BLOCK * 5;
+    }
+    while (source_len >= 5) {
+        uint64_t x = _z85_decode_group(source, &check);
+        over |= x >> 32;
+        _store_be32(de, x);
+        de += 4;
+        source += 5;
+        source_len -= 5;
+    }
+
+    /* Partial group, padded with the highest digit. */
+    if (source_len) {
+        char    group[5] = { '#', '#', '#', '#', '#' };
+        uint8_t bytes[4];
+        memcpy(group, source, source_len);
+        uint64_t x = _z85_decode_group(group, &check);
+        over |= x >> 32;
+        _store_be32(bytes, x);
+        memcpy(de, bytes, source_len - 1);
+        de += source_len - 1;
+    }
+    if ((check & 0x80) || over) {
+        free(de_save);
+        errno = EINVAL;
+        return NULL;
+    }
+    *de = '\0';
+
+    *len = de - de_save;
+    return (char*)de_save;
+}
+
+
+static const DseTextCodec __codec_table[] = {
+    { "ascii85", dse_ascii85_encode, dse_ascii85_decode },
+    { "base64", dse_base64_encode, dse_base64_decode },
+    { "z85", dse_z85_encode, dse_z85_decode },
+};
+
+
+/**
+ *  dse_text_codec_find
+ *
+ *  Find a binary-to-text codec by name. The codec functions have the same
+ *  signature as `MarshalStringEncode`/`MarshalStringDecode` and may be
+ *  selected for a MarshalGroup with `marshal_group_set_codec()`.
+ *
+ *  Parameters
+ *  ----------
+ *  name : const char*
+ *      The codec name; one of "ascii85", "base64" or "z85".
+ *
+ *  Returns
+ *  -------
+ *      const DseTextCodec* : The codec.
+ *      NULL : No codec with that name, errno is set to EINVAL.
+ */
+DLL_PUBLIC const DseTextCodec* dse_text_codec_find(const char* name)
+{
+    size_t count = sizeof(__codec_table) / sizeof(__codec_table[0]);
+    for (size_t i = 0; name && i < count; i++) {
+        if (strcmp(__codec_table[i].name, name) == 0) return &__codec_table[i];
+    }
+    errno = EINVAL;
+    return NULL;
+}
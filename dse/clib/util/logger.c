@@ -0,0 +1,1357 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <dse/logger.h>
+#include <dse/clib/util/strings.h>
+#include <dse/clib/util/logger.h>
+
+
+#define UNUSED(x)          ((void)x)
+#define RING_SIZE_DEFAULT  (64 * 1024)
+#define RING_SIZE_MIN      (4 * 1024)
+#define RECORD_ARGS_MAX    1024 /* Packed arguments (or formatted text). */
+#define RECORD_ALIGN(x)    (((x) + 7) & ~(size_t)7)
+#define RECORD_TEXT        0x01 /* Args hold the formatted message. */
+#define SPEC_MAX           32   /* Length of a conversion specification. */
+#define BATCH_SIZE         (64 * 1024)
+#define IDLE_WAIT_NS       1000000
+#define BLOCK_WAIT_NS      20000
+#define CACHE_LINE         64
+
+
+/* Record header, followed by the packed arguments. Records are 8 byte aligned
+and contiguous in the ring, a record with size 0 marks the end of the ring
+(the next record is at the start of the ring). */
+typedef struct LogRecord {
+    uint32_t    size; /* Record size, including header and arguments. */
+    uint8_t     level;
+    uint8_t     flags;
+    uint16_t    __reserved__;
+    int32_t     line;
+    uint32_t    args_len;
+    int64_t     timestamp; /* Realtime, ns. */
+    const char* file;
+    const char* format;
+} LogRecord;
+
+/* Single producer (the owning thread), single consumer (the logger thread).
+The head/tail are free running counters, each written by only one side. */
+typedef struct LogRing {
+    uint64_t head; /* Producer. */
+    uint64_t dropped;
+    uint64_t blocked;
+    uint8_t  __pad_head__[CACHE_LINE - 3 * sizeof(uint64_t)];
+    uint64_t tail; /* Consumer. */
+    uint8_t  __pad_tail__[CACHE_LINE - sizeof(uint64_t)];
+
+    uint8_t*        data;
+    size_t          size; /* Power of 2. */
+    uint64_t        dropped_reported;
+    bool            closed; /* The owning thread has exited. */
+    struct LogRing* next;
+} LogRing;
+
+static struct {
+    bool            running;
+    bool            stop;
+    DseLoggerConfig config;
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  wake_cond;
+    pthread_cond_t  flush_cond;
+    uint64_t        flush_request;
+    uint64_t        flush_done;
+    uint64_t        records;
+    LogRing*        rings;
+    pthread_key_t   key;
+    pthread_once_t  once;
+} __logger = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake_cond = PTHREAD_COND_INITIALIZER,
+    .flush_cond = PTHREAD_COND_INITIALIZER,
+    .once = PTHREAD_ONCE_INIT,
+};
+
+static __thread LogRing* __ring = NULL;
+
+
+/* Printf conversion specifications
+   ================================ */
+
+typedef enum LogArgType {
+    LOG_ARG_NONE = 0, /* "%%" */
+    LOG_ARG_INT,
+    LOG_ARG_LONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_SIZE,
+    LOG_ARG_INTMAX,
+    LOG_ARG_PTRDIFF,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_LDOUBLE,
+    LOG_ARG_STRING,
+    LOG_ARG_POINTER,
+    LOG_ARG_INVALID, /* Not supported, format on the calling thread. */
+} LogArgType;
+
+typedef struct LogSpec {
+    const char* start; /* The '%' character. */
+    size_t      len;
+    uint32_t    stars;     /* Width/precision arguments ('*'). */
+    const char* precision; /* The '.' character, NULL if none. */
+    LogArgType  type;
+} LogSpec;
+
+
+static bool _isdigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+
+static bool _next_spec(const char* format, LogSpec* spec)
+{
+    const char* p = strchr(format, '%');
+    if (p == NULL) return false;
+    spec->start = p++;
+    spec->stars = 0;
+    spec->precision = NULL;
+
+    /* Flags, width and precision. */
+    while (*p && strchr("-+ #0'", *p)) p++;
+    if (*p == '*') {
+        spec->stars++;
+        p++;
+    }
+    while (_isdigit(*p)) p++;
+    if (*p == '.') {
+        spec->precision = p++;
+        if (*p == '*') {
+            spec->stars++;
+            p++;
+        }
+        while (_isdigit(*p)) p++;
+    }
+
+    /* Length modifier. */
+    char len[3] = { 0 };
+    for (int i = 0; i < 2 && *p && strchr("hlLqjzZt", *p); i++) {
+        len[i] = *p++;
+    }
+
+    /* Conversion. */
+    switch (*p) {
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        if (len[0] == '\0' || len[0] == 'h') {
+            spec->type = LOG_ARG_INT;
+        } else if (strcmp(len, "l") == 0) {
+            spec->type = LOG_ARG_LONG;
+        } else if (strcmp(len, "ll") == 0 || strcmp(len, "q") == 0) {
+            spec->type = LOG_ARG_LLONG;
+        } else if (strcmp(len, "z") == 0 || strcmp(len, "Z") == 0) {
+            spec->type = LOG_ARG_SIZE;
+        } else if (strcmp(len, "j") == 0) {
+            spec->type = LOG_ARG_INTMAX;
+        } else if (strcmp(len, "t") == 0) {
+            spec->type = LOG_ARG_PTRDIFF;
+        } else {
+            spec->type = LOG_ARG_INVALID;
+        }
+        break;
+    case 'c':
+        spec->type = len[0] ? LOG_ARG_INVALID : LOG_ARG_INT;
+        break;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        if (len[0] == '\0' || strcmp(len, "l") == 0) {
+            spec->type = LOG_ARG_DOUBLE;
+        } else if (strcmp(len, "L") == 0) {
+            spec->type = LOG_ARG_LDOUBLE;
+        } else {
+            spec->type = LOG_ARG_INVALID;
+        }
+        break;
+    case 's':
+        spec->type = len[0] ? LOG_ARG_INVALID : LOG_ARG_STRING;
+        break;
+    case 'p':
+        spec->type = LOG_ARG_POINTER;
+        break;
+    case '%':
+        spec->type = LOG_ARG_NONE;
+        break;
+    default:
+        /* Including %n, %m, wide characters and positional arguments. */
+        spec->type = LOG_ARG_INVALID;
+        return true;
+    }
+    spec->len = p + 1 - spec->start;
+    if (spec->len > SPEC_MAX) spec->type = LOG_ARG_INVALID;
+    return true;
+}
+
+
+/* The precision of a specification, star is the value of the last '*'
+argument. Returns -1 if there is no precision (or it is negative). */
+static int _spec_precision(const LogSpec* spec, int star)
+{
+    if (spec->precision == NULL) return -1;
+    if (spec->precision[1] == '*') return star < 0 ? -1 : star;
+    return atoi(spec->precision + 1);
+}
+
+
+/* Arguments are packed into 8 byte slots (long double uses 2 slots), strings
+are packed as a length slot followed by the (null-terminated) string. A
+string with a precision is only read up to the precision, it need not be
+terminated. */
+static int _pack_args(
+    uint8_t* buf, size_t size, const char* format, va_list* args)
+{
+    size_t  len = 0;
+    LogSpec spec;
+    int     star = 0;
+
+#define PACK(T, V)                                                             \
+    do {                                                                       \
+        T _v = (V);                                                            \
+        if (len + RECORD_ALIGN(sizeof(T)) > size) return -1;                   \
+        memcpy(buf + len, &_v, sizeof(T));                                     \
+        len += RECORD_ALIGN(sizeof(T));                                        \
+    } while (0)
+
+    for (const char* f = format; _next_spec(f, &spec);
+         f = spec.start + spec.len) {
+        for (uint32_t i = 0; i < spec.stars; i++) {
+            star = va_arg(*args, int);
+            PACK(int64_t, star);
+        }
+        switch (spec.type) {
+        case LOG_ARG_NONE:
+            break;
+        case LOG_ARG_INT:
+            PACK(int64_t, va_arg(*args, int));
+            break;
+        case LOG_ARG_LONG:
+            PACK(int64_t, va_arg(*args, long));
+            break;
+        case LOG_ARG_LLONG:
+            PACK(int64_t, va_arg(*args, long long));
+            break;
+        case LOG_ARG_SIZE:
+            PACK(uint64_t, va_arg(*args, size_t));
+            break;
+        case LOG_ARG_INTMAX:
+            PACK(int64_t, va_arg(*args, intmax_t));
+            break;
+        case LOG_ARG_PTRDIFF:
+            PACK(int64_t, va_arg(*args, ptrdiff_t));
+            break;
+        case LOG_ARG_DOUBLE:
+            PACK(double, va_arg(*args, double));
+            break;
+        case LOG_ARG_LDOUBLE:
+            PACK(long double, va_arg(*args, long double));
+            break;
+        case LOG_ARG_POINTER:
+            PACK(uint64_t, (uintptr_t)va_arg(*args, void*));
+            break;
+        case LOG_ARG_STRING: {
+            const char* s = va_arg(*args, const char*);
+            int         precision = _spec_precision(&spec, star);
+            size_t      s_len = 0;
+            if (s) s_len = precision < 0 ? strlen(s) : strnlen(s, precision);
+            PACK(uint64_t, s ? s_len : UINT64_MAX);
+            if (len + RECORD_ALIGN(s_len + 1) > size) return -1;
+            if (s) memcpy(buf + len, s, s_len);
+            buf[len + s_len] = '\0';
+            len += RECORD_ALIGN(s_len + 1);
+        } break;
+        default:
+            return -1;
+        }
+    }
+#undef PACK
+
+    return len;
+}
+
+
+/* Arguments are validated against the record (which may be from a trace),
+returns EINVAL if they do not match the format. */
+static int _format_args(
+    DseStrBuf* out, const char* format, const uint8_t* args, size_t args_len)
+{
+    const uint8_t* a = args;
+    const uint8_t* a_end = args + args_len;
+    LogSpec        spec;
+    const char*    f = format;
+
+#define UNPACK(T, V)                                                           \
+    do {                                                                       \
+        if (RECORD_ALIGN(sizeof(T)) > (size_t)(a_end - a)) return EINVAL;      \
+        memcpy(&(V), a, sizeof(T));                                            \
+        a += RECORD_ALIGN(sizeof(T));                                          \
+    } while (0)
+
+    for (; _next_spec(f, &spec); f = spec.start + spec.len) {
+        dse_strbuf_append_n(out, f, spec.start - f);
+        if (spec.type == LOG_ARG_NONE) {
+            dse_strbuf_append(out, "%");
+            continue;
+        }
+
+        /* Conversion specification, with '*' replaced by the argument. */
+        char fmt[SPEC_MAX + 2 * 24];
+        int  fmt_len = 0;
+        for (size_t i = 0; i < spec.len; i++) {
+            if (spec.start[i] == '*') {
+                int64_t v = 0;
+                UNPACK(int64_t, v);
+                if (v < 0 && spec.start + i == spec.precision + 1) {
+                    fmt_len--; /* A negative precision is taken as omitted. */
+                    continue;
+                }
+                fmt_len += snprintf(
+                    fmt + fmt_len, sizeof(fmt) - fmt_len, "%d", (int)v);
+            } else {
+                fmt[fmt_len++] = spec.start[i];
+            }
+        }
+        fmt[fmt_len] = '\0';
+
+        int64_t     i64 = 0;
+        uint64_t    u64 = 0;
+        double      d = 0;
+        long double ld = 0;
+        switch (spec.type) {
+        case LOG_ARG_INT:
+            UNPACK(int64_t, i64);
+            dse_strbuf_appendf(out, fmt, (int)i64);
+            break;
+        case LOG_ARG_LONG:
+            UNPACK(int64_t, i64);
+            dse_strbuf_appendf(out, fmt, (long)i64);
+            break;
+        case LOG_ARG_LLONG:
+            UNPACK(int64_t, i64);
+            dse_strbuf_appendf(out, fmt, (long long)i64);
+            break;
+        case LOG_ARG_SIZE:
+            UNPACK(uint64_t, u64);
+            dse_strbuf_appendf(out, fmt, (size_t)u64);
+            break;
+        case LOG_ARG_INTMAX:
+            UNPACK(int64_t, i64);
+            dse_strbuf_appendf(out, fmt, (intmax_t)i64);
+            break;
+        case LOG_ARG_PTRDIFF:
+            UNPACK(int64_t, i64);
+            dse_strbuf_appendf(out, fmt, (ptrdiff_t)i64);
+            break;
+        case LOG_ARG_DOUBLE:
+            UNPACK(double, d);
+            dse_strbuf_appendf(out, fmt, d);
+            break;
+        case LOG_ARG_LDOUBLE:
+            UNPACK(long double, ld);
+            dse_strbuf_appendf(out, fmt, ld);
+            break;
+        case LOG_ARG_POINTER:
+            UNPACK(uint64_t, u64);
+            dse_strbuf_appendf(out, fmt, (void*)(uintptr_t)u64);
+            break;
+        case LOG_ARG_STRING: {
+            UNPACK(uint64_t, u64);
+            const char* s = NULL;
+            if (u64 != UINT64_MAX) {
+                if (u64 >= (uint64_t)(a_end - a) || a[u64] != '\0') {
+                    return EINVAL;
+                }
+                s = (const char*)a;
+                /* The padding of the last string may be truncated. */
+                size_t s_size = RECORD_ALIGN(u64 + 1);
+                a = s_size < (size_t)(a_end - a) ? a + s_size : a_end;
+            }
+            dse_strbuf_appendf(out, fmt, s);
+        } break;
+        default:
+            return EINVAL;
+        }
+    }
+    dse_strbuf_append(out, f);
+#undef UNPACK
+    return 0;
+}
+
+
+static int _format_record(
+    DseStrBuf* out, const LogRecord* r, const uint8_t* args)
+{
+    int rc = 0;
+    static const char* _level[] = { "[TRACE]  ", "[DEBUG]  ", "[SIMBUS]:",
+        "[INFO]   ", "[NOTICE] ", "[QUIET] ", "[ERROR]  ", "[FATAL]  " };
+    static const char* _colour[] = { LOG_COLOUR_LBLUE, LOG_COLOUR_LBLUE,
+        LOG_COLOUR_GREY, LOG_COLOUR_NONE, LOG_COLOUR_NONE, LOG_COLOUR_NONE,
+        LOG_COLOUR_LRED, LOG_COLOUR_LRED };
+    int level = r->level <= LOG_FATAL ? r->level : LOG_FATAL;
+
+    if (level != LOG_NOTICE) {
+        dse_strbuf_append(out, _colour[level]);
+        dse_strbuf_append(out, _level[level]);
+    }
+    if (level == LOG_SIMBUS) {
+        int64_t sec = r->timestamp / 1000000000;
+        int64_t usec = (r->timestamp % 1000000000) / 1000;
+        dse_strbuf_appendf(out, "[%02" PRId64 ".%06" PRId64 "] ", sec % 100,
+            usec);
+    }
+    if (r->flags & RECORD_TEXT) {
+        dse_strbuf_append_n(out, (const char*)args, r->args_len);
+    } else {
+        rc = _format_args(out, r->format, args, r->args_len);
+    }
+    if (level != LOG_NOTICE && r->file != NULL) {
+        dse_strbuf_appendf(out, " (%s:%0d)", r->file, r->line);
+    }
+    dse_strbuf_append(out, LOG_COLOUR_NONE "\n");
+    return rc;
+}
+
+
+/* Binary trace
+   ============
+
+File header, followed by records (each 8 byte aligned). Site records define
+a call site (level, location and format) before its first event. Arguments
+are in the packed (native) representation. */
+
+#define TRACE_MAGIC      "DSETRACE"
+#define TRACE_VERSION    1
+#define TRACE_BYTE_ORDER 0x0102
+#define TRACE_SITE       1
+#define TRACE_EVENT      2
+#define TRACE_DROPPED    3
+
+typedef struct TraceHeader {
+    char     magic[8];
+    uint32_t version;
+    uint16_t byte_order;
+    uint8_t  sizeof_pointer;
+    uint8_t  sizeof_ldouble;
+} TraceHeader;
+
+typedef struct TraceRecord {
+    uint32_t size; /* Record size, including header. */
+    uint16_t type;
+    uint16_t flags;
+} TraceRecord;
+
+typedef struct TraceSite {
+    TraceRecord record;
+    uint32_t    site;
+    int32_t     line;
+    uint8_t     level;
+    uint8_t     __reserved__[3];
+    uint32_t    file_len; /* Followed by file and format (null-terminated). */
+} TraceSite;
+
+typedef struct TraceEvent {
+    TraceRecord record;
+    uint32_t    site;
+    uint32_t    args_len; /* Followed by the packed arguments. */
+    int64_t     timestamp;
+} TraceEvent;
+
+typedef struct TraceDropped {
+    TraceRecord record;
+    uint64_t    count;
+} TraceDropped;
+
+/* Call sites, open addressing (keyed by format, file and line). */
+typedef struct LogSite {
+    const char* format;
+    const char* file;
+    int32_t     line;
+    uint32_t    id;
+} LogSite;
+
+typedef struct LogSiteTable {
+    LogSite* sites;
+    size_t   size; /* Power of 2. */
+    size_t   count;
+} LogSiteTable;
+
+
+static size_t _site_hash(const char* format, const char* file, int32_t line)
+{
+    uint64_t h = (uintptr_t)format ^ ((uintptr_t)file << 1) ^ (uint64_t)line;
+    h *= 0x9e3779b97f4a7c15ULL;
+    return h >> 32;
+}
+
+
+/* Lookup a call site, added if not found (with *added set true). */
+static LogSite* _site_find(LogSiteTable* t, const LogRecord* r, bool* added)
+{
+    *added = false;
+    if ((t->count + 1) * 2 > t->size) {
+        size_t   size = t->size ? t->size * 2 : 256;
+        LogSite* sites = calloc(size, sizeof(LogSite));
+        if (sites == NULL) return NULL;
+        for (size_t i = 0; i < t->size; i++) {
+            LogSite* s = &t->sites[i];
+            if (s->format == NULL) continue;
+            size_t h = _site_hash(s->format, s->file, s->line);
+            while (sites[h & (size - 1)].format) h++;
+            sites[h & (size - 1)] = *s;
+        }
+        free(t->sites);
+        t->sites = sites;
+        t->size = size;
+    }
+
+    size_t h = _site_hash(r->format, r->file, r->line);
+    for (;; h++) {
+        LogSite* s = &t->sites[h & (t->size - 1)];
+        if (s->format == NULL) {
+            *s = (LogSite){ .format = r->format,
+                .file = r->file,
+                .line = r->line,
+                .id = t->count++ };
+            *added = true;
+            return s;
+        }
+        if (s->format == r->format && s->file == r->file &&
+            s->line == r->line) {
+            return s;
+        }
+    }
+}
+
+
+/* Output
+   ====== */
+
+typedef struct LogOutput {
+    DseLoggerFormat format;
+    FILE*           stream;
+    DseStrBuf       text;
+    DseByteBuf      binary;
+    LogSiteTable    sites;
+} LogOutput;
+
+
+static void _output_init(LogOutput* out, DseLoggerFormat format, FILE* stream)
+{
+    *out = (LogOutput){ .format = format, .stream = stream };
+    dse_strbuf_init(&out->text);
+    dse_bytebuf_init(&out->binary);
+    if (format == DSE_LOGGER_BINARY) {
+        TraceHeader header = { .version = TRACE_VERSION,
+            .byte_order = TRACE_BYTE_ORDER,
+            .sizeof_pointer = sizeof(void*),
+            .sizeof_ldouble = sizeof(long double) };
+        memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+        dse_bytebuf_append(&out->binary, &header, sizeof(header));
+    }
+}
+
+
+static void _output_destroy(LogOutput* out)
+{
+    dse_strbuf_destroy(&out->text);
+    dse_bytebuf_destroy(&out->binary);
+    free(out->sites.sites);
+}
+
+
+static size_t _output_len(LogOutput* out)
+{
+    return out->text.len + out->binary.len;
+}
+
+
+static void _output_write(LogOutput* out)
+{
+    if (out->text.len) {
+        fwrite(dse_strbuf_str(&out->text), 1, out->text.len, out->stream);
+        dse_strbuf_clear(&out->text);
+    }
+    if (out->binary.len) {
+        fwrite(dse_bytebuf_data(&out->binary), 1, out->binary.len,
+            out->stream);
+        dse_bytebuf_clear(&out->binary);
+    }
+}
+
+
+static void _output_record(LogOutput* out, const LogRecord* r)
+{
+    const uint8_t* args = (const uint8_t*)r + sizeof(LogRecord);
+    if (out->format != DSE_LOGGER_BINARY) {
+        _format_record(&out->text, r, args);
+        return;
+    }
+
+    bool     added;
+    LogSite* site = _site_find(&out->sites, r, &added);
+    if (site == NULL) return;
+    if (added) {
+        size_t    file_len = r->file ? strlen(r->file) + 1 : 0;
+        size_t    format_len = strlen(r->format) + 1;
+        size_t    size = sizeof(TraceSite) + file_len + format_len;
+        TraceSite s = { .record = { .size = RECORD_ALIGN(size),
+                            .type = TRACE_SITE },
+            .site = site->id,
+            .line = r->line,
+            .level = r->level,
+            .file_len = file_len };
+        uint64_t  pad = 0;
+        dse_bytebuf_append(&out->binary, &s, sizeof(s));
+        if (file_len) dse_bytebuf_append(&out->binary, r->file, file_len);
+        dse_bytebuf_append(&out->binary, r->format, format_len);
+        dse_bytebuf_append(&out->binary, &pad, RECORD_ALIGN(size) - size);
+    }
+    size_t     size = sizeof(TraceEvent) + r->args_len;
+    TraceEvent e = { .record = { .size = RECORD_ALIGN(size),
+                         .type = TRACE_EVENT,
+                         .flags = r->flags },
+        .site = site->id,
+        .args_len = r->args_len,
+        .timestamp = r->timestamp };
+    uint64_t   pad = 0;
+    dse_bytebuf_append(&out->binary, &e, sizeof(e));
+    dse_bytebuf_append(&out->binary, args, r->args_len);
+    dse_bytebuf_append(&out->binary, &pad, RECORD_ALIGN(size) - size);
+}
+
+
+static void _output_dropped(LogOutput* out, uint64_t count)
+{
+    if (out->format != DSE_LOGGER_BINARY) {
+        dse_strbuf_appendf(&out->text,
+            "Logger: %" PRIu64 " records dropped (ring full)\n", count);
+        return;
+    }
+    TraceDropped d = {
+        .record = { .size = sizeof(TraceDropped), .type = TRACE_DROPPED },
+        .count = count,
+    };
+    dse_bytebuf_append(&out->binary, &d, sizeof(d));
+}
+
+
+/* Rings
+   ===== */
+
+static void _ring_close(void* arg)
+{
+    LogRing* ring = arg;
+    __atomic_store_n(&ring->closed, true, __ATOMIC_RELEASE);
+}
+
+
+static void _key_create(void)
+{
+    pthread_key_create(&__logger.key, _ring_close);
+}
+
+
+static LogRing* _thread_ring(void)
+{
+    if (__ring) return __ring;
+
+    pthread_once(&__logger.once, _key_create);
+    LogRing* ring = calloc(1, sizeof(LogRing));
+    if (ring == NULL) return NULL;
+    ring->size = __logger.config.ring_size;
+    ring->data = malloc(ring->size);
+    if (ring->data == NULL) {
+        free(ring);
+        return NULL;
+    }
+    pthread_setspecific(__logger.key, ring);
+
+    /* Rings are owned by the logger, and retained while the thread lives. */
+    pthread_mutex_lock(&__logger.lock);
+    ring->next = __logger.rings;
+    __logger.rings = ring;
+    pthread_mutex_unlock(&__logger.lock);
+
+    __ring = ring;
+    return ring;
+}
+
+
+static void _wait_ns(long ns)
+{
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = ns };
+    nanosleep(&ts, NULL);
+}
+
+
+/* Reserve space for a record in the ring, returns NULL if the ring is full.
+The record is published with _ring_commit(). */
+static uint8_t* _ring_reserve(LogRing* ring, size_t len, size_t* reserved)
+{
+    uint64_t head = ring->head;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    size_t   pos = head & (ring->size - 1);
+    size_t   need = len;
+    if (ring->size - pos < len) need += ring->size - pos;
+    if (ring->size - (head - tail) < need) return NULL;
+
+    if (need != len) {
+        /* Mark the end of the ring, the record is placed at the start. */
+        memset(ring->data + pos, 0, sizeof(uint32_t));
+        pos = 0;
+    }
+    *reserved = need;
+    return ring->data + pos;
+}
+
+
+static void _ring_commit(LogRing* ring, size_t reserved)
+{
+    uint64_t head = ring->head + reserved;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+
+    /* Wake the logger thread when the ring passes half full. */
+    size_t half = ring->size / 2;
+    if (head - tail > half && (head - reserved) - tail <= half) {
+        pthread_cond_signal(&__logger.wake_cond);
+    }
+}
+
+
+static size_t _ring_drain(LogRing* ring, LogOutput* out)
+{
+    size_t   count = 0;
+    uint64_t tail = ring->tail;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    while (tail < head) {
+        size_t           pos = tail & (ring->size - 1);
+        const LogRecord* r = (const LogRecord*)(ring->data + pos);
+        if (r->size == 0) {
+            tail += ring->size - pos;
+            continue;
+        }
+        _output_record(out, r);
+        tail += r->size;
+        count++;
+        if (_output_len(out) >= BATCH_SIZE) {
+            _output_write(out);
+            __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+        }
+    }
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+
+    /* Report dropped records. */
+    uint64_t dropped = __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+    if (dropped != ring->dropped_reported) {
+        _output_dropped(out, dropped - ring->dropped_reported);
+        ring->dropped_reported = dropped;
+    }
+    return count;
+}
+
+
+/* Logger thread
+   ============= */
+
+static void* _logger_thread(void* arg)
+{
+    UNUSED(arg);
+    LogOutput out;
+    _output_init(&out, __logger.config.format, __logger.config.stream);
+
+    pthread_mutex_lock(&__logger.lock);
+    while (1) {
+        uint64_t request = __logger.flush_request;
+        bool     stop = __logger.stop;
+        LogRing* rings = __logger.rings;
+        pthread_mutex_unlock(&__logger.lock);
+
+        /* Rings are only added at the head of the list, and only removed by
+        this thread, the list can be walked without the lock. */
+        size_t count = 0;
+        for (LogRing* ring = rings; ring; ring = ring->next) {
+            count += _ring_drain(ring, &out);
+        }
+        _output_write(&out);
+        fflush(__logger.config.stream);
+        __atomic_fetch_add(&__logger.records, count, __ATOMIC_RELAXED);
+
+        pthread_mutex_lock(&__logger.lock);
+        /* Release the rings of exited threads (once drained). */
+        for (LogRing** p = &__logger.rings; *p;) {
+            LogRing* ring = *p;
+            if (__atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE) &&
+                ring->tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+                *p = ring->next;
+                free(ring->data);
+                free(ring);
+            } else {
+                p = &ring->next;
+            }
+        }
+        __logger.flush_done = request;
+        pthread_cond_broadcast(&__logger.flush_cond);
+        if (stop) break;
+        if (count == 0 && request == __logger.flush_request &&
+            !__logger.stop) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += IDLE_WAIT_NS;
+            if (ts.tv_nsec >= 1000000000) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait(&__logger.wake_cond, &__logger.lock, &ts);
+        }
+    }
+    pthread_mutex_unlock(&__logger.lock);
+
+    _output_destroy(&out);
+    return NULL;
+}
+
+
+/* Backend hook, see dse/logger.h. */
+DLL_PUBLIC int __log_backend__(int level, const char* file, int line,
+    const char* format, va_list args)
+{
+    if (!__atomic_load_n(&__logger.running, __ATOMIC_ACQUIRE)) return -1;
+    /* Errors are written synchronously, after pending records (and are also
+    recorded in a binary trace). */
+    bool sync = level >= LOG_ERROR;
+    if (sync && __logger.config.format != DSE_LOGGER_BINARY) {
+        dse_logger_flush();
+        return -1;
+    }
+    LogRing* ring = _thread_ring();
+    if (ring == NULL) return -1;
+
+    /* Pack the record. */
+    struct {
+        LogRecord header;
+        uint8_t   args[RECORD_ARGS_MAX];
+    } record;
+    va_list _args;
+    va_copy(_args, args);
+    int args_len =
+        _pack_args(record.args, sizeof(record.args), format, &_args);
+    va_end(_args);
+    record.header.flags = 0;
+    if (args_len < 0) {
+        /* Format on the calling thread. Messages which do not fit in a record
+        are written synchronously (rather than truncated). */
+        args_len = vsnprintf(
+            (char*)record.args, sizeof(record.args), format, args);
+        if (args_len < 0) return -1;
+        if ((size_t)args_len >= sizeof(record.args)) {
+            dse_logger_flush();
+            return -1;
+        }
+        record.header.flags = RECORD_TEXT;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    size_t size = RECORD_ALIGN(sizeof(LogRecord) + args_len);
+    record.header.size = size;
+    record.header.level = level;
+    record.header.__reserved__ = 0;
+    record.header.line = line;
+    record.header.args_len = args_len;
+    record.header.timestamp = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    record.header.file = file;
+    record.header.format = format;
+
+    /* Write the record to the ring. */
+    size_t   reserved;
+    uint8_t* p;
+    while ((p = _ring_reserve(ring, size, &reserved)) == NULL) {
+        if (__logger.config.policy == DSE_LOGGER_DROP) {
+            __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+            return sync ? -1 : 0;
+        }
+        __atomic_fetch_add(&ring->blocked, 1, __ATOMIC_RELAXED);
+        pthread_cond_signal(&__logger.wake_cond);
+        _wait_ns(BLOCK_WAIT_NS);
+        if (!__atomic_load_n(&__logger.running, __ATOMIC_ACQUIRE)) return -1;
+    }
+    memcpy(p, &record, sizeof(LogRecord) + args_len);
+    _ring_commit(ring, reserved);
+    if (sync) {
+        dse_logger_flush();
+        return -1;
+    }
+    return 0;
+}
+
+
+/**
+dse_logger_start
+================
+
+Start the asynchronous logger. Log messages are then written by the logger
+thread until `dse_logger_stop()` is called (which is also called at exit).
+
+Parameters
+----------
+config (const DseLoggerConfig*)
+: Logger configuration (may be NULL for the defaults). The ring size is
+  rounded up to a power of 2.
+
+Returns
+-------
+0
+: The logger was started.
+
+EALREADY
+: The logger is already running.
+
+ENOSYS
+: The logger backend is not supported on this platform.
+
+other
+: The logger thread could not be created (an errno value).
+*/
+DLL_PUBLIC int dse_logger_start(const DseLoggerConfig* config)
+{
+#ifndef LOG_BACKEND
+    UNUSED(config);
+    return ENOSYS;
+#else
+    static bool _atexit = false;
+
+    pthread_mutex_lock(&__logger.lock);
+    if (__atomic_load_n(&__logger.running, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_unlock(&__logger.lock);
+        return EALREADY;
+    }
+    __logger.config = config ? *config : (DseLoggerConfig){ 0 };
+    size_t ring_size = RING_SIZE_MIN;
+    while (ring_size < __logger.config.ring_size) ring_size *= 2;
+    if (__logger.config.ring_size == 0) ring_size = RING_SIZE_DEFAULT;
+    __logger.config.ring_size = ring_size;
+    if (__logger.config.stream == NULL) __logger.config.stream = stdout;
+    __logger.stop = false;
+    __logger.flush_request = __logger.flush_done = 0;
+    __atomic_store_n(&__logger.records, 0, __ATOMIC_RELAXED);
+    for (LogRing* ring = __logger.rings; ring; ring = ring->next) {
+        __atomic_store_n(&ring->dropped, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&ring->blocked, 0, __ATOMIC_RELAXED);
+        ring->dropped_reported = 0;
+    }
+    int rc = pthread_create(&__logger.thread, NULL, _logger_thread, NULL);
+    if (rc == 0) __atomic_store_n(&__logger.running, true, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&__logger.lock);
+
+    if (rc == 0 && !_atexit) {
+        atexit(dse_logger_stop);
+        _atexit = true;
+    }
+    return rc;
+#endif
+}
+
+
+/**
+dse_logger_flush
+================
+
+Wait until the log records, written before this call, have been written to
+the output stream (and the stream flushed).
+*/
+DLL_PUBLIC void dse_logger_flush(void)
+{
+    pthread_mutex_lock(&__logger.lock);
+    if (__atomic_load_n(&__logger.running, __ATOMIC_ACQUIRE)) {
+        uint64_t request = ++__logger.flush_request;
+        pthread_cond_signal(&__logger.wake_cond);
+        while (__logger.flush_done < request) {
+            pthread_cond_wait(&__logger.flush_cond, &__logger.lock);
+        }
+    }
+    pthread_mutex_unlock(&__logger.lock);
+}
+
+
+/**
+dse_logger_stop
+===============
+
+Stop the asynchronous logger, pending log records are written before the
+logger thread exits. Threads should not be logging while the logger is
+stopped; log messages are afterwards printed to the console.
+*/
+DLL_PUBLIC void dse_logger_stop(void)
+{
+    pthread_mutex_lock(&__logger.lock);
+    if (!__atomic_load_n(&__logger.running, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_unlock(&__logger.lock);
+        return;
+    }
+    __atomic_store_n(&__logger.running, false, __ATOMIC_RELEASE);
+    __logger.stop = true;
+    pthread_cond_signal(&__logger.wake_cond);
+    pthread_mutex_unlock(&__logger.lock);
+    pthread_join(__logger.thread, NULL);
+}
+
+
+/**
+dse_logger_stats
+================
+
+Returns
+-------
+DseLoggerStats
+: Statistics of the asynchronous logger (since it was last started).
+*/
+DLL_PUBLIC DseLoggerStats dse_logger_stats(void)
+{
+    DseLoggerStats stats = {
+        .records = __atomic_load_n(&__logger.records, __ATOMIC_RELAXED),
+    };
+    pthread_mutex_lock(&__logger.lock);
+    for (LogRing* ring = __logger.rings; ring; ring = ring->next) {
+        stats.dropped += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+        stats.blocked += __atomic_load_n(&ring->blocked, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&__logger.lock);
+    return stats;
+}
+
+
+/* Decoder
+   ======= */
+
+typedef struct TraceDecodeSite {
+    uint8_t     level;
+    int32_t     line;
+    const char* file;
+    const char* format;
+    char*       strings; /* File and format (one allocation). */
+} TraceDecodeSite;
+
+
+/* The header is decoded after its first record sized part (the magic) has
+been read (as a record). */
+static int _decode_header(FILE* in, const TraceRecord* magic)
+{
+    TraceHeader header;
+    memcpy(&header, magic, sizeof(TraceRecord));
+    if (fread((uint8_t*)&header + sizeof(TraceRecord),
+            sizeof(header) - sizeof(TraceRecord), 1, in) != 1) {
+        return EINVAL;
+    }
+    if (memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TRACE_VERSION ||
+        header.byte_order != TRACE_BYTE_ORDER ||
+        header.sizeof_pointer != sizeof(void*) ||
+        header.sizeof_ldouble != sizeof(long double)) {
+        return EINVAL;
+    }
+    return 0;
+}
+
+
+static int _decode_site(
+    TraceDecodeSite** sites, size_t* count, const TraceSite* s)
+{
+    size_t len = s->record.size - sizeof(TraceSite);
+    if (s->site > *count || s->file_len >= len) return EINVAL;
+    if (s->site == *count) {
+        TraceDecodeSite* _sites =
+            realloc(*sites, (*count + 1) * sizeof(TraceDecodeSite));
+        if (_sites == NULL) return ENOMEM;
+        *sites = _sites;
+        (*count)++;
+    } else {
+        free((*sites)[s->site].strings);
+    }
+
+    char* strings = calloc(1, len + 1);
+    if (strings == NULL) return ENOMEM;
+    memcpy(strings, (const char*)(s + 1), len);
+    (*sites)[s->site] = (TraceDecodeSite){
+        .level = s->level,
+        .line = s->line,
+        .file = s->file_len ? strings : NULL,
+        .format = strings + s->file_len,
+        .strings = strings,
+    };
+    return 0;
+}
+
+
+/**
+dse_logger_decode
+=================
+
+Decode a binary trace (written by the logger with the `DSE_LOGGER_BINARY`
+format) to text, as the logger would have written it. A trace may contain
+several sessions (i.e. the logger was restarted with the same stream).
+
+Traces are decoded on the platform which wrote them (the trace header is
+checked for compatibility).
+
+Parameters
+----------
+in (FILE*)
+: Stream containing the binary trace.
+
+out (FILE*)
+: Stream to write the decoded text to.
+
+timestamp (bool)
+: Prefix each line with the (realtime) timestamp of the log call.
+
+Returns
+-------
+0
+: The trace was decoded.
+
+EINVAL
+: The trace is not valid (including the arguments of an event), or was
+  written by an incompatible platform. Records before the invalid record are
+  decoded.
+
+ENOMEM
+: Memory allocation failed.
+*/
+DLL_PUBLIC int dse_logger_decode(FILE* in, FILE* out, bool timestamp)
+{
+    if (in == NULL || out == NULL) return EINVAL;
+
+    int              rc = 0;
+    TraceRecord      r;
+    TraceDecodeSite* sites = NULL;
+    size_t           count = 0;
+    DseStrBuf        text;
+    DseByteBuf       buf;
+    dse_strbuf_init(&text);
+    dse_bytebuf_init(&buf);
+
+    if (fread(&r, sizeof(r), 1, in) != 1) return EINVAL;
+    rc = _decode_header(in, &r);
+    while (rc == 0) {
+        if (fread(&r, sizeof(r), 1, in) != 1) break;
+        if (memcmp(&r, TRACE_MAGIC, sizeof(r)) == 0) {
+            /* Next session, with new site definitions. */
+            for (size_t i = 0; i < count; i++) free(sites[i].strings);
+            count = 0;
+            rc = _decode_header(in, &r);
+            continue;
+        }
+        if (r.size < sizeof(r) || r.size % 8 ||
+            (rc = dse_bytebuf_reserve(&buf, r.size)) != 0) {
+            rc = rc ? rc : EINVAL;
+            break;
+        }
+        uint8_t* data = dse_bytebuf_data(&buf);
+        memcpy(data, &r, sizeof(r));
+        if (fread(data + sizeof(r), r.size - sizeof(r), 1, in) != 1 &&
+            r.size > sizeof(r)) {
+            rc = EINVAL;
+            break;
+        }
+
+        switch (r.type) {
+        case TRACE_SITE:
+            if (r.size < sizeof(TraceSite)) {
+                rc = EINVAL;
+                break;
+            }
+            rc = _decode_site(&sites, &count, (const TraceSite*)data);
+            break;
+        case TRACE_EVENT: {
+            const TraceEvent* e = (const TraceEvent*)data;
+            if (r.size < sizeof(TraceEvent) || e->site >= count ||
+                e->args_len > r.size - sizeof(TraceEvent)) {
+                rc = EINVAL;
+                break;
+            }
+            const TraceDecodeSite* site = &sites[e->site];
+            LogRecord lr = { .level = site->level,
+                .flags = r.flags,
+                .line = site->line,
+                .args_len = e->args_len,
+                .timestamp = e->timestamp,
+                .file = site->file,
+                .format = site->format };
+            if (timestamp) {
+                dse_strbuf_appendf(&text, "[%" PRId64 ".%09" PRId64 "] ",
+                    e->timestamp / 1000000000, e->timestamp % 1000000000);
+            }
+            rc = _format_record(&text, &lr, (const uint8_t*)(e + 1));
+        } break;
+        case TRACE_DROPPED:
+            if (r.size < sizeof(TraceDropped)) {
+                rc = EINVAL;
+                break;
+            }
+            dse_strbuf_appendf(&text,
+                "Logger: %" PRIu64 " records dropped (ring full)\n",
+                ((const TraceDropped*)data)->count);
+            break;
+        default:
+            /* Unknown record types are skipped. */
+            break;
+        }
+        if (text.len >= BATCH_SIZE) {
+            fwrite(dse_strbuf_str(&text), 1, text.len, out);
+            dse_strbuf_clear(&text);
+        }
+    }
+    if (text.len) fwrite(dse_strbuf_str(&text), 1, text.len, out);
+    fflush(out);
+
+    for (size_t i = 0; i < count; i++) free(sites[i].strings);
+    free(sites);
+    dse_strbuf_destroy(&text);
+    dse_bytebuf_destroy(&buf);
+    return rc;
+}
+
+
+/* Module log levels
+   ================= */
+
+typedef struct LogModule {
+    const char*       name;
+    uint8_t*          level; /* NULL for a level set before registration. */
+    uint8_t           set_level;
+    struct LogModule* next;
+} LogModule;
+
+static struct {
+    pthread_mutex_t lock;
+    LogModule*      modules;
+} __modules = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+
+/* Registration hooks, see dse/logger.h (LOG_MODULE). */
+DLL_PUBLIC void __log_module_register__(const char* module, uint8_t* level)
+{
+    LogModule* m = calloc(1, sizeof(LogModule));
+    if (m == NULL) return;
+    m->name = module;
+    m->level = level;
+
+    pthread_mutex_lock(&__modules.lock);
+    for (LogModule* p = __modules.modules; p; p = p->next) {
+        if (p->level == NULL && strcmp(p->name, module) == 0) {
+            *level = p->set_level;
+        }
+    }
+    m->next = __modules.modules;
+    __modules.modules = m;
+    pthread_mutex_unlock(&__modules.lock);
+}
+
+
+DLL_PUBLIC void __log_module_unregister__(uint8_t* level)
+{
+    pthread_mutex_lock(&__modules.lock);
+    for (LogModule** p = &__modules.modules; *p; p = &(*p)->next) {
+        if ((*p)->level == level) {
+            LogModule* m = *p;
+            *p = m->next;
+            free(m);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&__modules.lock);
+}
+
+
+/**
+dse_logger_set_module_level
+===========================
+
+Set the log level of a module (i.e. source files compiled with `LOG_MODULE`
+defined as the module name). The level also applies to module source files
+which are loaded later.
+
+Parameters
+----------
+module (const char*)
+: Module name.
+
+level (uint8_t)
+: Log level of the module (`LoggerLevel`), or `LOG_LEVEL_INHERIT` to use the
+  global log level (`__log_level__`).
+
+Returns
+-------
+0
+: The module log level was set.
+
+EINVAL
+: Bad arguments.
+
+ENOMEM
+: Memory allocation failed.
+*/
+DLL_PUBLIC int dse_logger_set_module_level(const char* module, uint8_t level)
+{
+    if (module == NULL) return EINVAL;
+    if (level > LOG_FATAL && level != LOG_LEVEL_INHERIT) return EINVAL;
+
+    int        rc = 0;
+    LogModule* set = NULL;
+    pthread_mutex_lock(&__modules.lock);
+    for (LogModule* p = __modules.modules; p; p = p->next) {
+        if (strcmp(p->name, module) != 0) continue;
+        if (p->level) {
+            __atomic_store_n(p->level, level, __ATOMIC_RELAXED);
+        } else {
+            set = p;
+        }
+    }
+    if (set == NULL) {
+        /* Retain the level for modules registered later. */
+        size_t len = strlen(module) + 1;
+        set = calloc(1, sizeof(LogModule) + len);
+        if (set) {
+            set->name = memcpy((char*)(set + 1), module, len);
+            set->next = __modules.modules;
+            __modules.modules = set;
+        } else {
+            rc = ENOMEM;
+        }
+    }
+    if (set) set->set_level = level;
+    pthread_mutex_unlock(&__modules.lock);
+    return rc;
+}
@@ -0,0 +1,104 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_CLIB_UTIL_LOGGER_H_
+#define DSE_CLIB_UTIL_LOGGER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <dse/platform.h>
+
+
+/**
+Asynchronous Logger
+===================
+
+A backend for the logger (`dse/logger.h`) which moves formatting and output
+off the calling thread. When started, each log message is written as a compact
+record (the format string pointer and the raw arguments) to a lock-free ring
+owned by the calling thread. A background thread formats the records and
+writes them, in batches, to the configured stream.
+
+When a ring is full the record is either dropped (and counted) or the calling
+thread waits for space, according to the configured policy. Records from one
+thread are written in order; records from different threads may interleave
+differently than with synchronous logging. Messages at `LOG_ERROR` and above
+are written synchronously (after pending records are flushed).
+
+Format strings are referenced (not copied) and must therefore remain valid
+while the logger is running (i.e. string literals). String arguments are
+copied. Formats which can not be represented as a record (e.g. `%n` or
+positional arguments) are formatted on the calling thread. Messages larger
+than a record (1 KiB of arguments or formatted text) are written
+synchronously, after pending records are flushed.
+
+The backend is connected to `dse/logger.h` with a weak symbol, and is only
+available on platforms which support weak symbols.
+
+
+Binary Trace
+------------
+
+With the `DSE_LOGGER_BINARY` format the logger thread writes the records
+without formatting: a call site (level, location and format string) is
+written once, each log call is then written as its timestamp, call site id
+and the packed arguments. The trace is decoded offline with
+`dse_logger_decode()` (or the `logdecode` tool, see the examples), on the
+same platform. Errors are recorded in the trace and also printed to the
+console.
+
+
+Module Log Levels
+-----------------
+
+Source files compiled with `LOG_MODULE` defined (before including
+`dse/logger.h`) belong to that module, and use the module log level when it
+is set with `dse_logger_set_module_level()`, otherwise the global log level.
+This makes it possible to trace one module while the others remain quiet.
+Log calls below `LOG_LEVEL_MIN` are removed at compile time, regardless of
+the runtime log level.
+
+```c
+#define LOG_MODULE "marshal"
+#include <dse/logger.h>
+```
+*/
+typedef enum DseLoggerPolicy {
+    DSE_LOGGER_DROP = 0, /* Drop records when the ring is full. */
+    DSE_LOGGER_BLOCK,    /* Wait for space in the ring. */
+} DseLoggerPolicy;
+
+typedef enum DseLoggerFormat {
+    DSE_LOGGER_TEXT = 0, /* Formatted text (as the console logger). */
+    DSE_LOGGER_BINARY,   /* Binary trace, see dse_logger_decode(). */
+} DseLoggerFormat;
+
+typedef struct DseLoggerConfig {
+    size_t          ring_size; /* Bytes per thread ring (default 64 KiB). */
+    DseLoggerPolicy policy;
+    FILE*           stream; /* Output stream (default stdout). */
+    DseLoggerFormat format;
+} DseLoggerConfig;
+
+typedef struct DseLoggerStats {
+    uint64_t records; /* Records written. */
+    uint64_t dropped; /* Records dropped (ring full). */
+    uint64_t blocked; /* Times a thread waited for space in its ring. */
+} DseLoggerStats;
+
+
+/* logger.c */
+DLL_PUBLIC int            dse_logger_start(const DseLoggerConfig* config);
+DLL_PUBLIC void           dse_logger_flush(void);
+DLL_PUBLIC void           dse_logger_stop(void);
+DLL_PUBLIC DseLoggerStats dse_logger_stats(void);
+DLL_PUBLIC int            dse_logger_set_module_level(
+               const char* module, uint8_t level);
+DLL_PUBLIC int            dse_logger_decode(
+               FILE* in, FILE* out, bool timestamp);
+
+
+#endif  // DSE_CLIB_UTIL_LOGGER_H_
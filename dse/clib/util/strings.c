@@ -2,15 +2,283 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <stdarg.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 #include <dse/testing.h>
 #include <dse/clib/util/strings.h>
 
 
-#define EXPAND_VAR_MAXLEN 1023
+#define EXPAND_NAME_STATIC 128
+
+
+#ifndef _WIN32
+extern char** environ;
+#endif
+
+
+struct DseEnvSnapshot {
+    size_t count;
+    char** entry; /* "NAME=VALUE", sorted by NAME (first occurrence kept). */
+    char*  data;  /* Single allocation holding all entries. */
+};
+
+
+/**
+ *  dse_strbuf_init
+ *
+ *  Initialise a string buffer (an empty string, held inline). A zero
+ *  initialised DseStrBuf object is also a valid (empty) string buffer.
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseStrBuf*
+ *      The string buffer.
+ */
+void dse_strbuf_init(DseStrBuf* b)
+{
+    if (b == NULL) return;
+    memset(b, 0, sizeof(DseStrBuf));
+}
+
+
+/**
+ *  dse_strbuf_reserve
+ *
+ *  Ensure that the string buffer can hold a string of the given length
+ *  without further allocation. Storage grows geometrically.
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseStrBuf*
+ *      The string buffer.
+ *  len : size_t
+ *      Length of string (excluding the NULL terminator).
+ *
+ *  Returns
+ *  -------
+ *      0 : The storage is available.
+ *      ENOMEM : The storage could not be allocated.
+ */
+int dse_strbuf_reserve(DseStrBuf* b, size_t len)
+{
+    if (b == NULL) return EINVAL;
+    size_t required = len + 1;
+    if (b->heap == NULL && required <= DSE_BUF_INLINE_SIZE) return 0;
+    if (b->heap && required <= b->size) return 0;
+
+    size_t size = dse_buffer_grow(
+        b->size ? b->size : DSE_BUF_INLINE_SIZE, required);
+    char*  heap = realloc(b->heap, size);
+    if (heap == NULL) return ENOMEM;
+    if (b->heap == NULL) memcpy(heap, b->inline_data, b->len + 1);
+    b->heap = heap;
+    b->size = size;
+    return 0;
+}
+
+
+/**
+ *  dse_strbuf_append_n
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseStrBuf*
+ *      The string buffer.
+ *  s : const char*
+ *      String to append.
+ *  n : size_t
+ *      Number of characters, of s, to append.
+ *
+ *  Returns
+ *  -------
+ *      0 : The string was appended.
+ *      ENOMEM : The storage could not be allocated.
+ */
+int dse_strbuf_append_n(DseStrBuf* b, const char* s, size_t n)
+{
+    if (b == NULL || (s == NULL && n)) return EINVAL;
+    int rc = dse_strbuf_reserve(b, b->len + n);
+    if (rc) return rc;
+    char* str = b->heap ? b->heap : b->inline_data;
+    memcpy(str + b->len, s, n);
+    b->len += n;
+    str[b->len] = '\0';
+    return 0;
+}
+
+
+/**
+ *  dse_strbuf_append
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseStrBuf*
+ *      The string buffer.
+ *  s : const char*
+ *      String to append.
+ *
+ *  Returns
+ *  -------
+ *      0 : The string was appended.
+ *      ENOMEM : The storage could not be allocated.
+ */
+int dse_strbuf_append(DseStrBuf* b, const char* s)
+{
+    if (s == NULL) return EINVAL;
+    return dse_strbuf_append_n(b, s, strlen(s));
+}
+
+
+/**
+ *  dse_strbuf_appendf
+ *
+ *  Append a formatted string (as with `printf()`).
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseStrBuf*
+ *      The string buffer.
+ *  format : const char*
+ *      Format string, followed by its arguments.
+ *
+ *  Returns
+ *  -------
+ *      0 : The string was appended.
+ *      +ve : Failed, with the indicated errno.
+ */
+int dse_strbuf_appendf(DseStrBuf* b, const char* format, ...)
+{
+    if (b == NULL || format == NULL) return EINVAL;
+
+    va_list args;
+    va_start(args, format);
+    char*  str = b->heap ? b->heap : b->inline_data;
+    size_t avail = (b->heap ? b->size : DSE_BUF_INLINE_SIZE) - b->len;
+    int    n = vsnprintf(str + b->len, avail, format, args);
+    va_end(args);
+    if (n < 0) {
+        str[b->len] = '\0';
+        return EINVAL;
+    }
+    if ((size_t)n >= avail) {
+        /* Too long, reserve the necessary storage and format again. */
+        int rc = dse_strbuf_reserve(b, b->len + n);
+        str = b->heap ? b->heap : b->inline_data;
+        str[b->len] = '\0';
+        if (rc) return rc;
+        va_start(args, format);
+        vsnprintf(str + b->len, n + 1, format, args);
+        va_end(args);
+    }
+    b->len += n;
+    return 0;
+}
+
+
+/**
+ *  dse_strbuf_clear
+ *
+ *  Set the string buffer to an empty string (storage is retained).
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseStrBuf*
+ *      The string buffer.
+ */
+void dse_strbuf_clear(DseStrBuf* b)
+{
+    if (b == NULL) return;
+    b->len = 0;
+    (b->heap ? b->heap : b->inline_data)[0] = '\0';
+}
+
+
+/**
+ *  dse_strbuf_shrink
+ *
+ *  Release unused storage of the string buffer (the string is moved inline
+ *  when it fits).
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseStrBuf*
+ *      The string buffer.
+ *
+ *  Returns
+ *  -------
+ *      0 : The storage was shrunk (or not necessary).
+ *      ENOMEM : The storage could not be reallocated.
+ */
+int dse_strbuf_shrink(DseStrBuf* b)
+{
+    if (b == NULL) return EINVAL;
+    if (b->heap == NULL) return 0;
+    if (b->len + 1 <= DSE_BUF_INLINE_SIZE) {
+        memcpy(b->inline_data, b->heap, b->len + 1);
+        free(b->heap);
+        b->heap = NULL;
+        b->size = 0;
+        return 0;
+    }
+    char* heap = realloc(b->heap, b->len + 1);
+    if (heap == NULL) return ENOMEM;
+    b->heap = heap;
+    b->size = b->len + 1;
+    return 0;
+}
+
+
+/**
+ *  dse_strbuf_release
+ *
+ *  Release the string from the string buffer, the string buffer is then
+ *  reset to an empty string.
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseStrBuf*
+ *      The string buffer.
+ *
+ *  Returns
+ *  -------
+ *      char* : The string. Caller to free.
+ *      NULL : The string could not be allocated.
+ */
+char* dse_strbuf_release(DseStrBuf* b)
+{
+    if (b == NULL) return NULL;
+    char* str = b->heap;
+    if (str == NULL) {
+        str = malloc(b->len + 1);
+        if (str == NULL) return NULL;
+        memcpy(str, b->inline_data, b->len + 1);
+    }
+    dse_strbuf_init(b);
+    return str;
+}
+
+
+/**
+ *  dse_strbuf_destroy
+ *
+ *  Release the storage of the string buffer, the string buffer is then
+ *  reset to an empty string.
+ *
+ *  Parameters
+ *  ----------
+ *  b : DseStrBuf*
+ *      The string buffer.
+ */
+void dse_strbuf_destroy(DseStrBuf* b)
+{
+    if (b == NULL) return;
+    free(b->heap);
+    dse_strbuf_init(b);
+}
 
 
 char* dse_path_cat(const char* a, const char* b)
@@ -18,81 +286,289 @@ char* dse_path_cat(const char* a, const char* b)
     if (a == NULL && b == NULL) return NULL;
 
     /* Caller will free. */
-    int len = 2;  // '/' + NULL.
-    len += (a) ? strlen(a) : 0;
-    len += (b) ? strlen(b) : 0;
-    char* path = calloc(len, sizeof(char));
-
-    if (a && b) {
-        snprintf(path, len, "%s/%s", a, b);
-    } else {
-        strncpy(path, a ? a : b, len - 1);
+    DseStrBuf path = { 0 };
+    size_t    len = (a ? strlen(a) : 0) + (b ? strlen(b) : 0) + 1;
+    int       rc = dse_strbuf_reserve(&path, len);
+    if (rc == 0 && a) rc = dse_strbuf_append(&path, a);
+    if (rc == 0 && a && b) rc = dse_strbuf_append_n(&path, "/", 1);
+    if (rc == 0 && b) rc = dse_strbuf_append(&path, b);
+    if (rc) {
+        dse_strbuf_destroy(&path);
+        errno = rc;
+        return NULL;
+    }
+
+    char* result = dse_strbuf_release(&path);
+    if (result == NULL) errno = ENOMEM;
+    return result;
+}
+
+
+static size_t _env_name_len(const char* entry)
+{
+    const char* eq = strchr(entry, '=');
+    return eq ? (size_t)(eq - entry) : strlen(entry);
+}
+
+
+static int _env_name_cmp(
+    const char* name, size_t len, const char* entry, size_t entry_len)
+{
+    int rc = memcmp(name, entry, len < entry_len ? len : entry_len);
+    if (rc) return rc;
+    return (len > entry_len) - (len < entry_len);
+}
+
+
+static int _env_entry_compar(const void* a, const void* b)
+{
+    const char* l = *(const char**)a;
+    const char* r = *(const char**)b;
+    int rc = _env_name_cmp(l, _env_name_len(l), r, _env_name_len(r));
+    if (rc) return rc;
+    /* Entries are copied in environment order, keep the first. */
+    return (l > r) - (l < r);
+}
+
+
+static const char* _env_lookup(
+    DseEnvSnapshot* env, const char* name, size_t len)
+{
+    size_t lo = 0;
+    size_t hi = env->count;
+    while (lo < hi) {
+        size_t      mid = lo + (hi - lo) / 2;
+        const char* entry = env->entry[mid];
+        size_t      entry_len = _env_name_len(entry);
+        int         rc = _env_name_cmp(name, len, entry, entry_len);
+        if (rc == 0) return entry[entry_len] ? entry + entry_len + 1 : "";
+        if (rc < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
     }
+    return NULL;
+}
+
+
+static const char* _getenv(DseEnvSnapshot* env, const char* name, size_t len)
+{
+    if (env) return _env_lookup(env, name, len);
 
-    return path;
+    /* The name is not NULL terminated in the source string. */
+    char  buf[EXPAND_NAME_STATIC];
+    char* _name = (len < sizeof(buf)) ? buf : malloc(len + 1);
+    if (_name == NULL) return NULL;
+    memcpy(_name, name, len);
+    _name[len] = '\0';
+    const char* value = getenv(_name);
+    if (_name != buf) free(_name);
+    return value;
 }
 
 
 /**
- *  dse_expand_vars
+ *  dse_env_snapshot_create
+ *
+ *  Create a snapshot of the process environment. Lookups in the snapshot
+ *  are a binary search (rather than the linear scan of `getenv()`) and are
+ *  not affected by later changes to the environment.
+ *
+ *  Returns
+ *  -------
+ *      DseEnvSnapshot* : Environment snapshot. Release with
+ *          `dse_env_snapshot_destroy()`.
+ *      NULL : The snapshot could not be created, inspect `errno`.
+ */
+DseEnvSnapshot* dse_env_snapshot_create(void)
+{
+    size_t count = 0;
+    size_t size = 0;
+    for (char** e = environ; e && *e; e++) {
+        count++;
+        size += strlen(*e) + 1;
+    }
+
+    DseEnvSnapshot* env = calloc(1, sizeof(DseEnvSnapshot));
+    if (env == NULL) return NULL;
+    env->entry = calloc(count + 1, sizeof(char*));
+    env->data = malloc(size + 1);
+    if (env->entry == NULL || env->data == NULL) {
+        dse_env_snapshot_destroy(env);
+        errno = ENOMEM;
+        return NULL;
+    }
+    char* p = env->data;
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(environ[i]) + 1;
+        memcpy(p, environ[i], len);
+        env->entry[i] = p;
+        p += len;
+    }
+    qsort(env->entry, count, sizeof(char*), _env_entry_compar);
+
+    /* Remove duplicate names (getenv() returns the first). */
+    for (size_t i = 0; i < count; i++) {
+        const char* entry = env->entry[i];
+        size_t      len = _env_name_len(entry);
+        if (env->count) {
+            const char* prev = env->entry[env->count - 1];
+            if (_env_name_cmp(entry, len, prev, _env_name_len(prev)) == 0) {
+                continue;
+            }
+        }
+        env->entry[env->count++] = env->entry[i];
+    }
+
+    return env;
+}
+
+
+/**
+ *  dse_env_snapshot_destroy
+ *
+ *  Parameters
+ *  ----------
+ *  env : DseEnvSnapshot*
+ *      The environment snapshot to release.
+ */
+void dse_env_snapshot_destroy(DseEnvSnapshot* env)
+{
+    if (env == NULL) return;
+    free(env->entry);
+    free(env->data);
+    free(env);
+}
+
+
+/**
+ *  dse_env_snapshot_get
+ *
+ *  Parameters
+ *  ----------
+ *  env : DseEnvSnapshot*
+ *      An environment snapshot.
+ *  name : const char*
+ *      Name of the environment variable.
+ *
+ *  Returns
+ *  -------
+ *      const char* : Value of the environment variable (owned by the
+ *          snapshot), or NULL if the variable was not set.
+ */
+const char* dse_env_snapshot_get(DseEnvSnapshot* env, const char* name)
+{
+    if (env == NULL || name == NULL) return NULL;
+    return _env_lookup(env, name, strlen(name));
+}
+
+
+/**
+ *  dse_expand_vars_env
  *
  *  Expand environment variables in a string according to typical shell
- *  variable expansion (i.e ${FOO} or ${BAR:-default}).
+ *  variable expansion (i.e ${FOO} or ${BAR:-default}). The source string is
+ *  scanned once and the result is written to a growable buffer (there is no
+ *  limit on the length of the result).
+ *
+ *  A variable which is not set, and has no default, expands to its name. An
+ *  unterminated variable (i.e. "${FOO") is copied verbatim.
  *
  *  Parameters
  *  ----------
  *  source : const char*
  *      The string containing environment variables to expand.
+ *  env : DseEnvSnapshot*
+ *      Lookup variables in this environment snapshot, or when NULL, with
+ *      `getenv()`.
+ *  len : size_t*
+ *      Optional, set to the length of the returned string.
  *
  *  Returns
  *  -------
  *      char* : String with environment variable expanded. Caller to free.
+ *      NULL : The string could not be expanded, inspect `errno`.
  */
-char* dse_expand_vars(const char* source)
+char* dse_expand_vars_env(const char* source, DseEnvSnapshot* env, size_t* len)
 {
-    char* source_copy = strdup(source);
-    char* haystack = source_copy;
-    char* result = calloc(EXPAND_VAR_MAXLEN + 1, sizeof(char));
+    if (source == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
 
-    while (haystack) {
-        /* Search for START. */
-        char* _var = strstr(haystack, "${");
-        if (_var == NULL) {
-            strncat(result, haystack, EXPAND_VAR_MAXLEN - strlen(result));
+    DseStrBuf   b = { 0 };
+    const char* haystack = source;
+    int         rc = 0;
+    while (rc == 0) {
+        /* Search for START, copy any preceding chars to the result. */
+        const char* var = strstr(haystack, "${");
+        if (var == NULL) {
+            rc = dse_strbuf_append_n(&b, haystack, strlen(haystack));
             break;
         }
-        /* Copy any preceding chars to the result. */
-        *_var = '\0';
-        strncat(result, haystack, EXPAND_VAR_MAXLEN - strlen(result));
+        rc = dse_strbuf_append_n(&b, haystack, var - haystack);
+        if (rc) break;
         /* Search for END. */
-        _var += 2;
-        char* _var_end = strstr(_var, "}");
-        if (_var_end == NULL) {
+        const char* end = strchr(var + 2, '}');
+        if (end == NULL) {
             /* Did not find the end, GIGO. */
-            strncat(result, haystack, EXPAND_VAR_MAXLEN - strlen(result));
+            rc = dse_strbuf_append_n(&b, var, strlen(var));
             break;
         }
-        *_var_end = '\0';
-        haystack = _var_end + 1; /* Setup for next iteration. */
+        haystack = end + 1; /* Setup for next iteration. */
+        var += 2;
 
         /* Does the VAR have a DEFAULT? */
-        char* _def = strstr(_var, ":-");
-        if (_def) {
-            *_def = '\0';
-            _def += 2;
+        const char* def = NULL;
+        for (const char* p = var; p + 1 < end; p++) {
+            if (p[0] == ':' && p[1] == '-') {
+                def = p;
+                break;
+            }
         }
+        size_t name_len = (def ? def : end) - var;
+
         /* Do the lookup. */
-        char* _env_val = getenv(_var);
-        if (_env_val) {
-            strncat(result, _env_val, EXPAND_VAR_MAXLEN - strlen(result));
-        } else if (_def) {
-            strncat(result, _def, EXPAND_VAR_MAXLEN - strlen(result));
+        const char* value = _getenv(env, var, name_len);
+        if (value) {
+            rc = dse_strbuf_append_n(&b, value, strlen(value));
+        } else if (def) {
+            rc = dse_strbuf_append_n(&b, def + 2, end - (def + 2));
         } else {
             /* No var, no default, GIGO. */
-            strncat(result, _var, EXPAND_VAR_MAXLEN - strlen(result));
+            rc = dse_strbuf_append_n(&b, var, name_len);
         }
     }
+    if (rc) {
+        dse_strbuf_destroy(&b);
+        errno = rc;
+        return NULL;
+    }
 
-    free(source_copy);
+    if (len) *len = b.len;
+    char* result = dse_strbuf_release(&b);
+    if (result == NULL) errno = ENOMEM;
     return result; /* Caller to free. */
 }
+
+
+/**
+ *  dse_expand_vars
+ *
+ *  Expand environment variables in a string according to typical shell
+ *  variable expansion (i.e ${FOO} or ${BAR:-default}).
+ *
+ *  Parameters
+ *  ----------
+ *  source : const char*
+ *      The string containing environment variables to expand.
+ *
+ *  Returns
+ *  -------
+ *      char* : String with environment variable expanded. Caller to free.
+ */
+char* dse_expand_vars(const char* source)
+{
+    return dse_expand_vars_env(source, NULL, NULL);
+}
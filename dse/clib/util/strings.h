@@ -6,18 +6,151 @@
 #define DSE_CLIB_UTIL_STRINGS_H_
 
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <dse/platform.h>
 
 
+typedef struct DseEnvSnapshot DseEnvSnapshot;
+
+
+/**
+String and Byte Buffers
+=======================
+
+Growable buffers with amortised (geometric) growth. Content which fits in
+`DSE_BUF_INLINE_SIZE` bytes is held in the buffer object itself (no
+allocation). Buffer objects may be copied/moved while content is inline, the
+content is accessed with `dse_strbuf_str()` and `dse_bytebuf_data()`.
+*/
+#define DSE_BUF_INLINE_SIZE 64
+
+typedef struct DseStrBuf {
+    char*  heap; /* NULL while the content is inline. */
+    size_t len;  /* Length of the string (excluding NULL terminator). */
+    size_t size; /* Size of the heap allocation. */
+    char   inline_data[DSE_BUF_INLINE_SIZE];
+} DseStrBuf;
+
+typedef struct DseByteBuf {
+    uint8_t* heap; /* NULL while the content is inline. */
+    size_t   len;  /* Length of the content. */
+    size_t   size; /* Size of the heap allocation. */
+    uint8_t  inline_data[DSE_BUF_INLINE_SIZE];
+} DseByteBuf;
+
+
+/* Capacity for a buffer of size which must hold required bytes (an empty
+buffer is sized exactly, otherwise the size is doubled). */
+static __inline__ size_t dse_buffer_grow(size_t size, size_t required)
+{
+    if (size >= required || size == 0) return required;
+    size_t _size = size;
+    while (_size < required) {
+        if (_size > SIZE_MAX / 2) return required;
+        _size *= 2;
+    }
+    return _size;
+}
+
+/**
+ASCII85 Streams
+===============
+
+Encode/decode ASCII85 in chunks to caller provided buffers. Each update call
+requires a target buffer of at least `DSE_ASCII85_ENCODE_SIZE(len)` or
+`DSE_ASCII85_DECODE_SIZE(len)` bytes (these sizes are also sufficient for the
+final calls, with len 0).
+*/
+#define DSE_ASCII85_ENCODE_SIZE(len) (((len) + 8) / 4 * 5)
+#define DSE_ASCII85_DECODE_SIZE(len) ((len) * 4 + 4)
+
+typedef struct DseAscii85Stream {
+    char     data[8]; /* Held partial group (bytes or characters). */
+    uint32_t count;   /* Number of held bytes/characters. */
+    bool     zero;    /* A zero group is held (encode). */
+} DseAscii85Stream;
+
+
+/**
+Binary to Text Codecs
+=====================
+
+Codecs which encode a binary string to a null-terminated string, and decode
+such a string back to a binary string (which is also null-terminated).
+*/
+typedef char* (*DseTextEncode)(const char* source, size_t source_len);
+typedef char* (*DseTextDecode)(const char* source, size_t* len);
+
+typedef struct DseTextCodec {
+    const char*   name;
+    DseTextEncode encode;
+    DseTextDecode decode;
+} DseTextCodec;
+
+
+static __inline__ const char* dse_strbuf_str(const DseStrBuf* b)
+{
+    return b->heap ? b->heap : b->inline_data;
+}
+
+static __inline__ void* dse_bytebuf_data(DseByteBuf* b)
+{
+    return b->heap ? b->heap : b->inline_data;
+}
+
+
 /* strings.c */
 DLL_PUBLIC char* dse_path_cat(const char* a, const char* b);
 DLL_PUBLIC char* dse_expand_vars(const char* source);
+DLL_PUBLIC char* dse_expand_vars_env(
+    const char* source, DseEnvSnapshot* env, size_t* len);
+DLL_PUBLIC DseEnvSnapshot* dse_env_snapshot_create(void);
+DLL_PUBLIC void            dse_env_snapshot_destroy(DseEnvSnapshot* env);
+DLL_PUBLIC const char*     dse_env_snapshot_get(
+    DseEnvSnapshot* env, const char* name);
+DLL_PUBLIC void  dse_strbuf_init(DseStrBuf* b);
+DLL_PUBLIC int   dse_strbuf_reserve(DseStrBuf* b, size_t len);
+DLL_PUBLIC int   dse_strbuf_append(DseStrBuf* b, const char* s);
+DLL_PUBLIC int   dse_strbuf_append_n(DseStrBuf* b, const char* s, size_t n);
+DLL_PUBLIC int   dse_strbuf_appendf(DseStrBuf* b, const char* format, ...);
+DLL_PUBLIC void  dse_strbuf_clear(DseStrBuf* b);
+DLL_PUBLIC int   dse_strbuf_shrink(DseStrBuf* b);
+DLL_PUBLIC char* dse_strbuf_release(DseStrBuf* b);
+DLL_PUBLIC void  dse_strbuf_destroy(DseStrBuf* b);
 
 
 /* binary.c */
 DLL_PUBLIC void dse_buffer_append(void** buffer, uint32_t* size,
     uint32_t* buffer_size, const void* binary, uint32_t binary_size);
+DLL_PUBLIC void  dse_bytebuf_init(DseByteBuf* b);
+DLL_PUBLIC int   dse_bytebuf_reserve(DseByteBuf* b, size_t len);
+DLL_PUBLIC int   dse_bytebuf_append(DseByteBuf* b, const void* data, size_t n);
+DLL_PUBLIC void  dse_bytebuf_clear(DseByteBuf* b);
+DLL_PUBLIC int   dse_bytebuf_shrink(DseByteBuf* b);
+DLL_PUBLIC void* dse_bytebuf_release(DseByteBuf* b, size_t* len);
+DLL_PUBLIC void  dse_bytebuf_destroy(DseByteBuf* b);
+
+
+/* ascii85.c */
+DLL_PUBLIC char*  dse_ascii85_encode(const char* source, size_t source_len);
+DLL_PUBLIC char*  dse_ascii85_decode(const char* source, size_t* len);
+DLL_PUBLIC void   dse_ascii85_stream_init(DseAscii85Stream* s);
+DLL_PUBLIC size_t dse_ascii85_encode_update(DseAscii85Stream* s,
+    const void* source, size_t source_len, char* target);
+DLL_PUBLIC size_t dse_ascii85_encode_final(DseAscii85Stream* s, char* target);
+DLL_PUBLIC size_t dse_ascii85_decode_update(DseAscii85Stream* s,
+    const char* source, size_t source_len, void* target);
+DLL_PUBLIC size_t dse_ascii85_decode_final(DseAscii85Stream* s, void* target);
+
+
+/* codec.c */
+DLL_PUBLIC char* dse_base64_encode(const char* source, size_t source_len);
+DLL_PUBLIC char* dse_base64_decode(const char* source, size_t* len);
+DLL_PUBLIC char* dse_z85_encode(const char* source, size_t source_len);
+DLL_PUBLIC char* dse_z85_decode(const char* source, size_t* len);
+DLL_PUBLIC const DseTextCodec* dse_text_codec_find(const char* name);
 
 
 #endif  // DSE_CLIB_UTIL_STRINGS_H_
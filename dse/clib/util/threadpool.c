@@ -0,0 +1,388 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <dse/testing.h>
+#include <dse/logger.h>
+#include <dse/clib/util/threadpool.h>
+
+
+typedef struct Job {
+    DseThreadPoolFunc func;
+    void*             arg;
+} Job;
+
+typedef struct Deque {
+    pthread_mutex_t lock;
+    Job*            jobs;
+    size_t          head; /* Thieves take from the head. */
+    size_t          tail; /* Owner pushes/pops at the tail. */
+    size_t          size;
+} Deque;
+
+typedef struct Worker {
+    DseThreadPool* pool;
+    size_t         index;
+    pthread_t      thread;
+} Worker;
+
+struct DseThreadPool {
+    size_t  threads;
+    Worker* worker;
+    Deque*  deque; /* threads + 1, the last deque is for the waiting thread. */
+
+    pthread_mutex_t lock;
+    pthread_cond_t  work_cond;
+    pthread_cond_t  done_cond;
+    size_t          queued;  /* Jobs in deques (upper bound). */
+    size_t          pending; /* Jobs submitted and not yet completed. */
+    size_t          next;    /* Round-robin for external submit. */
+    bool            stop;
+};
+
+
+/* Identify the deque of the calling thread (if it belongs to a pool). */
+static __thread DseThreadPool* __tls_pool = NULL;
+static __thread size_t         __tls_index = 0;
+
+
+static void _deque_push(Deque* d, Job job)
+{
+    pthread_mutex_lock(&d->lock);
+    if (d->tail == d->size) {
+        if (d->head) {
+            /* Compact before growing. */
+            memmove(d->jobs, d->jobs + d->head,
+                (d->tail - d->head) * sizeof(Job));
+            d->tail -= d->head;
+            d->head = 0;
+        }
+        if (d->tail == d->size) {
+            d->size = d->size ? d->size * 2 : 16;
+            d->jobs = realloc(d->jobs, d->size * sizeof(Job));
+        }
+    }
+    d->jobs[d->tail++] = job;
+    pthread_mutex_unlock(&d->lock);
+}
+
+
+static bool _deque_take(Deque* d, Job* job, bool steal)
+{
+    bool found = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->head < d->tail) {
+        *job = steal ? d->jobs[d->head++] : d->jobs[--d->tail];
+        if (d->head == d->tail) d->head = d->tail = 0;
+        found = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+
+static bool _find_job(DseThreadPool* pool, size_t self, Job* job)
+{
+    size_t count = pool->threads + 1;
+
+    /* Own deque first (LIFO), then steal from the others (FIFO). */
+    bool found = _deque_take(&pool->deque[self], job, false);
+    for (size_t i = 1; !found && i < count; i++) {
+        found = _deque_take(&pool->deque[(self + i) % count], job, true);
+    }
+    if (found) {
+        pthread_mutex_lock(&pool->lock);
+        pool->queued--;
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return found;
+}
+
+
+static void _run_job(DseThreadPool* pool, Job* job)
+{
+    job->func(job->arg);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->pending--;
+    if (pool->pending == 0) pthread_cond_broadcast(&pool->done_cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+
+static void* _worker(void* arg)
+{
+    Worker*        w = arg;
+    DseThreadPool* pool = w->pool;
+    __tls_pool = pool;
+    __tls_index = w->index;
+
+    for (;;) {
+        Job job;
+        if (_find_job(pool, w->index, &job)) {
+            _run_job(pool, &job);
+            continue;
+        }
+        pthread_mutex_lock(&pool->lock);
+        while (pool->stop == false && pool->queued == 0) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        bool stop = (pool->stop && pool->queued == 0);
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) break;
+    }
+    return NULL;
+}
+
+
+/**
+dse_threadpool_create
+=====================
+
+Create a thread pool.
+
+Parameters
+----------
+threads (size_t)
+: The number of worker threads. The thread calling `dse_threadpool_wait()`
+  will also execute jobs.
+
+Returns
+-------
+DseThreadPool* (pointer)
+: A thread pool object. Release with `dse_threadpool_destroy()`.
+
+NULL
+: The thread pool could not be created, inspect `errno` for details.
+*/
+DseThreadPool* dse_threadpool_create(size_t threads)
+{
+    DseThreadPool* pool = calloc(1, sizeof(DseThreadPool));
+    if (pool == NULL) return NULL;
+    pool->threads = threads;
+    pool->worker = calloc(threads + 1, sizeof(Worker));
+    pool->deque = calloc(threads + 1, sizeof(Deque));
+    if (pool->worker == NULL || pool->deque == NULL) {
+        free(pool->worker);
+        free(pool->deque);
+        free(pool);
+        errno = ENOMEM;
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+    for (size_t i = 0; i <= threads; i++) {
+        pthread_mutex_init(&pool->deque[i].lock, NULL);
+    }
+
+    for (size_t i = 0; i < threads; i++) {
+        pool->worker[i].pool = pool;
+        pool->worker[i].index = i;
+        int rc = pthread_create(
+            &pool->worker[i].thread, NULL, _worker, &pool->worker[i]);
+        if (rc) {
+            log_error("Thread pool: could not create worker (%d)", rc);
+            /* Release the deques of the workers which were not started,
+            deque i becomes the deque of the waiting thread. */
+            for (size_t j = i + 1; j <= threads; j++) {
+                pthread_mutex_destroy(&pool->deque[j].lock);
+            }
+            pool->threads = i;
+            dse_threadpool_destroy(pool);
+            errno = rc;
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+
+/**
+dse_threadpool_size
+===================
+
+Parameters
+----------
+pool (DseThreadPool*)
+: A thread pool object.
+
+Returns
+-------
+size_t
+: The number of worker threads in the pool.
+*/
+size_t dse_threadpool_size(DseThreadPool* pool)
+{
+    if (pool == NULL) return 0;
+    return pool->threads;
+}
+
+
+/**
+dse_threadpool_submit
+=====================
+
+Submit a job to the thread pool. Jobs may be submitted from within a running
+job, those jobs are placed on the deque of the calling worker.
+
+Parameters
+----------
+pool (DseThreadPool*)
+: A thread pool object.
+
+func (DseThreadPoolFunc)
+: The job function.
+
+arg (void*)
+: Argument passed to the job function.
+
+Returns
+-------
+0
+: The job was submitted.
+
+-EINVAL
+: Bad arguments.
+*/
+int dse_threadpool_submit(
+    DseThreadPool* pool, DseThreadPoolFunc func, void* arg)
+{
+    if (pool == NULL || func == NULL) return -EINVAL;
+
+    size_t index;
+    pthread_mutex_lock(&pool->lock);
+    if (__tls_pool == pool) {
+        index = __tls_index;
+    } else if (pool->threads) {
+        index = pool->next++ % pool->threads;
+    } else {
+        index = pool->threads;
+    }
+    /* Counted before the push so that a thief never decrements below 0. */
+    pool->pending++;
+    pool->queued++;
+    pthread_mutex_unlock(&pool->lock);
+
+    _deque_push(&pool->deque[index], (Job){ .func = func, .arg = arg });
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    return 0;
+}
+
+
+/**
+dse_threadpool_wait
+===================
+
+Wait until all submitted jobs have completed (a barrier). The calling thread
+participates in executing jobs while waiting. Must not be called from a job
+of the same pool, the calling job is itself pending and the wait would never
+complete.
+
+Parameters
+----------
+pool (DseThreadPool*)
+: A thread pool object.
+*/
+void dse_threadpool_wait(DseThreadPool* pool)
+{
+    if (pool == NULL) return;
+
+    size_t self = (__tls_pool == pool) ? __tls_index : pool->threads;
+    for (;;) {
+        Job job;
+        if (_find_job(pool, self, &job)) {
+            _run_job(pool, &job);
+            continue;
+        }
+        pthread_mutex_lock(&pool->lock);
+        if (pool->pending == 0) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        if (pool->queued == 0) {
+            pthread_cond_wait(&pool->done_cond, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+
+/**
+dse_threadpool_run_one
+======================
+
+Execute one queued job (if any) on the calling thread. Unlike
+`dse_threadpool_wait()` this function may be called from a job.
+
+Parameters
+----------
+pool (DseThreadPool*)
+: A thread pool object.
+
+Returns
+-------
+true
+: A job was executed.
+
+false
+: No jobs were queued (submitted jobs may still be running).
+*/
+bool dse_threadpool_run_one(DseThreadPool* pool)
+{
+    if (pool == NULL) return false;
+
+    size_t self = (__tls_pool == pool) ? __tls_index : pool->threads;
+    Job    job;
+    if (_find_job(pool, self, &job) == false) return false;
+    _run_job(pool, &job);
+    return true;
+}
+
+
+/**
+dse_threadpool_destroy
+======================
+
+Complete any remaining jobs, stop the worker threads and release resources
+allocated to the thread pool.
+
+Parameters
+----------
+pool (DseThreadPool*)
+: A thread pool object.
+*/
+void dse_threadpool_destroy(DseThreadPool* pool)
+{
+    if (pool == NULL) return;
+
+    dse_threadpool_wait(pool);
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 0; i < pool->threads; i++) {
+        pthread_join(pool->worker[i].thread, NULL);
+    }
+
+    for (size_t i = 0; i <= pool->threads; i++) {
+        pthread_mutex_destroy(&pool->deque[i].lock);
+        free(pool->deque[i].jobs);
+    }
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->deque);
+    free(pool->worker);
+    free(pool);
+}
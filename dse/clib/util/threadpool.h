@@ -0,0 +1,45 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_CLIB_UTIL_THREADPOOL_H_
+#define DSE_CLIB_UTIL_THREADPOOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <dse/platform.h>
+
+
+/**
+Thread Pool
+===========
+
+A work-stealing thread pool. Each worker owns a job deque; jobs submitted from
+a worker are pushed to that workers deque (and are popped LIFO), idle workers
+steal jobs (FIFO) from the deques of other workers. Jobs submitted from
+outside the pool are distributed across the worker deques.
+
+The thread calling `dse_threadpool_wait()` also executes jobs until all
+submitted jobs have completed, a pool with 0 worker threads is therefore valid
+and executes all jobs on the waiting thread.
+
+Calling `dse_threadpool_wait()` from inside a job of the same pool deadlocks
+(the calling job is counted as pending until it returns). To wait for a
+subset of jobs (e.g. the sub-jobs of a job, or the jobs of one user of a shared
+pool), count those jobs and call `dse_threadpool_run_one()` until they have
+completed.
+*/
+typedef struct DseThreadPool DseThreadPool;
+typedef void (*DseThreadPoolFunc)(void* arg);
+
+
+DLL_PUBLIC DseThreadPool* dse_threadpool_create(size_t threads);
+DLL_PUBLIC size_t         dse_threadpool_size(DseThreadPool* pool);
+DLL_PUBLIC int            dse_threadpool_submit(
+    DseThreadPool* pool, DseThreadPoolFunc func, void* arg);
+DLL_PUBLIC void           dse_threadpool_wait(DseThreadPool* pool);
+DLL_PUBLIC bool           dse_threadpool_run_one(DseThreadPool* pool);
+DLL_PUBLIC void           dse_threadpool_destroy(DseThreadPool* pool);
+
+
+#endif  // DSE_CLIB_UTIL_THREADPOOL_H_
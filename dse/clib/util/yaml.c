@@ -11,19 +11,24 @@
 #include <ctype.h>
 #include <yaml.h>
 #include <dse/testing.h>
+#include <dse/clib/collections/hashmap.h>
 #include <dse/clib/util/yaml.h>
+#include <dse/clib/util/strings.h>
 #include <dse/logger.h>
 
 
 #define HASHLIST_DEFAULT_SIZE 64
 #define HASHMAP_DEFAULT_SIZE  16
-#define EXPAND_VAR_MAXLEN     1023
 
 
 /* Internal API. */
 static YamlDocList* _parse_file(const char* filename, YamlDocList* doc_list);
 static void         _destroy_node(YamlNode* node);
 static void         _destroy_doc_list(YamlDocList* doc_list);
+static YamlDocList* _create_doc_list(void);
+static YamlNode*    _create_node(char* name, YamlNode* parent);
+static YamlNode*    _handle_node_event(yaml_event_t* event, YamlNode* node);
+static YamlNode*    _scalar_node(YamlNode* node, const char* name);
 
 
 static char* __strdup__(const char* s)
@@ -49,7 +54,9 @@ static char* __strdup__(const char* s)
  *  Returns
  *  -------
  *      YamlDocList* : List of parsed documents, including previously parsed
- *          documents if doc_list was provided as an argument.
+ *          documents if doc_list was provided as an argument. If the file
+ *          could not be (fully) parsed then errno is set, otherwise errno
+ *          is 0.
  */
 DLL_PUBLIC YamlDocList* dse_yaml_load_file(
     const char* filename, YamlDocList* doc_list)
@@ -136,12 +143,8 @@ DLL_PUBLIC YamlNode* dse_yaml_load_single_doc(const char* filename)
  */
 DLL_PUBLIC const char* dse_yaml_get_scalar(YamlNode* node, const char* name)
 {
-    YamlNode* _ = dse_yaml_find_node(node, name);
-    if (_ && _->scalar) {
-        if (node->__inter__) node->__inter__(_);
-        return _->scalar;
-    }
-    return NULL;
+    YamlNode* _ = _scalar_node(node, name);
+    return _ ? _->scalar : NULL;
 }
 
 
@@ -173,6 +176,183 @@ DLL_PUBLIC const char** dse_yaml_get_array(
 }
 
 
+/* Typed values of a scalar are parsed once, and cached on the node. The cache
+is keyed on the scalar pointer, so a replaced scalar (i.e. interpolation) is
+parsed again. Filling the cache writes to the node (as does interpolation), so
+the typed getters must not be called concurrently on a shared document. */
+#define VALUE_BOOL_PARSED   0x01
+#define VALUE_BOOL_VALID    0x02
+#define VALUE_INT_PARSED    0x04
+#define VALUE_INT_VALID     0x08
+#define VALUE_DOUBLE_PARSED 0x10
+#define VALUE_DOUBLE_VALID  0x20
+
+
+static void _value_check(YamlNode* n)
+{
+    if (n->value.scalar != n->scalar) {
+        n->value.scalar = n->scalar;
+        n->value.flags = 0;
+    }
+}
+
+
+static int _value_bool(YamlNode* n, bool* value)
+{
+    _value_check(n);
+    if ((n->value.flags & VALUE_BOOL_PARSED) == 0) {
+        n->value.flags |= VALUE_BOOL_PARSED;
+        /* True? */
+        const char* bool_true[] = { "y", "Y", "yes", "Yes", "YES", "true",
+            "True", "TRUE", "on", "On", "ON", NULL };
+        for (const char** p = bool_true; *p; p++) {
+            if (strcmp(*p, n->scalar)) continue;
+            n->value.b = true;
+            n->value.flags |= VALUE_BOOL_VALID;
+            break;
+        }
+        /* False? */
+        const char* bool_false[] = { "n", "N", "no", "No", "NO", "false",
+            "False", "FALSE", "off", "Off", "OFF", NULL };
+        for (const char** p = bool_false; *p; p++) {
+            if (strcmp(*p, n->scalar)) continue;
+            n->value.b = false;
+            n->value.flags |= VALUE_BOOL_VALID;
+            break;
+        }
+    }
+    if ((n->value.flags & VALUE_BOOL_VALID) == 0) return EINVAL;
+    *value = n->value.b;
+    return 0;
+}
+
+
+static int _value_int(YamlNode* n, int* value)
+{
+    _value_check(n);
+    if ((n->value.flags & VALUE_INT_PARSED) == 0) {
+        n->value.flags |= VALUE_INT_PARSED;
+        int   _errno = errno;
+        char* endptr = NULL;
+        errno = 0;
+        int _int = strtol(n->scalar, &endptr, 0);
+        if (errno == 0 && n->scalar != endptr && *endptr == '\0') {
+            n->value.i = _int;
+            n->value.flags |= VALUE_INT_VALID;
+        }
+        errno = _errno;
+    }
+    if ((n->value.flags & VALUE_INT_VALID) == 0) return EINVAL;
+    *value = n->value.i;
+    return 0;
+}
+
+
+static int _value_double(YamlNode* n, double* value)
+{
+    _value_check(n);
+    if ((n->value.flags & VALUE_DOUBLE_PARSED) == 0) {
+        n->value.flags |= VALUE_DOUBLE_PARSED;
+        /* Any digit (or '.') indicates a number. */
+        if (strpbrk(n->scalar, "0123456789.")) {
+            n->value.d = atof(n->scalar);
+            n->value.flags |= VALUE_DOUBLE_VALID;
+        }
+    }
+    if ((n->value.flags & VALUE_DOUBLE_VALID) == 0) return EINVAL;
+    *value = n->value.d;
+    return 0;
+}
+
+
+static YamlNode* _scalar_of(YamlNode* node, YamlNode* _)
+{
+    if (_ == NULL || _->scalar == NULL) return NULL;
+    if (node->__inter__) node->__inter__(_);
+    return _->scalar ? _ : NULL;
+}
+
+
+static YamlNode* _scalar_node(YamlNode* node, const char* name)
+{
+    return _scalar_of(node, dse_yaml_find_node(node, name));
+}
+
+
+static YamlNode* _find_child(YamlNode* node, const char* name)
+{
+    /* The last segment of a path, as dse_yaml_find_node(). */
+    if (node == NULL || *name == '\0') return node;
+    if (node->node_type == YAML_MAPPING_NODE) {
+        return hashmap_get(&node->mapping, name);
+    }
+    if (node->node_type == YAML_SEQUENCE_NODE ||
+        node->node_type == YAML_SCALAR_NODE) {
+        return node;
+    }
+    return NULL;
+}
+
+
+static YamlNode* _find_parent(YamlNode* node, const char* path, size_t len)
+{
+    /* The node of the first len characters of path (a compiled path). */
+    if (len == 0) return node;
+    char* _path = malloc(len + 1);
+    if (_path == NULL) return NULL;
+    memcpy(_path, path, len);
+    _path[len] = '\0';
+    YamlPath* _p = dse_yaml_path_compile(_path);
+    YamlNode* _ = dse_yaml_find_node_compiled(node, _p);
+    dse_yaml_path_destroy(_p);
+    free(_path);
+    return _;
+}
+
+
+static int _get_int(YamlNode* n, int* value)
+{
+    /* Integer, with fallback to bool. */
+    if (_value_int(n, value) == 0) return 0;
+    bool _bool;
+    if (_value_bool(n, &_bool) == 0) {
+        *value = _bool;
+        return 0;
+    }
+    return EINVAL;
+}
+
+
+static int _get_uint(YamlNode* n, unsigned int* value)
+{
+    /* Integer, with fallback to bool. */
+    int _int;
+    if (_value_int(n, &_int) == 0 && _int >= 0) {
+        *value = (unsigned int)_int;
+        return 0;
+    }
+    bool _bool;
+    if (_value_bool(n, &_bool) == 0) {
+        *value = _bool;
+        return 0;
+    }
+    return EINVAL;
+}
+
+
+static int _get_string(YamlNode* n, const char** value)
+{
+    /* Integer or bool values are not strings. */
+    int  _int;
+    bool _bool;
+    if (_value_int(n, &_int) == 0 || _value_bool(n, &_bool) == 0) {
+        return EINVAL;
+    }
+    *value = n->scalar;
+    return 0;
+}
+
+
 /**
  *  dse_yaml_get_bool
  *
@@ -187,25 +367,9 @@ DLL_PUBLIC const char** dse_yaml_get_array(
 DLL_PUBLIC int dse_yaml_get_bool(YamlNode* node, const char* name, bool* value)
 {
     if (node == NULL && name == NULL && value == NULL) return EINVAL;
-    const char* _scalar = dse_yaml_get_scalar(node, name);
-    if (_scalar == NULL) return EINVAL;
-    /* True? */
-    const char* bool_true[] = { "y", "Y", "yes", "Yes", "YES", "true", "True",
-        "TRUE", "on", "On", "ON", NULL };
-    for (const char** p = bool_true; *p; p++) {
-        if (strcmp(*p, _scalar)) continue;
-        *value = true;
-        return 0;
-    }
-    /* False? */
-    const char* bool_false[] = { "n", "N", "no", "No", "NO", "false", "False",
-        "FALSE", "off", "Off", "OFF", NULL };
-    for (const char** p = bool_false; *p; p++) {
-        if (strcmp(*p, _scalar)) continue;
-        *value = false;
-        return 0;
-    }
-    return EINVAL;
+    YamlNode* _ = _scalar_node(node, name);
+    if (_ == NULL) return EINVAL;
+    return _value_bool(_, value);
 }
 
 
@@ -224,23 +388,9 @@ DLL_PUBLIC int dse_yaml_get_uint(
     YamlNode* node, const char* name, unsigned int* value)
 {
     if (node == NULL || name == NULL || value == NULL) return EINVAL;
-    const char* _scalar = dse_yaml_get_scalar(node, name);
-    if (_scalar == NULL) return EINVAL;
-    /* Integer? */
-    errno = 0;
-    char* endptr = NULL;
-    int   _int = strtol(_scalar, &endptr, 0);
-    if (errno == 0 && _scalar != endptr && *endptr == '\0' && _int >= 0) {
-        *value = (unsigned int)_int;
-        return 0;
-    }
-    /* Fallback to bool? */
-    bool _bool;
-    if (dse_yaml_get_bool(node, name, &_bool) == 0) {
-        *value = _bool;
-        return 0;
-    }
-    return EINVAL;
+    YamlNode* _ = _scalar_node(node, name);
+    if (_ == NULL) return EINVAL;
+    return _get_uint(_, value);
 }
 
 
@@ -257,24 +407,10 @@ DLL_PUBLIC int dse_yaml_get_uint(
  */
 DLL_PUBLIC int dse_yaml_get_int(YamlNode* node, const char* name, int* value)
 {
-    const char* _scalar = dse_yaml_get_scalar(node, name);
-    if (node == NULL || name == NULL || value == NULL || _scalar == NULL)
-        return EINVAL;
-    /* Integer? */
-    errno = 0;
-    char* endptr = NULL;
-    int   _int = strtol(_scalar, &endptr, 0);
-    if (errno == 0 && _scalar != endptr && *endptr == '\0') {
-        *value = _int;
-        return 0;
-    }
-    /* Fallback to bool? */
-    bool _bool;
-    if (dse_yaml_get_bool(node, name, &_bool) == 0) {
-        *value = _bool;
-        return 0;
-    }
-    return EINVAL;
+    if (node == NULL || name == NULL || value == NULL) return EINVAL;
+    YamlNode* _ = _scalar_node(node, name);
+    if (_ == NULL) return EINVAL;
+    return _get_int(_, value);
 }
 
 
@@ -293,24 +429,12 @@ DLL_PUBLIC int dse_yaml_get_int(YamlNode* node, const char* name, int* value)
 DLL_PUBLIC int dse_yaml_get_string(
     YamlNode* node, const char* name, const char** value)
 {
-    const char* _scalar = dse_yaml_get_scalar(node, name);
-    if (node == NULL || name == NULL || value == NULL || _scalar == NULL)
-        return EINVAL;
-    /* Integer? */
-    int _int;
-    if (dse_yaml_get_int(node, name, &_int) == 0) {
-        *value = NULL;
-        return EINVAL;
-    }
-    /* bool? */
-    bool _bool;
-    if (dse_yaml_get_bool(node, name, &_bool) == 0) {
-        *value = NULL;
-        return EINVAL;
-    }
-    /* String */
-    *value = _scalar;
-    return 0;
+    if (node == NULL || name == NULL || value == NULL) return EINVAL;
+    YamlNode* _ = _scalar_node(node, name);
+    if (_ == NULL) return EINVAL;
+    int rc = _get_string(_, value);
+    if (rc) *value = NULL;
+    return rc;
 }
 
 
@@ -328,16 +452,102 @@ DLL_PUBLIC int dse_yaml_get_string(
 DLL_PUBLIC int dse_yaml_get_double(
     YamlNode* node, const char* name, double* value)
 {
-    const char* _scalar = dse_yaml_get_scalar(node, name);
-    if (_scalar == NULL) return EINVAL;
-    for (unsigned int i = 0; i < strlen(_scalar); i++) {
-        double val = atof(_scalar);
-        if (((_scalar[i] >= '0' && _scalar[i] <= '9') || _scalar[i] == '.')) {
-            *value = val;
-            return 0;
+    if (node == NULL || name == NULL || value == NULL) return EINVAL;
+    YamlNode* _ = _scalar_node(node, name);
+    if (_ == NULL) return EINVAL;
+    return _value_double(_, value);
+}
+
+
+/**
+ *  dse_yaml_get_values
+ *
+ *  Get several typed values from a YAML node, in a single call, and store
+ *  them in a caller provided struct. Each descriptor names a path (relative
+ *  to the node), the type of the value and the offset of the value in the
+ *  struct (i.e. `offsetof()`). Values are converted as with the equivalent
+ *  `dse_yaml_get_*()` function. Struct members for values which are not
+ *  found (or can not be converted) are not modified, so defaults may be set
+ *  before the call.
+ *
+ *  Descriptors which share a parent path (e.g. "a/b/x", "a/b/y") should be
+ *  adjacent in the array, the parent node is then found once and each value
+ *  with a single lookup (i.e. one walk of the node tree for a table of
+ *  descriptors grouped by parent).
+ *
+ *  The typed values are cached on the nodes (see `dse_yaml_get_int()`), so
+ *  this function must not be called concurrently on a shared document.
+ *
+ *  Parameters
+ *  ----------
+ *  node : YamlNode*
+ *      The node to search from.
+ *  desc : const YamlValueDesc*
+ *      Array of value descriptors.
+ *  count : size_t
+ *      Number of descriptors.
+ *  data : void*
+ *      Struct which is updated with the values.
+ *
+ *  Returns
+ *  -------
+ *      0 : All values were set.
+ *      EINVAL : One or more values were not set (or bad arguments).
+ */
+DLL_PUBLIC int dse_yaml_get_values(
+    YamlNode* node, const YamlValueDesc* desc, size_t count, void* data)
+{
+    if (node == NULL || data == NULL || (desc == NULL && count)) return EINVAL;
+
+    int         rc = 0;
+    const char* parent = NULL;
+    size_t      parent_len = 0;
+    YamlNode*   parent_node = NULL;
+    for (size_t i = 0; i < count; i++) {
+        YamlNode*   _ = NULL;
+        const char* path = desc[i].path;
+        if (path) {
+            const char* name = strrchr(path, '/');
+            size_t      len = name ? (size_t)(name - path) : 0;
+            if (parent == NULL || len != parent_len ||
+                strncmp(path, parent, len) != 0) {
+                parent = path;
+                parent_len = len;
+                parent_node = _find_parent(node, path, len);
+            }
+            name = name ? name + 1 : path;
+            _ = _scalar_of(node, _find_child(parent_node, name));
+        }
+        void* value = (char*)data + desc[i].offset;
+        int   _rc = EINVAL;
+        if (_) {
+            switch (desc[i].type) {
+            case YAML_VALUE_BOOL:
+                _rc = _value_bool(_, value);
+                break;
+            case YAML_VALUE_INT:
+                _rc = _get_int(_, value);
+                break;
+            case YAML_VALUE_UINT:
+                _rc = _get_uint(_, value);
+                break;
+            case YAML_VALUE_DOUBLE:
+                _rc = _value_double(_, value);
+                break;
+            case YAML_VALUE_STRING:
+                _rc = _get_string(_, value);
+                break;
+            case YAML_VALUE_SCALAR:
+                *(const char**)value = _->scalar;
+                _rc = 0;
+                break;
+            default:
+                break;
+            }
         }
+        if (_rc) rc = _rc;
     }
-    return EINVAL;
+    return rc;
 }
 
 
@@ -384,6 +594,157 @@ DLL_PUBLIC YamlNode* dse_yaml_find_node(YamlNode* root, const char* path)
 }
 
 
+/**
+ *  dse_yaml_path_compile
+ *
+ *  Compile a path (i.e. split into segments and precompute the hash of each
+ *  segment) for use with the `*_compiled` find functions. A compiled path
+ *  can be used repeatedly, for instance when searching in a loop.
+ *
+ *  Parameters
+ *  ----------
+ *  path : const char*
+ *      The path to compile (e.g. "metadata/name").
+ *
+ *  Returns
+ *  -------
+ *      YamlPath* : The compiled path (caller to free with
+ *          `dse_yaml_path_destroy()`), otherwise NULL.
+ */
+DLL_PUBLIC YamlPath* dse_yaml_path_compile(const char* path)
+{
+    if (path == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    /* Upper bound of segments, then allocate everything in one block. */
+    size_t len = strlen(path);
+    size_t count = 1;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/') count++;
+    }
+    YamlPath* yp = calloc(1, sizeof(YamlPath) + count * sizeof(uint64_t) +
+                                 count * sizeof(char*) + len + 1);
+    if (yp == NULL) return NULL;
+    yp->hash = (uint64_t*)(yp + 1);
+    yp->segment = (char**)(yp->hash + count);
+    char* _path = memcpy((char*)(yp->segment + count), path, len + 1);
+
+    char* saveptr;
+    char* token = strtok_r(_path, "/", &saveptr);
+    while (token) {
+        yp->segment[yp->count] = token;
+        yp->hash[yp->count] = hashmap_default_hash(token);
+        yp->count++;
+        token = strtok_r(NULL, "/", &saveptr);
+    }
+    return yp;
+}
+
+
+/**
+ *  dse_yaml_path_destroy
+ *
+ *  Release the resources consumed by a compiled path.
+ *
+ *  Parameters
+ *  ----------
+ *  path : YamlPath*
+ *      The compiled path to be destroyed.
+ */
+DLL_PUBLIC void dse_yaml_path_destroy(YamlPath* path)
+{
+    free(path);
+}
+
+
+/**
+ *  dse_yaml_find_node_compiled
+ *
+ *  Find a node with a compiled path, otherwise identical to
+ *  `dse_yaml_find_node()`.
+ *
+ *  Parameters
+ *  ----------
+ *  root : YamlNode*
+ *      Starting node for this search.
+ *  path : const YamlPath*
+ *      Compiled path to the node.
+ *
+ *  Returns
+ *  -------
+ *      YamlNode* : The found YAML Node, otherwise NULL.
+ */
+DLL_PUBLIC YamlNode* dse_yaml_find_node_compiled(
+    YamlNode* root, const YamlPath* path)
+{
+    if (path == NULL) return NULL;
+
+    YamlNode* node = root;
+    for (uint32_t i = 0; i < path->count && node; i++) {
+        if (node->node_type == YAML_MAPPING_NODE) {
+            /* Navigate down the Node Tree. */
+            node = hashmap_get_by_hash64(
+                &node->mapping, path->segment[i], path->hash[i]);
+        } else if (node->node_type == YAML_SEQUENCE_NODE ||
+                   node->node_type == YAML_SCALAR_NODE) {
+            /* If there is another segment, then the search went past the
+            end of the Node Tree Branch. End the search. */
+            if (i + 1 < path->count) node = NULL;
+        } else {
+            /* End the search. */
+            node = NULL;
+        }
+    }
+    return node;
+}
+
+
+static bool _match_selectors(YamlNode* root, const YamlPath** selector,
+    const char** value, uint32_t len)
+{
+    for (uint32_t sel = 0; sel < len; sel++) {
+        YamlNode* node = dse_yaml_find_node_compiled(root, selector[sel]);
+        if (node == NULL || node->scalar == NULL) return false;
+        if (strcmp(node->scalar, value[sel]) != 0) return false;
+    }
+    return true;
+}
+
+
+static bool _match_kind(YamlNode* doc, const YamlPath* kind_path,
+    const char* kind)
+{
+    YamlNode* node = dse_yaml_find_node_compiled(doc, kind_path);
+    if (node && node->scalar) {
+        if (strcmp(node->scalar, kind) != 0) return false;
+    }
+    return true;
+}
+
+
+static YamlPath** _compile_selectors(const char** selector, uint32_t len)
+{
+    YamlPath** _sel = calloc(len + 1, sizeof(YamlPath*));
+    if (_sel == NULL) return NULL;
+    for (uint32_t i = 0; i < len; i++) {
+        _sel[i] = dse_yaml_path_compile(selector[i]);
+    }
+    return _sel;
+}
+
+
+static void _destroy_selectors(YamlPath** selector, uint32_t len)
+{
+    if (selector == NULL) return;
+    for (uint32_t i = 0; i < len; i++) {
+        dse_yaml_path_destroy(selector[i]);
+    }
+    free(selector);
+}
+
+
 /**
  *  dse_yaml_find_node_in_seq
  *
@@ -410,29 +771,54 @@ DLL_PUBLIC YamlNode* dse_yaml_find_node(YamlNode* root, const char* path)
 DLL_PUBLIC YamlNode* dse_yaml_find_node_in_seq(YamlNode* root, const char* path,
     const char** selector, const char** value, uint32_t len)
 {
-    YamlNode* node;
-    YamlNode* seq;
-    YamlNode* seq_node;
+    YamlPath*  _path = dse_yaml_path_compile(path);
+    YamlPath** _sel = _compile_selectors(selector, len);
+    YamlNode*  node = NULL;
+    if (_path && _sel) {
+        node = dse_yaml_find_node_in_seq_compiled(
+            root, _path, (const YamlPath**)_sel, value, len);
+    }
+    _destroy_selectors(_sel, len);
+    dse_yaml_path_destroy(_path);
+    return node;
+}
+
 
+/**
+ *  dse_yaml_find_node_in_seq_compiled
+ *
+ *  Select a YAML sequence node based on a list of compiled selectors,
+ *  otherwise identical to `dse_yaml_find_node_in_seq()`.
+ *
+ *  Parameters
+ *  ----------
+ *  root : YamlNode*
+ *      Starting node for this search.
+ *  path : const YamlPath*
+ *      Compiled path to the sequence.
+ *  selector : const YamlPath**
+ *      Array of compiled selector paths, relative to the sequence node.
+ *  value : const char**
+ *      Array of selector values.
+ *  len : uint32t
+ *      Length of the selector/value array.
+ *
+ *  Returns
+ *  -------
+ *      YamlNode* : The found YAML Node, otherwise NULL.
+ */
+DLL_PUBLIC YamlNode* dse_yaml_find_node_in_seq_compiled(YamlNode* root,
+    const YamlPath* path, const YamlPath** selector, const char** value,
+    uint32_t len)
+{
     /* Search for sequence. */
-    seq = dse_yaml_find_node(root, path);
+    YamlNode* seq = dse_yaml_find_node_compiled(root, path);
     if (!seq) return NULL;
     /* Search and return sequence node. */
     for (uint32_t j = 0; j < hashlist_length(&seq->sequence); j++) {
-        seq_node = hashlist_at(&seq->sequence, j);
+        YamlNode* seq_node = hashlist_at(&seq->sequence, j);
         /* Check that each selector matches. */
-        uint32_t match_count = 0;
-        for (uint32_t sel = 0; sel < len; sel++) {
-            node = dse_yaml_find_node(seq_node, selector[sel]);
-            if (node && node->scalar) {
-                if (strcmp(node->scalar, value[sel]) == 0) {
-                    match_count++;
-                    continue; /* Match, try the next. */
-                }
-            }
-            break; /* No match. */
-        }
-        if (len == match_count) return seq_node;
+        if (_match_selectors(seq_node, selector, value, len)) return seq_node;
     }
     return NULL;
 }
@@ -459,23 +845,52 @@ DLL_PUBLIC YamlNode* dse_yaml_find_node_in_seq(YamlNode* root, const char* path,
 DLL_PUBLIC YamlNode* dse_yaml_find_node_in_doclist(
     YamlDocList* doc_list, const char* kind, const char* path)
 {
-    YamlNode* doc;
-    YamlNode* node;
-
     if (doc_list == NULL) return NULL;
 
+    YamlPath* _path = dse_yaml_path_compile(path);
+    YamlNode* node = dse_yaml_find_node_in_doclist_compiled(
+        doc_list, kind, _path);
+    dse_yaml_path_destroy(_path);
+    return node;
+}
+
+
+/**
+ *  dse_yaml_find_node_in_doclist_compiled
+ *
+ *  Find a YAML node in a list of documents with a compiled path, otherwise
+ *  identical to `dse_yaml_find_node_in_doclist()`.
+ *
+ *  Parameters
+ *  ----------
+ *  doc_list : YamlDocList*
+ *      List of documents.
+ *  kind : const char*
+ *      Search only in this kind of document.
+ *  path : const YamlPath*
+ *      Search for a node with this compiled path.
+ *
+ *  Returns
+ *  -------
+ *      YamlNode* : The found YAML Node, otherwise NULL.
+ */
+DLL_PUBLIC YamlNode* dse_yaml_find_node_in_doclist_compiled(
+    YamlDocList* doc_list, const char* kind, const YamlPath* path)
+{
+    if (doc_list == NULL || path == NULL) return NULL;
+
+    YamlPath* kind_path = dse_yaml_path_compile("kind");
+    YamlNode* node = NULL;
     for (uint32_t i = 0; i < hashlist_length(doc_list); i++) {
-        doc = hashlist_at(doc_list, i);
+        YamlNode* doc = hashlist_at(doc_list, i);
         /* Correct kind? */
-        node = dse_yaml_find_node(doc, "kind");
-        if (node && node->scalar) {
-            if (strcmp(node->scalar, kind) != 0) continue;
-        }
+        if (_match_kind(doc, kind_path, kind) == false) continue;
         /* Search and return node. */
-        node = dse_yaml_find_node(doc, path);
-        if (node) return node;
+        node = dse_yaml_find_node_compiled(doc, path);
+        if (node) break;
     }
-    return NULL;
+    dse_yaml_path_destroy(kind_path);
+    return node;
 }
 
 
@@ -504,32 +919,62 @@ DLL_PUBLIC YamlNode* dse_yaml_find_node_in_doclist(
 DLL_PUBLIC YamlNode* dse_yaml_find_doc_in_doclist(YamlDocList* doc_list,
     const char* kind, const char** selector, const char** value, uint32_t len)
 {
-    YamlNode* doc;
-    YamlNode* node;
+    if (doc_list == NULL) return NULL;
+
+    YamlPath** _sel = _compile_selectors(selector, len);
+    YamlNode*  doc = NULL;
+    if (_sel) {
+        doc = dse_yaml_find_doc_in_doclist_compiled(
+            doc_list, kind, (const YamlPath**)_sel, value, len);
+    }
+    _destroy_selectors(_sel, len);
+    return doc;
+}
 
+
+/**
+ *  dse_yaml_find_doc_in_doclist_compiled
+ *
+ *  Find a YAML document in a list of documents with compiled selectors,
+ *  otherwise identical to `dse_yaml_find_doc_in_doclist()`.
+ *
+ *  Parameters
+ *  ----------
+ *  doc_list : YamlDocList*
+ *      List of documents.
+ *  kind : const char*
+ *      Search only in this kind of document.
+ *  selector : const YamlPath**
+ *      Array of compiled selector paths, relative to the root node.
+ *  value : const char**
+ *      Array of selector values.
+ *  len : uint32t
+ *      Length of the selector/value array.
+ *
+ *  Returns
+ *  -------
+ *      YamlNode* : The found YAML Node, otherwise NULL.
+ */
+DLL_PUBLIC YamlNode* dse_yaml_find_doc_in_doclist_compiled(
+    YamlDocList* doc_list, const char* kind, const YamlPath** selector,
+    const char** value, uint32_t len)
+{
     if (doc_list == NULL) return NULL;
+
+    YamlPath* kind_path = dse_yaml_path_compile("kind");
+    YamlNode* found = NULL;
     for (uint32_t i = 0; i < hashlist_length(doc_list); i++) {
-        doc = hashlist_at(doc_list, i);
+        YamlNode* doc = hashlist_at(doc_list, i);
         /* Correct kind? */
-        node = dse_yaml_find_node(doc, "kind");
-        if (node && node->scalar) {
-            if (strcmp(node->scalar, kind) != 0) continue;
-        }
+        if (_match_kind(doc, kind_path, kind) == false) continue;
         /* Check that each selector matches. */
-        uint32_t match_count = 0;
-        for (uint32_t sel = 0; sel < len; sel++) {
-            node = dse_yaml_find_node(doc, selector[sel]);
-            if (node && node->scalar) {
-                if (strcmp(node->scalar, value[sel]) == 0) {
-                    match_count++;
-                    continue; /* Match, try the next. */
-                }
-            }
-            break; /* No match. */
+        if (_match_selectors(doc, selector, value, len)) {
+            found = doc;
+            break;
         }
-        if (len == match_count) return doc;
     }
-    return NULL;
+    dse_yaml_path_destroy(kind_path);
+    return found;
 }
 
 
@@ -558,33 +1003,25 @@ DLL_PUBLIC YamlNode* dse_yaml_find_doc_in_doclist(YamlDocList* doc_list,
 YamlNode* dse_yaml_find_node_in_seq_in_doclist(YamlDocList* doc_list,
     const char* kind, const char* path, const char* selector, const char* value)
 {
-    YamlNode* doc;
-    YamlNode* node;
-    YamlNode* seq;
-    YamlNode* seq_node;
-
     if (doc_list == NULL) return NULL;
 
+    YamlPath* kind_path = dse_yaml_path_compile("kind");
+    YamlPath* _path = dse_yaml_path_compile(path);
+    YamlPath* _sel = dse_yaml_path_compile(selector);
+    YamlNode* node = NULL;
     for (uint32_t i = 0; i < hashlist_length(doc_list); i++) {
-        doc = hashlist_at(doc_list, i);
+        YamlNode* doc = hashlist_at(doc_list, i);
         /* Correct kind? */
-        node = dse_yaml_find_node(doc, "kind");
-        if (node && node->scalar) {
-            if (strcmp(node->scalar, kind) != 0) continue;
-        }
-        /* Search for sequence. */
-        seq = dse_yaml_find_node(doc, path);
-        if (!seq) continue;
-        /* Search and return sequence node. */
-        for (uint32_t j = 0; j < hashlist_length(&seq->sequence); j++) {
-            seq_node = hashlist_at(&seq->sequence, j);
-            node = dse_yaml_find_node(seq_node, selector);
-            if (node && node->scalar) {
-                if (strcmp(node->scalar, value) == 0) return seq_node;
-            }
-        }
+        if (_match_kind(doc, kind_path, kind) == false) continue;
+        /* Search for sequence, and return sequence node. */
+        node = dse_yaml_find_node_in_seq_compiled(
+            doc, _path, (const YamlPath**)&_sel, &value, 1);
+        if (node) break;
     }
-    return NULL;
+    dse_yaml_path_destroy(_sel);
+    dse_yaml_path_destroy(_path);
+    dse_yaml_path_destroy(kind_path);
+    return node;
 }
 
 
@@ -654,6 +1091,333 @@ static YamlDocList* _create_doc_list(void)
 }
 
 
+/* Process a node event, returns the current node (i.e. after the event). */
+static YamlNode* _handle_node_event(yaml_event_t* event, YamlNode* node)
+{
+    switch (event->type) {
+    case YAML_SCALAR_EVENT:
+        /* Gets called individually for name and value. */
+        if (node->node_type == YAML_MAPPING_NODE ||
+            node->node_type == YAML_SEQUENCE_NODE) {
+            /* Create a child node with value as its key/name. */
+            node = _create_node((char*)event->data.scalar.value, node);
+            log_trace("  %p/%p: YAML_SCALAR_EVENT name=%s", node->parent,
+                node, (char*)event->data.scalar.value);
+            /* If the parent (i.e. node at entry) is a YAML_SEQUENCE_NODE
+             * then this is a simple array (values only). */
+            if (node->parent->node_type == YAML_SEQUENCE_NODE) {
+                _set_node_scalar(node, (char*)event->data.scalar.value);
+                /* This node is complete. */
+                node = node->parent;
+            }
+        } else {
+            /* The child node is scalar, set the node_type and value. */
+            _set_node_scalar(node, (char*)event->data.scalar.value);
+            log_trace("  %p/%p: YAML_SCALAR_EVENT name=%s value=%s",
+                node->parent, node, node->name,
+                (char*)event->data.scalar.value);
+            /* This node is complete. */
+            node = node->parent;
+        }
+        break;
+    case YAML_MAPPING_START_EVENT:
+        assert(node);
+        if (node->node_type == YAML_SEQUENCE_NODE) {
+            /* This mapping is an item of the parent sequence, create
+            a node and append to the sequence. */
+            node = _create_node(NULL, node);
+        }
+        _set_node_mapping(node);
+        log_trace("%p: YAML_MAPPING_START_EVENT name=%s type=%d", node,
+            node->name, node->node_type);
+        break;
+    case YAML_SEQUENCE_START_EVENT:
+        assert(node);
+        _set_node_sequence(node);
+        log_trace("%p: YAML_SEQUENCE_START_EVENT name=%s type=%d", node,
+            node->name, node->node_type);
+        break;
+    case YAML_MAPPING_END_EVENT:
+        log_trace("%p: YAML_MAPPING_END_EVENT name=%s type=%d", node,
+            node->name, node->node_type);
+        node = node->parent;
+        break;
+    case YAML_SEQUENCE_END_EVENT:
+        log_trace("%p: YAML_SEQUENCE_END_EVENT name=%s type=%d", node,
+            node->name, node->node_type);
+        node = node->parent;
+        break;
+    default:
+        break;
+    }
+    return node;
+}
+
+
+typedef struct QueryFrame {
+    YamlNodeType type;
+    char*        key;      /* Current key of a mapping, otherwise NULL. */
+    bool         key_next; /* Mapping: the next scalar event is a key. */
+} QueryFrame;
+
+typedef struct Query {
+    YamlPath** path;
+    YamlNode** result;
+    size_t     count;
+    size_t     pending;
+    /* Position in the document (containers above the current event). */
+    QueryFrame* frame;
+    size_t      depth;
+    size_t      frame_size;
+    /* Subtree being skipped (nesting depth). */
+    size_t      skip;
+    /* Subtree being materialised. */
+    YamlNode*   capture_root;
+    YamlNode*   capture;
+    size_t      capture_index;
+} Query;
+
+
+/* Returns 1 for an exact match (index set), 0 if the position is a prefix of
+an outstanding path, otherwise -1. */
+static int _query_match(Query* q, size_t* index)
+{
+    bool prefix = false;
+    for (size_t i = 0; i < q->count; i++) {
+        const YamlPath* p = q->path[i];
+        if (q->result[i] || p == NULL || p->count < q->depth) continue;
+        size_t d = 0;
+        while (d < q->depth && q->frame[d].key &&
+               strcmp(q->frame[d].key, p->segment[d]) == 0) {
+            d++;
+        }
+        if (d < q->depth) continue;
+        if (p->count == q->depth) {
+            *index = i;
+            return 1;
+        }
+        prefix = true;
+    }
+    return prefix ? 0 : -1;
+}
+
+
+static char* _query_name(Query* q)
+{
+    if (q->depth == 0) return NULL;
+    return q->frame[q->depth - 1].key;
+}
+
+
+static void _query_value_done(Query* q)
+{
+    if (q->depth == 0) return;
+    QueryFrame* f = &q->frame[q->depth - 1];
+    if (f->type != YAML_MAPPING_NODE) return;
+    free(f->key);
+    f->key = NULL;
+    f->key_next = true;
+}
+
+
+static void _query_push(Query* q, YamlNodeType type)
+{
+    if (q->depth == q->frame_size) {
+        q->frame_size = q->frame_size ? q->frame_size * 2 : 16;
+        q->frame = realloc(q->frame, q->frame_size * sizeof(QueryFrame));
+    }
+    q->frame[q->depth++] = (QueryFrame){
+        .type = type,
+        .key_next = (type == YAML_MAPPING_NODE),
+    };
+}
+
+
+static void _query_pop(Query* q)
+{
+    if (q->depth == 0) return;
+    q->depth--;
+    free(q->frame[q->depth].key);
+    _query_value_done(q);
+}
+
+
+static void _query_result(Query* q, size_t index, YamlNode* node)
+{
+    q->result[index] = node;
+    q->pending--;
+}
+
+
+static void _query_event(Query* q, yaml_event_t* event)
+{
+    bool start = (event->type == YAML_MAPPING_START_EVENT ||
+                  event->type == YAML_SEQUENCE_START_EVENT);
+    bool end = (event->type == YAML_MAPPING_END_EVENT ||
+                event->type == YAML_SEQUENCE_END_EVENT);
+
+    if (q->capture) {
+        /* Materialise the matched subtree. */
+        q->capture = _handle_node_event(event, q->capture);
+        if (q->capture == NULL) {
+            _query_result(q, q->capture_index, q->capture_root);
+            _query_value_done(q);
+        }
+        return;
+    }
+    if (q->skip) {
+        /* Skip a subtree which can not contain any of the paths. */
+        if (start) q->skip++;
+        if (end) q->skip--;
+        if (q->skip == 0) _query_value_done(q);
+        return;
+    }
+    if (end) {
+        _query_pop(q);
+        return;
+    }
+    if (event->type == YAML_SCALAR_EVENT && q->depth &&
+        q->frame[q->depth - 1].key_next) {
+        /* Mapping key. */
+        q->frame[q->depth - 1].key =
+            __strdup__((char*)event->data.scalar.value);
+        q->frame[q->depth - 1].key_next = false;
+        return;
+    }
+
+    /* A value (scalar, mapping or sequence) at the current position. */
+    size_t index;
+    int    match = _query_match(q, &index);
+    if (match == 1) {
+        YamlNode* root = _create_node(_query_name(q), NULL);
+        YamlNode* node = _handle_node_event(event, root);
+        if (node == NULL) {
+            /* Scalar, complete. */
+            _query_result(q, index, root);
+            _query_value_done(q);
+        } else {
+            q->capture_root = q->capture = root;
+            q->capture_index = index;
+        }
+    } else if (start && match < 0) {
+        q->skip = 1;
+    } else if (start) {
+        _query_push(q, event->type == YAML_MAPPING_START_EVENT
+                           ? YAML_MAPPING_NODE
+                           : YAML_SEQUENCE_NODE);
+    } else {
+        _query_value_done(q);
+    }
+}
+
+
+/**
+ *  dse_yaml_query_file
+ *
+ *  Query a YAML file for a set of paths without building the DOM of the
+ *  documents. The file is parsed with an event parser and only the subtrees
+ *  which match a path are materialised (as YamlNode objects), subtrees which
+ *  can not contain any of the paths are skipped. Parsing stops as soon as
+ *  all paths are found.
+ *
+ *  Paths are matched exactly (i.e. "a/b" matches the node "b" of mapping
+ *  "a"), paths do not descend into sequences. Documents are searched in
+ *  order and the first matching node, for each path, is returned (also when a
+ *  mapping has duplicate keys, where the DOM would hold the last value).
+ *
+ *  Parameters
+ *  ----------
+ *  filename : const char*
+ *      The filename to parse for YAML documents.
+ *  path : const char**
+ *      Array of paths to query.
+ *  node : YamlNode**
+ *      Array of results, set to the found node (a detached subtree, caller
+ *      to free with `dse_yaml_destroy_node()`) or NULL.
+ *  count : size_t
+ *      Length of the path/node arrays.
+ *
+ *  Returns
+ *  -------
+ *      0 : The file was parsed (some paths may not have been found).
+ *      ENOMEM : Memory allocation failed.
+ *      +ve : The file could not be parsed, the value represents an errno.
+ */
+DLL_PUBLIC int dse_yaml_query_file(
+    const char* filename, const char** path, YamlNode** node, size_t count)
+{
+    if (filename == NULL || (count && (path == NULL || node == NULL))) {
+        return EINVAL;
+    }
+
+    for (size_t i = 0; i < count; i++) node[i] = NULL;
+    Query q = { .result = node, .count = count, .pending = count };
+    q.path = calloc(count + 1, sizeof(YamlPath*));
+    if (q.path == NULL) return ENOMEM;
+    for (size_t i = 0; i < count; i++) {
+        q.path[i] = dse_yaml_path_compile(path[i]);
+    }
+
+    int   rc = 0;
+    FILE* file_handle = fopen(filename, "r");
+    if (file_handle == NULL) {
+        log_error("Error opening file: %s", filename);
+        rc = EINVAL;
+        goto error_open;
+    }
+    yaml_parser_t parser;
+    if (!yaml_parser_initialize(&parser)) {
+        log_error("Error initializing parser");
+        rc = ECANCELED;
+        goto error_parser;
+    }
+    yaml_parser_set_input_file(&parser, file_handle);
+
+    yaml_event_t event;
+    while (q.pending) {
+        if (!yaml_parser_parse(&parser, &event)) {
+            log_error("Error while parsing YAML event");
+            rc = ECANCELED;
+            break;
+        }
+        bool stream_end = (event.type == YAML_STREAM_END_EVENT);
+        switch (event.type) {
+        case YAML_DOCUMENT_START_EVENT:
+        case YAML_DOCUMENT_END_EVENT:
+            while (q.depth)
+                _query_pop(&q);
+            q.skip = 0;
+            break;
+        case YAML_SCALAR_EVENT:
+        case YAML_MAPPING_START_EVENT:
+        case YAML_SEQUENCE_START_EVENT:
+        case YAML_MAPPING_END_EVENT:
+        case YAML_SEQUENCE_END_EVENT:
+            _query_event(&q, &event);
+            break;
+        default:
+            break;
+        }
+        yaml_event_delete(&event);
+        if (stream_end) break;
+    }
+    yaml_parser_delete(&parser);
+
+error_parser:
+    fclose(file_handle);
+error_open:
+    if (q.capture) _destroy_node(q.capture_root);
+    while (q.depth)
+        _query_pop(&q);
+    free(q.frame);
+    for (size_t i = 0; i < count; i++) {
+        dse_yaml_path_destroy(q.path[i]);
+    }
+    free(q.path);
+    return rc;
+}
+
+
 static YamlDocList* _parse_file(const char* filename, YamlDocList* doc_list)
 {
     errno = 0;
@@ -684,10 +1448,11 @@ static YamlDocList* _parse_file(const char* filename, YamlDocList* doc_list)
     YamlNode*    doc = NULL;
     YamlNode*    node = NULL;
     yaml_event_t event;
+    int          rc = 0;
     do {
         /* Parse the next event. */
         if (!yaml_parser_parse(&parser, &event)) {
-            if (errno == 0) errno = ECANCELED;
+            rc = errno ? errno : ECANCELED;
             log_error("Error while parsing YAML event");
             goto error_parse;
         }
@@ -706,58 +1471,12 @@ static YamlDocList* _parse_file(const char* filename, YamlDocList* doc_list)
             break;
         /* Node events. */
         case YAML_SCALAR_EVENT:
-            /* Gets called individually for name and value. */
-            if (node->node_type == YAML_MAPPING_NODE ||
-                node->node_type == YAML_SEQUENCE_NODE) {
-                /* Create a child node with value as its key/name. */
-                node = _create_node((char*)event.data.scalar.value, node);
-                log_trace("  %p/%p: YAML_SCALAR_EVENT name=%s", node->parent,
-                    node, (char*)event.data.scalar.value);
-                /* If the parent (i.e. node at entry) is a YAML_SEQUENCE_NODE
-                 * then this is a simple array (values only). */
-                if (node->parent->node_type == YAML_SEQUENCE_NODE) {
-                    _set_node_scalar(node, (char*)event.data.scalar.value);
-                    /* This node is complete. */
-                    node = node->parent;
-                }
-            } else {
-                /* The child node is scalar, set the node_type and value. */
-                _set_node_scalar(node, (char*)event.data.scalar.value);
-                log_trace("  %p/%p: YAML_SCALAR_EVENT name=%s value=%s",
-                    node->parent, node, node->name,
-                    (char*)event.data.scalar.value);
-                /* This node is complete. */
-                node = node->parent;
-            }
-            break;
         case YAML_MAPPING_START_EVENT:
-            assert(doc);
-            assert(node);
-            if (node->node_type == YAML_SEQUENCE_NODE) {
-                /* This mapping is an item of the parent sequence, create
-                a node and append to the sequence. */
-                node = _create_node(NULL, node);
-            }
-            _set_node_mapping(node);
-            log_trace("%p/%p: YAML_MAPPING_START_EVENT name=%s type=%d", doc,
-                node, node->name, node->node_type);
-            break;
         case YAML_SEQUENCE_START_EVENT:
-            assert(doc);
-            assert(node);
-            _set_node_sequence(node);
-            log_trace("%p/%p: YAML_SEQUENCE_START_EVENT name=%s type=%d", doc,
-                node, node->name, node->node_type);
-            break;
         case YAML_MAPPING_END_EVENT:
-            log_trace("%p/%p: YAML_MAPPING_END_EVENT name=%s type=%d", doc,
-                node, node->name, node->node_type);
-            node = node->parent;
-            break;
         case YAML_SEQUENCE_END_EVENT:
-            log_trace("%p/%p: YAML_SEQUENCE_END_EVENT name=%s type=%d", doc,
-                node, node->name, node->node_type);
-            node = node->parent;
+            assert(doc);
+            node = _handle_node_event(&event, node);
             break;
         /* Other events, ignored. */
         case YAML_STREAM_START_EVENT:
@@ -776,7 +1495,8 @@ error_parse:
     yaml_parser_delete(&parser);
     fclose(file_handle);
 
-    /* Return the parsed YAML documents. */
+    /* Return the parsed YAML documents, errno is only set on failure. */
+    errno = rc;
     return doc_list;
 }
 
@@ -830,51 +1550,74 @@ static void _destroy_doc_list(YamlDocList* doc_list)
 DLL_PUBLIC void dse_yaml_interpolate_env(YamlNode* n)
 {
     if (n == NULL || n->scalar == NULL) return;
+    if (strstr(n->scalar, "${") == NULL) return;
 
-    char* source_copy = strdup(n->scalar);
-    char* haystack = source_copy;
-    char* result = calloc(EXPAND_VAR_MAXLEN + 1, sizeof(char));
+    char* result = dse_expand_vars_env(n->scalar, NULL, NULL);
+    if (result == NULL) return;
+    free(n->scalar);
+    n->scalar = result;
+    n->value.flags = 0;
+}
 
-    while (haystack) {
-        /* Search for START. */
-        char* _var = strstr(haystack, "${");
-        if (_var == NULL) {
-            strncat(result, haystack, EXPAND_VAR_MAXLEN - strlen(result));
-            break;
-        }
-        /* Copy any preceding chars to the result. */
-        *_var = '\0';
-        strncat(result, haystack, EXPAND_VAR_MAXLEN - strlen(result));
-        /* Search for END. */
-        _var += 2;
-        char* _var_end = strstr(_var, "}");
-        if (_var_end == NULL) {
-            /* Did not find the end, GIGO. */
-            strncat(result, haystack, EXPAND_VAR_MAXLEN - strlen(result));
-            break;
-        }
-        *_var_end = '\0';
-        haystack = _var_end + 1; /* Setup for next iteration. */
-
-        /* Does the VAR have a DEFAULT? */
-        char* _def = strstr(_var, ":-");
-        if (_def) {
-            *_def = '\0';
-            _def += 2;
+
+static int _interpolate_tree(YamlNode* node, DseEnvSnapshot* env)
+{
+    if (node == NULL) return 0;
+    if (node->scalar && strstr(node->scalar, "${")) {
+        char* result = dse_expand_vars_env(node->scalar, env, NULL);
+        if (result == NULL) return errno;
+        free(node->scalar);
+        node->scalar = result;
+        node->value.flags = 0;
+    }
+    if (node->node_type == YAML_MAPPING_NODE) {
+        for (uint32_t i = 0; i < node->mapping.number_nodes; ++i) {
+            if (node->mapping.nodes[i] == NULL) continue;
+            int rc = _interpolate_tree(node->mapping.nodes[i]->value, env);
+            if (rc) return rc;
         }
-        /* Do the lookup. */
-        char* _env_val = getenv(_var);
-        if (_env_val) {
-            strncat(result, _env_val, EXPAND_VAR_MAXLEN - strlen(result));
-        } else if (_def) {
-            strncat(result, _def, EXPAND_VAR_MAXLEN - strlen(result));
-        } else {
-            /* No var, no default, GIGO. */
-            strncat(result, _var, EXPAND_VAR_MAXLEN - strlen(result));
+    }
+    if (node->node_type == YAML_SEQUENCE_NODE) {
+        for (uint32_t i = 0; i < hashlist_length(&node->sequence); i++) {
+            int rc = _interpolate_tree(hashlist_at(&node->sequence, i), env);
+            if (rc) return rc;
         }
     }
+    return 0;
+}
 
-    free(source_copy);
-    free(n->scalar);
-    n->scalar = result;
+
+/**
+ *  dse_yaml_interpolate_env_tree
+ *
+ *  Expand environment variables in all scalars of a YAML node (and its
+ *  children) in a single traversal. Only scalars which contain a variable
+ *  are modified.
+ *
+ *  Parameters
+ *  ----------
+ *  node : YamlNode*
+ *      The root of the YAML tree (i.e. a document).
+ *  env : DseEnvSnapshot*
+ *      Lookup variables in this environment snapshot. When NULL, a snapshot
+ *      is created (and released) by this function.
+ *
+ *  Returns
+ *  -------
+ *      0 : All scalars were expanded.
+ *      +ve : Failed, with the indicated errno.
+ */
+DLL_PUBLIC int dse_yaml_interpolate_env_tree(
+    YamlNode* node, DseEnvSnapshot* env)
+{
+    if (node == NULL) return EINVAL;
+
+    DseEnvSnapshot* _env = env;
+    if (_env == NULL) {
+        _env = dse_env_snapshot_create();
+        if (_env == NULL) return errno;
+    }
+    int rc = _interpolate_tree(node, _env);
+    if (_env != env) dse_env_snapshot_destroy(_env);
+    return rc;
 }
@@ -7,6 +7,7 @@
 
 #include <stdbool.h>
 #include <dse/clib/collections/hashlist.h>
+#include <dse/clib/util/strings.h>
 #include <dse/platform.h>
 
 
@@ -26,12 +27,47 @@ typedef struct YamlNode {
 
     /* Interpolation function. */
     YamlInterpolateFunc __inter__;
+
+    /* Typed values of the scalar, parsed (and written) on first access by
+    the dse_yaml_get_*() functions, which are therefore not thread safe. */
+    struct {
+        const char* scalar; /* The scalar which was parsed. */
+        uint32_t    flags;
+        bool        b;
+        int         i;
+        double      d;
+    } value;
 } YamlNode;
 
+typedef enum YamlValueType {
+    YAML_VALUE_BOOL = 0, /* bool */
+    YAML_VALUE_INT,      /* int */
+    YAML_VALUE_UINT,     /* unsigned int */
+    YAML_VALUE_DOUBLE,   /* double */
+    YAML_VALUE_STRING,   /* const char*, not an int or bool */
+    YAML_VALUE_SCALAR,   /* const char*, any scalar */
+} YamlValueType;
+
+typedef struct YamlValueDesc {
+    const char*   path;   /* Path of the value, relative to the node. */
+    YamlValueType type;
+    size_t        offset; /* Offset of the value in the struct. */
+} YamlValueDesc;
+
+typedef struct YamlDocIndex YamlDocIndex;
+
+typedef struct YamlPath {
+    uint32_t  count;   /* Number of path segments. */
+    char**    segment; /* Path segments, as split on '/'. */
+    uint64_t* hash;    /* Precomputed (mapping) hash of each segment. */
+} YamlPath;
+
 
 /* yaml.c */
 DLL_PUBLIC YamlDocList* dse_yaml_load_file(
     const char* filename, YamlDocList* doc_list);
+DLL_PUBLIC int          dse_yaml_query_file(
+    const char* filename, const char** path, YamlNode** node, size_t count);
 DLL_PUBLIC void         dse_yaml_destroy_doc_list(YamlDocList* doc_list);
 DLL_PUBLIC void         dse_yaml_destroy_node(YamlNode* node);
 DLL_PUBLIC YamlNode*    dse_yaml_load_single_doc(const char* filename);
@@ -46,6 +82,8 @@ DLL_PUBLIC int dse_yaml_get_double(
     YamlNode* node, const char* name, double* value);
 DLL_PUBLIC int dse_yaml_get_string(
     YamlNode* node, const char* name, const char** value);
+DLL_PUBLIC int dse_yaml_get_values(
+    YamlNode* node, const YamlValueDesc* desc, size_t count, void* data);
 DLL_PUBLIC YamlNode* dse_yaml_find_node(YamlNode* root, const char* path);
 DLL_PUBLIC YamlNode* dse_yaml_find_node_in_seq(YamlNode* root, const char* path,
     const char** selector, const char** value, uint32_t len);
@@ -57,5 +95,81 @@ DLL_PUBLIC YamlNode* dse_yaml_find_node_in_seq_in_doclist(YamlDocList* doc_list,
     const char* kind, const char* path, const char* selector,
     const char* value);
 DLL_PUBLIC void      dse_yaml_interpolate_env(YamlNode* n);
+DLL_PUBLIC int       dse_yaml_interpolate_env_tree(
+    YamlNode* node, DseEnvSnapshot* env);
+DLL_PUBLIC YamlPath* dse_yaml_path_compile(const char* path);
+DLL_PUBLIC void      dse_yaml_path_destroy(YamlPath* path);
+DLL_PUBLIC YamlNode* dse_yaml_find_node_compiled(
+    YamlNode* root, const YamlPath* path);
+DLL_PUBLIC YamlNode* dse_yaml_find_node_in_seq_compiled(YamlNode* root,
+    const YamlPath* path, const YamlPath** selector, const char** value,
+    uint32_t len);
+DLL_PUBLIC YamlNode* dse_yaml_find_node_in_doclist_compiled(
+    YamlDocList* doc_list, const char* kind, const YamlPath* path);
+DLL_PUBLIC YamlNode* dse_yaml_find_doc_in_doclist_compiled(
+    YamlDocList* doc_list, const char* kind, const YamlPath** selector,
+    const char** value, uint32_t len);
+
+
+/* yaml_load.c */
+DLL_PUBLIC YamlDocList* dse_yaml_load_files(const char** filename,
+    size_t count, YamlDocList* doc_list, size_t threads);
+
+
+/* yaml_index.c */
+DLL_PUBLIC YamlDocIndex* dse_yaml_doc_index_create(
+    YamlDocList* doc_list, const char** selector, uint32_t len);
+DLL_PUBLIC void          dse_yaml_doc_index_destroy(YamlDocIndex* index);
+DLL_PUBLIC YamlNode*     dse_yaml_find_doc_in_doc_index(YamlDocIndex* index,
+    const char* kind, const char** selector, const char** value, uint32_t len);
+DLL_PUBLIC YamlNode*     dse_yaml_find_node_in_doc_index(
+    YamlDocIndex* index, const char* kind, const char* path);
+
+
+/**
+Compact YAML DOM
+================
+
+A read-only representation of YAML documents where all nodes, child arrays
+and interned strings are held in a single arena. Nodes reference their name,
+scalar, parent and children by offset/index within the arena.
+*/
+typedef struct YamlCompact YamlCompact;
+
+typedef struct YamlCompactNode {
+    uint32_t node_type;
+    uint32_t name;   /* Offset in the string table, 0 for no name. */
+    uint32_t scalar; /* Offset in the string table, 0 for no scalar. */
+    uint32_t parent; /* Node index, UINT32_MAX for a document root. */
+    uint32_t child;  /* Index of the first child in the child array. */
+    uint32_t count;  /* Number of children. */
+} YamlCompactNode;
+
+
+/* yaml_compact.c */
+DLL_PUBLIC YamlCompact* dse_yaml_compact_load_file(const char* filename);
+DLL_PUBLIC void         dse_yaml_compact_destroy(YamlCompact* c);
+DLL_PUBLIC size_t       dse_yaml_compact_size(YamlCompact* c);
+DLL_PUBLIC size_t       dse_yaml_compact_doc_count(YamlCompact* c);
+DLL_PUBLIC const YamlCompactNode* dse_yaml_compact_doc(
+    YamlCompact* c, size_t index);
+DLL_PUBLIC const YamlCompactNode* dse_yaml_compact_child(
+    YamlCompact* c, const YamlCompactNode* node, size_t index);
+DLL_PUBLIC const char* dse_yaml_compact_name(
+    YamlCompact* c, const YamlCompactNode* node);
+DLL_PUBLIC const char* dse_yaml_compact_scalar(
+    YamlCompact* c, const YamlCompactNode* node);
+DLL_PUBLIC const YamlCompactNode* dse_yaml_compact_find_node(
+    YamlCompact* c, const YamlCompactNode* root, const char* path);
+DLL_PUBLIC const char* dse_yaml_compact_get_scalar(
+    YamlCompact* c, const YamlCompactNode* node, const char* path);
+DLL_PUBLIC int         dse_yaml_compact_save(
+    YamlCompact* c, const char* snapshot, const char* source);
+DLL_PUBLIC YamlCompact* dse_yaml_compact_load_snapshot(
+    const char* snapshot, const char* source);
+DLL_PUBLIC YamlCompact* dse_yaml_compact_load_cached(
+    const char* filename, const char* snapshot);
+DLL_PUBLIC YamlDocList* dse_yaml_compact_to_doc_list(
+    YamlCompact* c, YamlDocList* doc_list);
 
 #endif  // DSE_CLIB_UTIL_YAML_H_
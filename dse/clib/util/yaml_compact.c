@@ -0,0 +1,1100 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#else
+#include <process.h>
+#endif
+#include <yaml.h>
+#include <dse/testing.h>
+#include <dse/clib/collections/hashmap.h>
+#include <dse/clib/util/yaml.h>
+#include <dse/logger.h>
+
+
+#define YAML_COMPACT_MAGIC   0x4d435359 /* "YSCM" */
+#define YAML_COMPACT_VERSION 1
+#define YAML_COMPACT_NONE    UINT32_MAX
+#define INTERN_MAP_SIZE      1024
+#define ALIGN8(x)            (((x) + 7) & ~(size_t)7)
+#define SNAPSHOT_MAGIC       0x504e5359 /* "YSNP" */
+#define SNAPSHOT_VERSION     1
+#define HASHLIST_SIZE        64
+#define HASHMAP_SIZE         16
+
+
+/* The image is a single, position independent, block of memory:
+
+    YamlCompactHeader
+    YamlCompactNode node[node_count]
+    uint32_t        child[child_count]  (node indexes)
+    uint32_t        doc[doc_count]      (node indexes)
+    char            string[string_size] (interned, offset 0 is NULL)
+
+All references within the image are indexes or offsets.
+*/
+typedef struct YamlCompactHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    uint32_t node_count;
+    uint32_t child_count;
+    uint32_t doc_count;
+    uint32_t string_size;
+    uint64_t node_offset;
+    uint64_t child_offset;
+    uint64_t doc_offset;
+    uint64_t string_offset;
+} YamlCompactHeader;
+
+/* A snapshot file is a SnapshotHeader followed by the image, the header
+identifies the source file from which the image was built. */
+typedef struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    int64_t  source_mtime_sec;
+    int64_t  source_mtime_nsec;
+    uint64_t source_size;
+    uint64_t source_hash;
+    uint64_t image_offset;
+    uint64_t image_size;
+} SnapshotHeader;
+
+struct YamlCompact {
+    const YamlCompactHeader* header;
+    const YamlCompactNode*   node;
+    const uint32_t*          child;
+    const uint32_t*          doc;
+    const char*              string;
+    /* Set when the image is mapped from a snapshot file. */
+    void*                    map;
+    size_t                   map_size;
+};
+
+
+/* A growable array of the builder (collections/vector.h pushes one item at a
+time, strings are pushed as a block of characters). */
+typedef struct CompactBuffer {
+    void*  data;
+    size_t count;
+    size_t size;
+    size_t item_size;
+} CompactBuffer;
+
+typedef struct Builder {
+    CompactBuffer node;   /* YamlCompactNode, child/count are set later. */
+    CompactBuffer doc;    /* uint32_t */
+    CompactBuffer string; /* char */
+    HashMap       intern;
+    int           error;
+} Builder;
+
+typedef struct SortItem {
+    const char* name;
+    uint32_t    index;
+} SortItem;
+
+
+static void* _buffer_push(CompactBuffer* v, const void* item, size_t count)
+{
+    if (v->count + count > v->size) {
+        size_t size = v->size ? v->size : 64;
+        while (size < v->count + count)
+            size *= 2;
+        void* data = realloc(v->data, size * v->item_size);
+        if (data == NULL) return NULL;
+        v->data = data;
+        v->size = size;
+    }
+    void* p = (char*)v->data + v->count * v->item_size;
+    memcpy(p, item, count * v->item_size);
+    v->count += count;
+    return p;
+}
+
+
+static uint32_t _intern(Builder* b, const char* s)
+{
+    if (s == NULL) return 0;
+    void* o = hashmap_get(&b->intern, s);
+    if (o) return (uint32_t)(uintptr_t)o;
+
+    uint32_t offset = b->string.count;
+    if (_buffer_push(&b->string, s, strlen(s) + 1) == NULL) {
+        b->error = ENOMEM;
+        return 0;
+    }
+    hashmap_set(&b->intern, s, (void*)(uintptr_t)offset);
+    return offset;
+}
+
+
+static YamlCompactNode* _node(Builder* b, uint32_t index)
+{
+    return (YamlCompactNode*)b->node.data + index;
+}
+
+
+static uint32_t _create_node(Builder* b, const char* name, uint32_t parent)
+{
+    YamlCompactNode n = {
+        .node_type = YAML_NO_NODE,
+        .name = _intern(b, name),
+        .parent = parent,
+    };
+    if (_buffer_push(&b->node, &n, 1) == NULL) {
+        b->error = ENOMEM;
+        return parent;
+    }
+    return b->node.count - 1;
+}
+
+
+#ifndef _WIN32
+static int _map_file(const char* path, struct stat* st, void** data)
+{
+    /* A read-only mapping of the file, NULL for an empty file. */
+    *data = NULL;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return errno;
+    int rc = 0;
+    if (fstat(fd, st) != 0) {
+        rc = errno;
+    } else if (st->st_size) {
+        void* map = mmap(NULL, st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            rc = errno;
+        } else {
+            *data = map;
+        }
+    }
+    close(fd);
+    return rc;
+}
+
+
+static void _unmap_file(void* data, size_t size)
+{
+    if (data) munmap(data, size);
+}
+#else
+static int _map_file(const char* path, struct stat* st, void** data)
+{
+    /* Not mapped, the file is read into memory. */
+    *data = NULL;
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) return errno;
+    int rc = 0;
+    if (fstat(fileno(f), st) != 0) {
+        rc = errno;
+    } else if (st->st_size) {
+        *data = malloc(st->st_size);
+        if (*data == NULL) {
+            rc = ENOMEM;
+        } else if (fread(*data, st->st_size, 1, f) != 1) {
+            rc = EIO;
+            free(*data);
+            *data = NULL;
+        }
+    }
+    fclose(f);
+    return rc;
+}
+
+
+static void _unmap_file(void* data, size_t size)
+{
+    (void)size;
+    free(data);
+}
+#endif
+
+
+static int _parse_file(Builder* b, const char* filename)
+{
+    FILE* file_handle = fopen(filename, "r");
+    if (file_handle == NULL) {
+        log_error("Error opening file: %s", filename);
+        return EINVAL;
+    }
+    yaml_parser_t parser;
+    if (!yaml_parser_initialize(&parser)) {
+        log_error("Error initializing parser");
+        fclose(file_handle);
+        return ECANCELED;
+    }
+    yaml_parser_set_input_file(&parser, file_handle);
+
+    /* Same event handling as the YamlNode parser (yaml.c), except that nodes
+    are referenced by their index in the node vector. */
+    uint32_t     doc = YAML_COMPACT_NONE;
+    uint32_t     node = YAML_COMPACT_NONE;
+    yaml_event_t event;
+    do {
+        if (!yaml_parser_parse(&parser, &event)) {
+            log_error("Error while parsing YAML event");
+            b->error = ECANCELED;
+            goto error_parse;
+        }
+        switch (event.type) {
+        case YAML_DOCUMENT_START_EVENT:
+            doc = node = _create_node(b, NULL, YAML_COMPACT_NONE);
+            break;
+        case YAML_DOCUMENT_END_EVENT:
+            if (_buffer_push(&b->doc, &doc, 1) == NULL) b->error = ENOMEM;
+            doc = node = YAML_COMPACT_NONE;
+            break;
+        case YAML_SCALAR_EVENT: {
+            const char* value = (const char*)event.data.scalar.value;
+            if (_node(b, node)->node_type == YAML_MAPPING_NODE ||
+                _node(b, node)->node_type == YAML_SEQUENCE_NODE) {
+                uint32_t parent = node;
+                node = _create_node(b, value, parent);
+                if (_node(b, parent)->node_type == YAML_SEQUENCE_NODE) {
+                    /* Simple array (values only). */
+                    _node(b, node)->node_type = YAML_SCALAR_NODE;
+                    _node(b, node)->scalar = _node(b, node)->name;
+                    node = parent;
+                }
+            } else {
+                _node(b, node)->node_type = YAML_SCALAR_NODE;
+                _node(b, node)->scalar = _intern(b, value);
+                node = _node(b, node)->parent;
+            }
+            break;
+        }
+        case YAML_MAPPING_START_EVENT:
+            if (_node(b, node)->node_type == YAML_SEQUENCE_NODE) {
+                node = _create_node(b, NULL, node);
+            }
+            _node(b, node)->node_type = YAML_MAPPING_NODE;
+            break;
+        case YAML_SEQUENCE_START_EVENT:
+            _node(b, node)->node_type = YAML_SEQUENCE_NODE;
+            break;
+        case YAML_MAPPING_END_EVENT:
+        case YAML_SEQUENCE_END_EVENT:
+            node = _node(b, node)->parent;
+            break;
+        default:
+            break;
+        }
+        if (b->error) {
+            log_error("Error allocating YAML node");
+            goto error_parse;
+        }
+        if (event.type == YAML_STREAM_END_EVENT) break;
+        yaml_event_delete(&event);
+    } while (true);
+
+error_parse:
+    yaml_event_delete(&event);
+    yaml_parser_delete(&parser);
+    fclose(file_handle);
+    return b->error;
+}
+
+
+static int _compar_item(const void* a, const void* b)
+{
+    const SortItem* l = a;
+    const SortItem* r = b;
+    int             c = strcmp(l->name, r->name);
+    if (c) return c;
+    return (l->index > r->index) - (l->index < r->index);
+}
+
+
+/* Mapping children are sorted by name (ties in document order) so that keys
+can be located with a binary search. Of duplicate keys the last wins, which
+is consistent with the YamlNode parser. */
+static uint32_t _sort_mapping(const YamlCompactNode* node, const char* string,
+    uint32_t* child, uint32_t count)
+{
+    SortItem* item = calloc(count, sizeof(SortItem));
+    if (item == NULL) return count;
+    for (uint32_t i = 0; i < count; i++) {
+        item[i].name = string + node[child[i]].name;
+        item[i].index = child[i];
+    }
+    qsort(item, count, sizeof(SortItem), _compar_item);
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (i + 1 < count && strcmp(item[i].name, item[i + 1].name) == 0) {
+            continue;
+        }
+        child[n++] = item[i].index;
+    }
+    free(item);
+    return n;
+}
+
+
+static void _attach(YamlCompact* c, const void* data)
+{
+    const char* base = data;
+    c->header = data;
+    c->node = (const YamlCompactNode*)(base + c->header->node_offset);
+    c->child = (const uint32_t*)(base + c->header->child_offset);
+    c->doc = (const uint32_t*)(base + c->header->doc_offset);
+    c->string = base + c->header->string_offset;
+}
+
+
+static YamlCompact* _build_image(Builder* b)
+{
+    uint32_t node_count = b->node.count;
+    uint32_t doc_count = b->doc.count;
+    uint32_t string_size = b->string.count;
+    uint32_t child_count = node_count; /* Each node has at most one parent. */
+
+    size_t node_offset = ALIGN8(sizeof(YamlCompactHeader));
+    size_t child_offset =
+        ALIGN8(node_offset + node_count * sizeof(YamlCompactNode));
+    size_t doc_offset = ALIGN8(child_offset + child_count * sizeof(uint32_t));
+    size_t string_offset = ALIGN8(doc_offset + doc_count * sizeof(uint32_t));
+    size_t size = ALIGN8(string_offset + string_size);
+
+    /* The handle and the image share a single allocation. */
+    size_t       handle_size = ALIGN8(sizeof(YamlCompact));
+    YamlCompact* c = calloc(1, handle_size + size);
+    if (c == NULL) return NULL;
+    char* data = (char*)c + handle_size;
+
+    YamlCompactHeader* h = (YamlCompactHeader*)data;
+    *h = (YamlCompactHeader){
+        .magic = YAML_COMPACT_MAGIC,
+        .version = YAML_COMPACT_VERSION,
+        .size = size,
+        .node_count = node_count,
+        .child_count = child_count,
+        .doc_count = doc_count,
+        .string_size = string_size,
+        .node_offset = node_offset,
+        .child_offset = child_offset,
+        .doc_offset = doc_offset,
+        .string_offset = string_offset,
+    };
+    YamlCompactNode* node = (YamlCompactNode*)(data + node_offset);
+    uint32_t*        child = (uint32_t*)(data + child_offset);
+    char*            string = data + string_offset;
+    memcpy(node, b->node.data, node_count * sizeof(YamlCompactNode));
+    memcpy(data + doc_offset, b->doc.data, doc_count * sizeof(uint32_t));
+    memcpy(string, b->string.data, string_size);
+
+    /* Child arrays: count, prefix sum, then fill in document order. */
+    for (uint32_t i = 0; i < node_count; i++) {
+        if (node[i].parent != YAML_COMPACT_NONE) node[node[i].parent].count++;
+    }
+    uint32_t start = 0;
+    for (uint32_t i = 0; i < node_count; i++) {
+        node[i].child = start;
+        start += node[i].count;
+        node[i].count = 0;
+    }
+    for (uint32_t i = 0; i < node_count; i++) {
+        uint32_t p = node[i].parent;
+        if (p == YAML_COMPACT_NONE) continue;
+        child[node[p].child + node[p].count++] = i;
+    }
+    for (uint32_t i = 0; i < node_count; i++) {
+        if (node[i].node_type != YAML_MAPPING_NODE || node[i].count < 2) {
+            continue;
+        }
+        node[i].count =
+            _sort_mapping(node, string, child + node[i].child, node[i].count);
+    }
+
+    _attach(c, data);
+    return c;
+}
+
+
+/**
+dse_yaml_compact_load_file
+==========================
+
+Load all YAML documents from a file into a compact DOM. The compact DOM is a
+single allocation which holds all nodes, child arrays and (interned) strings
+of the parsed documents. Nodes are read-only, mapping nodes have their
+children sorted by name (duplicate keys, last wins) which are then located
+with a binary search.
+
+Parameters
+----------
+filename (const char*)
+: The filename to parse for YAML documents (i.e. delimited by '---').
+
+Returns
+-------
+YamlCompact* (pointer)
+: A compact DOM object. Release with `dse_yaml_compact_destroy()`.
+
+NULL
+: The file could not be loaded, inspect `errno` for details.
+*/
+DLL_PUBLIC YamlCompact* dse_yaml_compact_load_file(const char* filename)
+{
+    if (filename == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    YamlCompact* c = NULL;
+    Builder      b = {
+        .node.item_size = sizeof(YamlCompactNode),
+        .doc.item_size = sizeof(uint32_t),
+        .string.item_size = sizeof(char),
+    };
+    hashmap_init_alt(&b.intern, INTERN_MAP_SIZE, NULL);
+    /* Offset 0 of the string table represents NULL. */
+    _buffer_push(&b.string, "", 1);
+
+    int rc = _parse_file(&b, filename);
+    if (rc == 0) {
+        c = _build_image(&b);
+        if (c == NULL) rc = ENOMEM;
+    }
+
+    hashmap_destroy(&b.intern);
+    free(b.node.data);
+    free(b.doc.data);
+    free(b.string.data);
+    if (rc) errno = rc;
+    return c;
+}
+
+
+/**
+dse_yaml_compact_destroy
+========================
+
+Release the compact DOM (a single free, or unmap of a snapshot).
+
+Parameters
+----------
+c (YamlCompact*)
+: A compact DOM object.
+*/
+DLL_PUBLIC void dse_yaml_compact_destroy(YamlCompact* c)
+{
+    if (c) _unmap_file(c->map, c->map_size);
+    free(c);
+}
+
+
+/**
+dse_yaml_compact_size
+=====================
+
+Parameters
+----------
+c (YamlCompact*)
+: A compact DOM object.
+
+Returns
+-------
+size_t
+: The size, in bytes, of the compact DOM image.
+*/
+DLL_PUBLIC size_t dse_yaml_compact_size(YamlCompact* c)
+{
+    if (c == NULL) return 0;
+    return c->header->size;
+}
+
+
+/**
+dse_yaml_compact_doc_count
+==========================
+
+Parameters
+----------
+c (YamlCompact*)
+: A compact DOM object.
+
+Returns
+-------
+size_t
+: The number of documents in the compact DOM.
+*/
+DLL_PUBLIC size_t dse_yaml_compact_doc_count(YamlCompact* c)
+{
+    if (c == NULL) return 0;
+    return c->header->doc_count;
+}
+
+
+/**
+dse_yaml_compact_doc
+====================
+
+Parameters
+----------
+c (YamlCompact*)
+: A compact DOM object.
+
+index (size_t)
+: Index of the document (in file order).
+
+Returns
+-------
+const YamlCompactNode* (pointer)
+: The root node of the document, or NULL if `index` is out of range.
+*/
+DLL_PUBLIC const YamlCompactNode* dse_yaml_compact_doc(
+    YamlCompact* c, size_t index)
+{
+    if (c == NULL || index >= c->header->doc_count) return NULL;
+    return &c->node[c->doc[index]];
+}
+
+
+/**
+dse_yaml_compact_child
+======================
+
+Children of a mapping node are ordered by name, children of a sequence node
+are in document order.
+
+Parameters
+----------
+c (YamlCompact*)
+: A compact DOM object.
+
+node (const YamlCompactNode*)
+: The parent node.
+
+index (size_t)
+: Index of the child node, less than `node->count`.
+
+Returns
+-------
+const YamlCompactNode* (pointer)
+: The child node, or NULL if `index` is out of range.
+*/
+DLL_PUBLIC const YamlCompactNode* dse_yaml_compact_child(
+    YamlCompact* c, const YamlCompactNode* node, size_t index)
+{
+    if (c == NULL || node == NULL || index >= node->count) return NULL;
+    return &c->node[c->child[node->child + index]];
+}
+
+
+/**
+dse_yaml_compact_name
+=====================
+
+Parameters
+----------
+c (YamlCompact*)
+: A compact DOM object.
+
+node (const YamlCompactNode*)
+: A node of the compact DOM.
+
+Returns
+-------
+const char*
+: The name of the node, or NULL if the node has no name.
+*/
+DLL_PUBLIC const char* dse_yaml_compact_name(
+    YamlCompact* c, const YamlCompactNode* node)
+{
+    if (c == NULL || node == NULL || node->name == 0) return NULL;
+    return c->string + node->name;
+}
+
+
+/**
+dse_yaml_compact_scalar
+=======================
+
+Parameters
+----------
+c (YamlCompact*)
+: A compact DOM object.
+
+node (const YamlCompactNode*)
+: A node of the compact DOM.
+
+Returns
+-------
+const char*
+: The scalar value of the node, or NULL if the node has no scalar value.
+*/
+DLL_PUBLIC const char* dse_yaml_compact_scalar(
+    YamlCompact* c, const YamlCompactNode* node)
+{
+    if (c == NULL || node == NULL || node->scalar == 0) return NULL;
+    return c->string + node->scalar;
+}
+
+
+typedef struct PathToken {
+    const char* string;
+    const char* token;
+    size_t      len;
+} PathToken;
+
+static int _compar_token(const void* key, const void* item)
+{
+    const PathToken* t = key;
+    const char*      name = t->string + ((const YamlCompactNode*)item)->name;
+    int              c = strncmp(t->token, name, t->len);
+    if (c) return c;
+    return name[t->len] ? -1 : 0;
+}
+
+
+static const YamlCompactNode* _find_child(
+    YamlCompact* c, const YamlCompactNode* node, const char* token, size_t len)
+{
+    PathToken       key = { .string = c->string, .token = token, .len = len };
+    const uint32_t* child = c->child + node->child;
+    size_t          lo = 0;
+    size_t          hi = node->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int    cmp = _compar_token(&key, &c->node[child[mid]]);
+        if (cmp == 0) return &c->node[child[mid]];
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+
+static const char* _next_token(const char* p, size_t* len)
+{
+    while (*p == '/')
+        p++;
+    *len = strcspn(p, "/");
+    return *len ? p : NULL;
+}
+
+
+/**
+dse_yaml_compact_find_node
+==========================
+
+Find a node, by path, with the same semantics as `dse_yaml_find_node()`. The
+path is not copied and mapping keys are located with a binary search.
+
+Parameters
+----------
+c (YamlCompact*)
+: A compact DOM object.
+
+root (const YamlCompactNode*)
+: The node where the search starts.
+
+path (const char*)
+: Path to the node (e.g. "metadata/name").
+
+Returns
+-------
+const YamlCompactNode* (pointer)
+: The found node, otherwise NULL.
+*/
+DLL_PUBLIC const YamlCompactNode* dse_yaml_compact_find_node(
+    YamlCompact* c, const YamlCompactNode* root, const char* path)
+{
+    if (c == NULL || root == NULL || path == NULL) return NULL;
+
+    const YamlCompactNode* node = root;
+    size_t                 len;
+    const char*            token = _next_token(path, &len);
+    while (token && node) {
+        if (node->node_type == YAML_MAPPING_NODE) {
+            node = _find_child(c, node, token, len);
+            token = _next_token(token + len, &len);
+        } else if (node->node_type == YAML_SEQUENCE_NODE ||
+                   node->node_type == YAML_SCALAR_NODE) {
+            /* The search can only end here if this is the last token. */
+            token = _next_token(token + len, &len);
+            if (token) node = NULL;
+        } else {
+            node = NULL;
+        }
+    }
+    return node;
+}
+
+
+/**
+dse_yaml_compact_get_scalar
+===========================
+
+Parameters
+----------
+c (YamlCompact*)
+: A compact DOM object.
+
+node (const YamlCompactNode*)
+: The node where the search starts.
+
+path (const char*)
+: Path to the scalar node.
+
+Returns
+-------
+const char*
+: The scalar value of the found node, otherwise NULL.
+*/
+DLL_PUBLIC const char* dse_yaml_compact_get_scalar(
+    YamlCompact* c, const YamlCompactNode* node, const char* path)
+{
+    return dse_yaml_compact_scalar(
+        c, dse_yaml_compact_find_node(c, node, path));
+}
+
+
+static uint64_t _hash_bytes(const void* data, size_t len)
+{
+    /* FNV-1a. */
+    const uint8_t* p = data;
+    uint64_t       h = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+
+static int _source_identity(const char* source, SnapshotHeader* sh)
+{
+    struct stat st;
+    void*       data;
+    int         rc = _map_file(source, &st, &data);
+    if (rc) return rc;
+
+#ifndef _WIN32
+    sh->source_mtime_sec = st.st_mtim.tv_sec;
+    sh->source_mtime_nsec = st.st_mtim.tv_nsec;
+#else
+    sh->source_mtime_sec = st.st_mtime;
+    sh->source_mtime_nsec = 0;
+#endif
+    sh->source_size = st.st_size;
+    sh->source_hash = _hash_bytes(data, st.st_size);
+    _unmap_file(data, st.st_size);
+    return 0;
+}
+
+
+static bool _valid_image(const void* data, size_t size)
+{
+    const YamlCompactHeader* h = data;
+    if (size < sizeof(YamlCompactHeader)) return false;
+    if (h->magic != YAML_COMPACT_MAGIC) return false;
+    if (h->version != YAML_COMPACT_VERSION) return false;
+    if (h->size > size) return false;
+    if (h->node_offset + (uint64_t)h->node_count * sizeof(YamlCompactNode) >
+            h->size ||
+        h->child_offset + (uint64_t)h->child_count * sizeof(uint32_t) >
+            h->size ||
+        h->doc_offset + (uint64_t)h->doc_count * sizeof(uint32_t) > h->size ||
+        h->string_offset + h->string_size > h->size) {
+        return false;
+    }
+    if ((h->node_offset | h->child_offset | h->doc_offset) & 7) return false;
+    if (h->string_size == 0) return false;
+
+    /* Every reference must stay within the image, and children follow their
+       parent (as built) so that the tree has no cycles. */
+    const char*            base = data;
+    const YamlCompactNode* node =
+        (const YamlCompactNode*)(base + h->node_offset);
+    const uint32_t* child = (const uint32_t*)(base + h->child_offset);
+    const uint32_t* doc = (const uint32_t*)(base + h->doc_offset);
+    if (base[h->string_offset + h->string_size - 1] != '\0') return false;
+    for (uint32_t i = 0; i < h->node_count; i++) {
+        if (node[i].name >= h->string_size) return false;
+        if (node[i].scalar >= h->string_size) return false;
+        if ((uint64_t)node[i].child + node[i].count > h->child_count) {
+            return false;
+        }
+        for (uint32_t j = 0; j < node[i].count; j++) {
+            if (child[node[i].child + j] <= i) return false;
+        }
+    }
+    for (uint32_t i = 0; i < h->child_count; i++) {
+        if (child[i] >= h->node_count) return false;
+    }
+    for (uint32_t i = 0; i < h->doc_count; i++) {
+        if (doc[i] >= h->node_count) return false;
+    }
+    return true;
+}
+
+
+/**
+dse_yaml_compact_save
+=====================
+
+Save a compact DOM to a snapshot file. The snapshot records the identity
+(modification time, size and content hash) of the source file so that it can
+later be validated by `dse_yaml_compact_load_snapshot()`. The snapshot is
+written to a temporary file which then replaces any existing snapshot.
+
+Parameters
+----------
+c (YamlCompact*)
+: A compact DOM object.
+
+snapshot (const char*)
+: The snapshot filename.
+
+source (const char*)
+: The YAML file from which the compact DOM was loaded.
+
+Returns
+-------
+0
+: The snapshot was saved.
+
++ve
+: The snapshot was not saved, the value represents an `errno`.
+*/
+DLL_PUBLIC int dse_yaml_compact_save(
+    YamlCompact* c, const char* snapshot, const char* source)
+{
+    if (c == NULL || snapshot == NULL || source == NULL) return EINVAL;
+
+    SnapshotHeader sh = {
+        .magic = SNAPSHOT_MAGIC,
+        .version = SNAPSHOT_VERSION,
+        .image_offset = ALIGN8(sizeof(SnapshotHeader)),
+        .image_size = c->header->size,
+    };
+    int rc = _source_identity(source, &sh);
+    if (rc) return rc;
+
+    size_t tmp_len = strlen(snapshot) + 32;
+    char*  tmp = malloc(tmp_len);
+    if (tmp == NULL) return ENOMEM;
+    snprintf(tmp, tmp_len, "%s.%ld.tmp", snapshot, (long)getpid());
+    FILE* f = fopen(tmp, "wb");
+    if (f == NULL) {
+        rc = errno;
+        free(tmp);
+        return rc;
+    }
+    uint8_t pad[8] = { 0 };
+    size_t  pad_len = sh.image_offset - sizeof(SnapshotHeader);
+    errno = 0;
+    if (fwrite(&sh, sizeof(SnapshotHeader), 1, f) != 1 ||
+        (pad_len && fwrite(pad, pad_len, 1, f) != 1) ||
+        fwrite(c->header, sh.image_size, 1, f) != 1) {
+        rc = errno ? errno : EIO;
+    }
+    if (fclose(f) != 0 && rc == 0) rc = errno;
+    if (rc == 0 && rename(tmp, snapshot) != 0) rc = errno;
+    if (rc) {
+        log_error("Error writing snapshot: %s", snapshot);
+        remove(tmp);
+    }
+    free(tmp);
+    return rc;
+}
+
+
+/**
+dse_yaml_compact_load_snapshot
+==============================
+
+Map a snapshot file, previously saved with `dse_yaml_compact_save()`, as a
+compact DOM (on Windows the snapshot is read into memory instead). The
+snapshot is only used if it is valid for the source file (i.e. the
+modification time, size and content hash are unchanged).
+
+Parameters
+----------
+snapshot (const char*)
+: The snapshot filename.
+
+source (const char*)
+: The YAML file from which the snapshot was created.
+
+Returns
+-------
+YamlCompact* (pointer)
+: A compact DOM object. Release with `dse_yaml_compact_destroy()`.
+
+NULL
+: The snapshot could not be used, inspect `errno` for details (ESTALE
+  indicates that the snapshot does not match the source file).
+*/
+DLL_PUBLIC YamlCompact* dse_yaml_compact_load_snapshot(
+    const char* snapshot, const char* source)
+{
+    if (snapshot == NULL || source == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    struct stat st = { 0 };
+    void*       map;
+    int         rc = _map_file(snapshot, &st, &map);
+    if (rc == 0 && (size_t)st.st_size < sizeof(SnapshotHeader)) rc = EINVAL;
+    if (rc) {
+        _unmap_file(map, st.st_size);
+        errno = rc;
+        return NULL;
+    }
+
+    const SnapshotHeader* sh = map;
+    SnapshotHeader        id = { 0 };
+    if (sh->magic != SNAPSHOT_MAGIC || sh->version != SNAPSHOT_VERSION ||
+        sh->image_offset & 7 ||
+        sh->image_offset + sh->image_size > (uint64_t)st.st_size) {
+        rc = EINVAL;
+    } else if ((rc = _source_identity(source, &id)) == 0) {
+        if (id.source_mtime_sec != sh->source_mtime_sec ||
+            id.source_mtime_nsec != sh->source_mtime_nsec ||
+            id.source_size != sh->source_size ||
+            id.source_hash != sh->source_hash) {
+            rc = ESTALE;
+        }
+    }
+    const char* image = (const char*)map + sh->image_offset;
+    if (rc == 0 && _valid_image(image, sh->image_size) == false) rc = EINVAL;
+
+    YamlCompact* c = NULL;
+    if (rc == 0) {
+        c = calloc(1, sizeof(YamlCompact));
+        if (c == NULL) rc = ENOMEM;
+    }
+    if (rc) {
+        _unmap_file(map, st.st_size);
+        errno = rc;
+        return NULL;
+    }
+    c->map = map;
+    c->map_size = st.st_size;
+    _attach(c, image);
+    return c;
+}
+
+
+/**
+dse_yaml_compact_load_cached
+============================
+
+Load the YAML documents of a file as a compact DOM, using a snapshot file as
+a cache. If the snapshot is valid for the file it is mapped, otherwise the
+file is parsed and a new snapshot is saved (failure to save the snapshot is
+not an error).
+
+Parameters
+----------
+filename (const char*)
+: The filename to parse for YAML documents.
+
+snapshot (const char*)
+: The snapshot filename.
+
+Returns
+-------
+YamlCompact* (pointer)
+: A compact DOM object. Release with `dse_yaml_compact_destroy()`.
+
+NULL
+: The file could not be loaded, inspect `errno` for details.
+*/
+DLL_PUBLIC YamlCompact* dse_yaml_compact_load_cached(
+    const char* filename, const char* snapshot)
+{
+    YamlCompact* c = dse_yaml_compact_load_snapshot(snapshot, filename);
+    if (c) return c;
+
+    c = dse_yaml_compact_load_file(filename);
+    if (c == NULL) return NULL;
+    int rc = dse_yaml_compact_save(c, snapshot, filename);
+    if (rc) log_debug("Snapshot not saved: %s (%d)", snapshot, rc);
+    return c;
+}
+
+
+static YamlNode* _to_node(YamlCompact* c, const YamlCompactNode* cn,
+    const char* name, YamlNode* parent)
+{
+    YamlNode* node = calloc(1, sizeof(YamlNode));
+    if (node == NULL) return NULL;
+    node->node_type = cn->node_type;
+    node->parent = parent;
+    if (name) node->name = strdup(name);
+    if (cn->scalar) node->scalar = strdup(c->string + cn->scalar);
+
+    if (cn->node_type == YAML_MAPPING_NODE) {
+        hashmap_init_alt(&node->mapping, HASHMAP_SIZE, NULL);
+        for (uint32_t i = 0; i < cn->count; i++) {
+            const YamlCompactNode* child = dse_yaml_compact_child(c, cn, i);
+            const char*            key = c->string + child->name;
+            YamlNode*              n = _to_node(c, child, key, node);
+            if (n) hashmap_set(&node->mapping, key, n);
+        }
+    } else if (cn->node_type == YAML_SEQUENCE_NODE) {
+        hashlist_init(&node->sequence, HASHLIST_SIZE);
+        for (uint32_t i = 0; i < cn->count; i++) {
+            const YamlCompactNode* child = dse_yaml_compact_child(c, cn, i);
+            YamlNode*              n = _to_node(c, child,
+                             dse_yaml_compact_name(c, child), node);
+            if (n) hashlist_append(&node->sequence, n);
+        }
+    }
+    return node;
+}
+
+
+/**
+dse_yaml_compact_to_doc_list
+============================
+
+Convert the documents of a compact DOM to YamlNode documents (for use with
+the `dse_yaml_*` API), without parsing the YAML source again.
+
+Parameters
+----------
+c (YamlCompact*)
+: A compact DOM object.
+
+doc_list (YamlDocList*)
+: List of documents, if set (not NULL) then the documents will be appended to
+  that list.
+
+Returns
+-------
+YamlDocList* (pointer)
+: List of documents. Release with `dse_yaml_destroy_doc_list()`.
+*/
+DLL_PUBLIC YamlDocList* dse_yaml_compact_to_doc_list(
+    YamlCompact* c, YamlDocList* doc_list)
+{
+    if (doc_list == NULL) {
+        doc_list = calloc(1, sizeof(YamlDocList));
+        if (doc_list == NULL) return NULL;
+        hashlist_init(doc_list, HASHLIST_SIZE);
+    }
+    for (size_t i = 0; i < dse_yaml_compact_doc_count(c); i++) {
+        YamlNode* doc = _to_node(c, dse_yaml_compact_doc(c, i), NULL, NULL);
+        if (doc) hashlist_append(doc_list, doc);
+    }
+    return doc_list;
+}
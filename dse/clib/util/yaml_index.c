@@ -0,0 +1,383 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <yaml.h>
+#include <dse/testing.h>
+#include <dse/clib/collections/hashmap.h>
+#include <dse/clib/util/yaml.h>
+#include <dse/logger.h>
+
+
+#define UNUSED(x)       ((void)x)
+#define INDEX_MAP_SIZE  1024
+#define INDEX_KEY_SIZE  256
+#define INDEX_SEP       "\x1f"
+#define INDEX_WILDCARD  "*"
+#define INDEX_META_NAME "metadata/name"
+
+
+/* Documents (by position in the doc list, ascending) which share a key. */
+typedef struct DocRefList {
+    uint32_t* item;
+    uint32_t  count;
+    uint32_t  size;
+} DocRefList;
+
+struct YamlDocIndex {
+    YamlDocList* doc_list;
+    uint32_t     indexed; /* Documents indexed so far. */
+    HashMap      map;
+    YamlPath*    kind_path;
+    uint32_t     selector_count;
+    char**       selector;
+    YamlPath**   selector_path;
+};
+
+
+/* Index keys:
+    kind                         -> "k:<kind>" or "*" (no kind, wildcard)
+    kind, selector and value     -> "<kind key>\x1f<selector>\x1f<value>"
+*/
+static char* _key(char* buf, const char* kind, const char* selector,
+    const char* value)
+{
+    size_t len = (kind ? strlen(kind) + 2 : 1) + 1;
+    if (selector) len += strlen(selector) + strlen(value) + 2;
+    char* key = (len <= INDEX_KEY_SIZE) ? buf : malloc(len);
+    if (key == NULL) return NULL;
+    if (selector) {
+        snprintf(key, len, "%s%s" INDEX_SEP "%s" INDEX_SEP "%s",
+            kind ? "k:" : INDEX_WILDCARD, kind ? kind : "", selector, value);
+    } else {
+        snprintf(key, len, "%s%s", kind ? "k:" : INDEX_WILDCARD,
+            kind ? kind : "");
+    }
+    return key;
+}
+
+
+static void _add_ref(YamlDocIndex* index, const char* key, uint32_t doc)
+{
+    DocRefList* l = hashmap_get(&index->map, key);
+    if (l == NULL) {
+        l = calloc(1, sizeof(DocRefList));
+        if (l == NULL) return;
+        hashmap_set(&index->map, key, l);
+    }
+    if (l->count == l->size) {
+        uint32_t  size = l->size ? l->size * 2 : 4;
+        uint32_t* item = realloc(l->item, size * sizeof(uint32_t));
+        if (item == NULL) return;
+        l->item = item;
+        l->size = size;
+    }
+    l->item[l->count++] = doc;
+}
+
+
+static const char* _doc_kind(YamlDocIndex* index, YamlNode* doc)
+{
+    /* A document without a (scalar) kind matches any kind. */
+    YamlNode* node = dse_yaml_find_node_compiled(doc, index->kind_path);
+    if (node && node->scalar) return node->scalar;
+    return NULL;
+}
+
+
+static void _index_docs(YamlDocIndex* index)
+{
+    char buf[INDEX_KEY_SIZE];
+    for (uint32_t i = index->indexed; i < hashlist_length(index->doc_list);
+         i++) {
+        YamlNode*   doc = hashlist_at(index->doc_list, i);
+        const char* kind = _doc_kind(index, doc);
+
+        char* key = _key(buf, kind, NULL, NULL);
+        if (key) _add_ref(index, key, i);
+        if (key != buf) free(key);
+        for (uint32_t s = 0; s < index->selector_count; s++) {
+            YamlNode* node =
+                dse_yaml_find_node_compiled(doc, index->selector_path[s]);
+            if (node == NULL || node->scalar == NULL) continue;
+            key = _key(buf, kind, index->selector[s], node->scalar);
+            if (key) _add_ref(index, key, i);
+            if (key != buf) free(key);
+        }
+    }
+    index->indexed = hashlist_length(index->doc_list);
+}
+
+
+static DocRefList* _lookup(YamlDocIndex* index, const char* kind,
+    const char* selector, const char* value)
+{
+    char        buf[INDEX_KEY_SIZE];
+    char*       key = _key(buf, kind, selector, value);
+    DocRefList* l = key ? hashmap_get(&index->map, key) : NULL;
+    if (key != buf) free(key);
+    return l;
+}
+
+
+static int _selector_index(YamlDocIndex* index, const char* selector)
+{
+    for (uint32_t s = 0; s < index->selector_count; s++) {
+        if (strcmp(index->selector[s], selector) == 0) return s;
+    }
+    return -1;
+}
+
+
+static bool _match_selectors(YamlNode* doc, const char** selector,
+    const char** value, uint32_t len)
+{
+    for (uint32_t sel = 0; sel < len; sel++) {
+        YamlNode* node = dse_yaml_find_node(doc, selector[sel]);
+        if (node == NULL || node->scalar == NULL) return false;
+        if (strcmp(node->scalar, value[sel]) != 0) return false;
+    }
+    return true;
+}
+
+
+/* Candidate documents, in doc list order, are the merge of the documents
+with the requested kind and those documents without a kind. */
+typedef struct Candidates {
+    DocRefList* kind;
+    DocRefList* wildcard;
+    uint32_t    k;
+    uint32_t    w;
+} Candidates;
+
+static bool _next_candidate(Candidates* c, uint32_t* doc)
+{
+    bool has_k = c->kind && c->k < c->kind->count;
+    bool has_w = c->wildcard && c->w < c->wildcard->count;
+    if (has_k && has_w) {
+        has_k = c->kind->item[c->k] < c->wildcard->item[c->w];
+        has_w = !has_k;
+    }
+    if (has_k) {
+        *doc = c->kind->item[c->k++];
+        return true;
+    }
+    if (has_w) {
+        *doc = c->wildcard->item[c->w++];
+        return true;
+    }
+    return false;
+}
+
+
+static void _destroy_ref(void* map_item, void* data)
+{
+    UNUSED(data);
+    DocRefList* l = map_item;
+    free(l->item);
+}
+
+
+/**
+dse_yaml_doc_index_create
+=========================
+
+Create an index of the documents in a document list. Documents are indexed by
+`kind`, and by `kind` together with the value of each selector path (the
+path `metadata/name` is always indexed). Documents which are later appended
+to the document list (i.e. with `dse_yaml_load_file()`) are indexed when the
+index is next used.
+
+Lookups with the index return the same documents as the equivalent
+`dse_yaml_find_*_in_doclist()` function; documents without a `kind` match any
+kind and the first matching document (in doc list order) is returned.
+
+Parameters
+----------
+doc_list (YamlDocList*)
+: List of documents. The document list must outlive the index.
+
+selector (const char**)
+: Array of additional selector paths to index (may be NULL).
+
+len (uint32_t)
+: Length of the selector array.
+
+Returns
+-------
+YamlDocIndex* (pointer)
+: A document index. Release with `dse_yaml_doc_index_destroy()`.
+
+NULL
+: The index could not be created, inspect `errno` for details.
+*/
+DLL_PUBLIC YamlDocIndex* dse_yaml_doc_index_create(
+    YamlDocList* doc_list, const char** selector, uint32_t len)
+{
+    if (doc_list == NULL || (selector == NULL && len)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    YamlDocIndex* index = calloc(1, sizeof(YamlDocIndex));
+    if (index == NULL) return NULL;
+    index->doc_list = doc_list;
+    hashmap_init_alt(&index->map, INDEX_MAP_SIZE, NULL);
+    index->kind_path = dse_yaml_path_compile("kind");
+    index->selector = calloc(len + 1, sizeof(char*));
+    index->selector_path = calloc(len + 1, sizeof(YamlPath*));
+    if (index->selector == NULL || index->selector_path == NULL) {
+        dse_yaml_doc_index_destroy(index);
+        errno = ENOMEM;
+        return NULL;
+    }
+    const char* meta_name = INDEX_META_NAME;
+    for (uint32_t i = 0; i <= len; i++) {
+        const char* s = (i == 0) ? meta_name : selector[i - 1];
+        if (s == NULL || _selector_index(index, s) >= 0) continue;
+        index->selector[index->selector_count] = strdup(s);
+        index->selector_path[index->selector_count] = dse_yaml_path_compile(s);
+        index->selector_count++;
+    }
+
+    _index_docs(index);
+    return index;
+}
+
+
+/**
+dse_yaml_doc_index_destroy
+==========================
+
+Release the resources consumed by a document index (the indexed documents are
+not affected).
+
+Parameters
+----------
+index (YamlDocIndex*)
+: A document index.
+*/
+DLL_PUBLIC void dse_yaml_doc_index_destroy(YamlDocIndex* index)
+{
+    if (index == NULL) return;
+
+    hashmap_destroy_ext(&index->map, _destroy_ref, NULL);
+    for (uint32_t s = 0; s < index->selector_count; s++) {
+        free(index->selector[s]);
+        dse_yaml_path_destroy(index->selector_path[s]);
+    }
+    free(index->selector);
+    free(index->selector_path);
+    dse_yaml_path_destroy(index->kind_path);
+    free(index);
+}
+
+
+/**
+dse_yaml_find_doc_in_doc_index
+==============================
+
+Find a YAML document using a document index. When one of the selectors was
+indexed only documents with that selector value are searched, otherwise only
+documents of the requested kind are searched.
+
+Parameters
+----------
+index (YamlDocIndex*)
+: A document index.
+
+kind (const char*)
+: Search only in this kind of document.
+
+selector (const char**)
+: Array of selector paths, relative to the path on the root node.
+
+value (const char**)
+: Array of selector values.
+
+len (uint32_t)
+: Length of the selector/value array.
+
+Returns
+-------
+YamlNode* (pointer)
+: The found YAML document, otherwise NULL.
+*/
+DLL_PUBLIC YamlNode* dse_yaml_find_doc_in_doc_index(YamlDocIndex* index,
+    const char* kind, const char** selector, const char** value, uint32_t len)
+{
+    if (index == NULL || kind == NULL) return NULL;
+    _index_docs(index);
+
+    Candidates c = { 0 };
+    int        sel = -1;
+    for (uint32_t i = 0; i < len && sel < 0; i++) {
+        if (_selector_index(index, selector[i]) < 0) continue;
+        sel = i;
+    }
+    if (sel >= 0) {
+        c.kind = _lookup(index, kind, selector[sel], value[sel]);
+        c.wildcard = _lookup(index, NULL, selector[sel], value[sel]);
+    } else {
+        c.kind = _lookup(index, kind, NULL, NULL);
+        c.wildcard = _lookup(index, NULL, NULL, NULL);
+    }
+
+    uint32_t doc_index;
+    while (_next_candidate(&c, &doc_index)) {
+        YamlNode* doc = hashlist_at(index->doc_list, doc_index);
+        if (_match_selectors(doc, selector, value, len)) return doc;
+    }
+    return NULL;
+}
+
+
+/**
+dse_yaml_find_node_in_doc_index
+===============================
+
+Find a YAML node using a document index. Only documents of the requested kind
+are searched.
+
+Parameters
+----------
+index (YamlDocIndex*)
+: A document index.
+
+kind (const char*)
+: Search only in this kind of document.
+
+path (const char*)
+: Search for a node with this path.
+
+Returns
+-------
+YamlNode* (pointer)
+: The found YAML node, otherwise NULL.
+*/
+DLL_PUBLIC YamlNode* dse_yaml_find_node_in_doc_index(
+    YamlDocIndex* index, const char* kind, const char* path)
+{
+    if (index == NULL || kind == NULL || path == NULL) return NULL;
+    _index_docs(index);
+
+    Candidates c = {
+        .kind = _lookup(index, kind, NULL, NULL),
+        .wildcard = _lookup(index, NULL, NULL, NULL),
+    };
+    YamlPath* _path = dse_yaml_path_compile(path);
+    YamlNode* node = NULL;
+    uint32_t  doc_index;
+    while (node == NULL && _next_candidate(&c, &doc_index)) {
+        YamlNode* doc = hashlist_at(index->doc_list, doc_index);
+        node = dse_yaml_find_node_compiled(doc, _path);
+    }
+    dse_yaml_path_destroy(_path);
+    return node;
+}
@@ -0,0 +1,106 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <dse/clib/collections/hashlist.h>
+#include <dse/clib/util/yaml.h>
+#include <dse/clib/util/threadpool.h>
+
+
+#define HASHLIST_DEFAULT_SIZE 64
+
+
+typedef struct LoadFileJob {
+    const char*  filename;
+    YamlDocList* doc_list;
+    int          errnum;
+} LoadFileJob;
+
+
+static void _load_file_job(void* arg)
+{
+    LoadFileJob* job = arg;
+    /* The parser sets errno (on the worker thread) only on failure, the
+       documents which were parsed are still returned. */
+    errno = 0;
+    job->doc_list = dse_yaml_load_file(job->filename, NULL);
+    if (job->doc_list == NULL || errno) job->errnum = errno ? errno : ENOMEM;
+}
+
+
+/**
+ *  dse_yaml_load_files
+ *
+ *  Load all YAML documents from a list of files, concurrently, and return
+ *  the list of documents. Each file is parsed by its own parser (on a worker
+ *  thread), the parsed documents are then appended to the document list in
+ *  the order of the files (i.e. the same order as calling
+ *  `dse_yaml_load_file()` for each file).
+ *
+ *  Parameters
+ *  ----------
+ *  filename : const char**
+ *      Array of filenames to parse for YAML documents.
+ *  count : size_t
+ *      Length of the filename array.
+ *  doc_list : YamlDocList*
+ *      List of documents, if set (not NULL) then parsed documents will be
+ *      appended to that list.
+ *  threads : size_t
+ *      Number of worker threads (0 to parse all files on the calling thread).
+ *
+ *  Returns
+ *  -------
+ *      YamlDocList* : List of parsed documents, including previously parsed
+ *          documents if doc_list was provided as an argument. If a file could
+ *          not be parsed then errno is set (to the error of the first such
+ *          file).
+ */
+DLL_PUBLIC YamlDocList* dse_yaml_load_files(const char** filename,
+    size_t count, YamlDocList* doc_list, size_t threads)
+{
+    errno = 0;
+    if (doc_list == NULL) {
+        doc_list = calloc(1, sizeof(HashList));
+        if (doc_list == NULL) return NULL;
+        if (hashlist_init(doc_list, HASHLIST_DEFAULT_SIZE) != 0) {
+            free(doc_list);
+            if (errno == 0) errno = ENOMEM;
+            return NULL;
+        }
+    }
+    if (filename == NULL || count == 0) return doc_list;
+
+    LoadFileJob*   job = calloc(count, sizeof(LoadFileJob));
+    DseThreadPool* pool = dse_threadpool_create(threads);
+    if (job == NULL || pool == NULL) {
+        if (errno == 0) errno = ENOMEM;
+        dse_threadpool_destroy(pool);
+        free(job);
+        return doc_list;
+    }
+    for (size_t i = 0; i < count; i++) {
+        job[i].filename = filename[i];
+        dse_threadpool_submit(pool, _load_file_job, &job[i]);
+    }
+    dse_threadpool_wait(pool);
+    dse_threadpool_destroy(pool);
+
+    /* Merge, in file order. */
+    int errnum = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (job[i].errnum && errnum == 0) errnum = job[i].errnum;
+        if (job[i].doc_list == NULL) continue;
+        for (uint32_t d = 0; d < hashlist_length(job[i].doc_list); d++) {
+            hashlist_append(doc_list, hashlist_at(job[i].doc_list, d));
+        }
+        hashlist_destroy(job[i].doc_list);
+        free(job[i].doc_list);
+    }
+    free(job);
+    errno = errnum;
+    return doc_list;
+}
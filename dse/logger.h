@@ -36,7 +36,61 @@ typedef enum LoggerLevel {
 
 
 DLL_PUBLIC extern uint8_t __log_level__;
+
+
+/* Compile-time minimum log level. Log calls below this level are removed
+(with their arguments) at compile time, define before including this file
+(or with -DLOG_LEVEL_MIN=LOG_INFO). Errors and notices are never removed. */
+#ifndef LOG_LEVEL_MIN
+#define LOG_LEVEL_MIN LOG_TRACE
+#endif
+
+
+/* Logger backend (optional), see dse/clib/util/logger.h. When linked, the
+backend receives each log message and returns 0 if the message was consumed,
+otherwise the message is printed to the console. */
+#if defined(__GNUC__) && !defined(_WIN32)
+#define LOG_BACKEND 1
+DLL_PUBLIC extern int __log_backend__(int level, const char* file, int line,
+    const char* format, va_list args) __attribute__((weak));
+#endif
+
+
+/* Per-module log level. Define LOG_MODULE (a name) before including this
+file, the module then has a runtime log level which may be set with
+dse_logger_set_module_level() (see dse/clib/util/logger.h). Until set, the
+module uses the global log level. */
+#define LOG_LEVEL_INHERIT UINT8_MAX
+
+#if defined(LOG_MODULE)
+static uint8_t __log_module_level__ = LOG_LEVEL_INHERIT;
+#define LOG_LEVEL                                                              \
+    (__log_module_level__ == LOG_LEVEL_INHERIT ? __log_level__                 \
+                                               : __log_module_level__)
+
+#ifdef LOG_BACKEND
+DLL_PUBLIC extern void __log_module_register__(const char* module,
+    uint8_t* level) __attribute__((weak));
+DLL_PUBLIC extern void __log_module_unregister__(uint8_t* level)
+    __attribute__((weak));
+
+__attribute__((constructor)) static void __log_module_init(void)
+{
+    if (__log_module_register__) {
+        __log_module_register__(LOG_MODULE, &__log_module_level__);
+    }
+}
+
+__attribute__((destructor)) static void __log_module_fini(void)
+{
+    if (__log_module_unregister__) {
+        __log_module_unregister__(&__log_module_level__);
+    }
+}
+#endif
+#else
 #define LOG_LEVEL __log_level__
+#endif
 
 
 static inline void __log2console(
@@ -58,8 +112,19 @@ static inline void __log2console(
         LOG_COLOUR_LRED   /* FATAL */
     };
 
-    /* No log if __log_level__ is LOG_QUIET, other than errors. */
-    if (__log_level__ >= LOG_QUIET && level < LOG_QUIET) return;
+    /* No log if the log level is LOG_QUIET, other than errors. */
+    if (LOG_LEVEL >= LOG_QUIET && level < LOG_QUIET) return;
+
+#ifdef LOG_BACKEND
+    /* Logger backend. */
+    if (__log_backend__) {
+        va_start(args, format);
+        int rc = __log_backend__(level, file, line, format, args);
+        va_end(args);
+        errno = errno_save;
+        if (rc == 0) return;
+    }
+#endif
 
     /* PError handling. */
     if (level >= LOG_ERROR && errno_save) {
@@ -93,25 +158,25 @@ static inline void __log2console(
 
 #define log_trace(...)                                                         \
     do {                                                                       \
-        if (LOG_LEVEL <= LOG_TRACE)                                            \
+        if (LOG_LEVEL_MIN <= LOG_TRACE && LOG_LEVEL <= LOG_TRACE)              \
             __log2console(LOG_TRACE, __func__, __LINE__, __VA_ARGS__);         \
     } while (0)
 
 #define log_debug(...)                                                         \
     do {                                                                       \
-        if (LOG_LEVEL <= LOG_DEBUG)                                            \
+        if (LOG_LEVEL_MIN <= LOG_DEBUG && LOG_LEVEL <= LOG_DEBUG)              \
             __log2console(LOG_DEBUG, __func__, __LINE__, __VA_ARGS__);         \
     } while (0)
 
 #define log_info(...)                                                          \
     do {                                                                       \
-        if (LOG_LEVEL <= LOG_INFO)                                             \
+        if (LOG_LEVEL_MIN <= LOG_INFO && LOG_LEVEL <= LOG_INFO)                \
             __log2console(LOG_INFO, __func__, __LINE__, __VA_ARGS__);          \
     } while (0)
 
 #define log_simbus(...)                                                        \
     do {                                                                       \
-        if (LOG_LEVEL <= LOG_SIMBUS)                                           \
+        if (LOG_LEVEL_MIN <= LOG_SIMBUS && LOG_LEVEL <= LOG_SIMBUS)            \
             __log2console(LOG_SIMBUS, __func__, __LINE__, __VA_ARGS__);        \
     } while (0)
 
@@ -5,6 +5,7 @@
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/clib/collections/set.h>
+#include <dse/clib/util/strings.h>
 #include <dse/clib/data/marshal.h>
 
 
@@ -554,6 +555,71 @@ typedef struct SM_TC {
     } expect;
 } SM_TC;
 
+void test_marshal_group__codec(void** state)
+{
+    UNUSED(state);
+
+    const char* codec_names[] = { "ascii85", "base64", "z85" };
+    const char  data[] = "foo\0bar";
+    uint32_t    data_len = sizeof(data);
+
+    for (size_t c = 0; c < ARRAY_SIZE(codec_names); c++) {
+        const DseTextCodec* codec = dse_text_codec_find(codec_names[c]);
+        assert_non_null(codec);
+        void*         binary[3] = { NULL };
+        uint32_t      binary_len[3] = { 0 };
+        MarshalGroup* mg_table = calloc(2, sizeof(MarshalGroup));
+        MarshalGroup* mg = &mg_table[0];
+        mg->name = strdup("MG");
+        mg->kind = MARSHAL_KIND_BINARY;
+        mg->type = MARSHAL_TYPE_STRING;
+        mg->dir = MARSHAL_DIRECTION_TXRX;
+        mg->count = 2;
+        mg->source.offset = 1;
+        mg->source.binary = binary;
+        mg->source.binary_len = binary_len;
+        mg->target.ptr = calloc(mg->count, sizeof(void*));
+        mg->target._binary_len = calloc(mg->count, sizeof(uint32_t));
+        assert_int_equal(marshal_group_set_codec(NULL, NULL, NULL), EINVAL);
+        /* Only string groups have a codec. */
+        mg->type = MARSHAL_TYPE_BINARY;
+        assert_int_equal(
+            marshal_group_set_codec(mg, codec->encode, codec->decode), EINVAL);
+        assert_null(mg->functions.string_encode);
+        mg->type = MARSHAL_TYPE_STRING;
+        assert_int_equal(
+            marshal_group_set_codec(mg, codec->encode, codec->decode), 0);
+
+        /* Source -> target, encoded with the codec. */
+        for (size_t i = 0; i < mg->count; i++) {
+            binary[1 + i] = malloc(data_len);
+            memcpy(binary[1 + i], data, data_len);
+            binary_len[1 + i] = data_len;
+        }
+        marshal_group_out(mg_table);
+        char* expect = codec->encode(data, data_len);
+        for (size_t i = 0; i < mg->count; i++) {
+            assert_non_null(mg->target._string[i]);
+            assert_string_equal(mg->target._string[i], expect);
+            free(binary[1 + i]);
+            binary[1 + i] = NULL;
+            binary_len[1 + i] = 0;
+        }
+        free(expect);
+
+        /* Target -> source, decoded with the codec. */
+        marshal_group_in(mg_table);
+        for (size_t i = 0; i < mg->count; i++) {
+            assert_non_null(binary[1 + i]);
+            assert_int_equal(binary_len[1 + i], data_len);
+            assert_memory_equal(binary[1 + i], data, data_len);
+        }
+
+        marshal_group_destroy(mg_table);
+    }
+}
+
+
 void test_marshal__signalmap_generate(void** state)
 {
     UNUSED(state);
@@ -1076,6 +1142,99 @@ void test_marshal__signalmap_binary_in(void** state)
 }
 
 
+void test_marshal__stats(void** state)
+{
+    UNUSED(state);
+
+    double   source_scalar[4] = { 1.0, 2.0, 3.0, 4.0 };
+    double   signal_scalar[4] = { 0 };
+    size_t   signal_idx[4] = { 0, 1, 2, 3 };
+    size_t   source_idx[4] = { 3, 2, 1, 0 };
+    uint8_t  binary_data[] = { 1, 2, 3, 4, 5, 6 };
+    uint32_t source_binary_len[2] = { sizeof(binary_data), 0 };
+
+    marshal_stats_mode(MARSHAL_STATS_ENABLED);
+
+    /* Group with primitive and binary members. */
+    MarshalGroup* mg_table = calloc(3, sizeof(MarshalGroup));
+    mg_table[0].name = strdup("primitive");
+    mg_table[0].kind = MARSHAL_KIND_PRIMITIVE;
+    mg_table[0].dir = MARSHAL_DIRECTION_TXRX;
+    mg_table[0].type = MARSHAL_TYPE_DOUBLE;
+    mg_table[0].count = 4;
+    mg_table[0].source.scalar = source_scalar;
+    mg_table[0].target.ptr = calloc(4, sizeof(double));
+    mg_table[1].name = strdup("binary");
+    mg_table[1].kind = MARSHAL_KIND_BINARY;
+    mg_table[1].dir = MARSHAL_DIRECTION_TXONLY;
+    mg_table[1].type = MARSHAL_TYPE_BINARY;
+    mg_table[1].count = 2;
+    mg_table[1].source.binary = calloc(2, sizeof(void*));
+    mg_table[1].source.binary_len = source_binary_len;
+    mg_table[1].source.binary[0] = malloc(sizeof(binary_data));
+    memcpy(mg_table[1].source.binary[0], binary_data, sizeof(binary_data));
+    mg_table[1].target.ptr = calloc(2, sizeof(void*));
+    mg_table[1].target._binary_len = calloc(2, sizeof(uint32_t));
+
+    marshal_group_out(mg_table);
+    marshal_group_out(mg_table);
+    marshal_group_in(mg_table);
+
+    const MarshalStats* stats = marshal_group_stats(&mg_table[0]);
+    assert_non_null(stats);
+    assert_int_equal(stats->out.calls, 2);
+    assert_int_equal(stats->out.elements, 8);
+    assert_int_equal(stats->out.bytes, 8 * sizeof(double));
+    assert_int_equal(stats->out.allocs, 0);
+    assert_int_equal(stats->in.calls, 1);
+    assert_int_equal(stats->in.elements, 4);
+    stats = marshal_group_stats(&mg_table[1]);
+    assert_non_null(stats);
+    assert_int_equal(stats->out.calls, 2);
+    assert_int_equal(stats->out.elements, 4);
+    assert_int_equal(stats->out.bytes, 2 * sizeof(binary_data));
+    assert_int_equal(stats->out.allocs, 2);
+    assert_int_equal(stats->in.calls, 0);
+    void** source_binary_storage = mg_table[1].source.binary;
+    marshal_group_destroy(mg_table);
+    free(source_binary_storage);
+
+    /* Signal map. */
+    MarshalSignalMap* msm = calloc(2, sizeof(MarshalSignalMap));
+    msm[0].name = (char*)"scalar";
+    msm[0].count = 4;
+    msm[0].signal.index = calloc(4, sizeof(size_t));
+    msm[0].signal.scalar = signal_scalar;
+    msm[0].source.index = calloc(4, sizeof(size_t));
+    msm[0].source.scalar = source_scalar;
+    memcpy(msm[0].signal.index, signal_idx, sizeof(signal_idx));
+    memcpy(msm[0].source.index, source_idx, sizeof(source_idx));
+    marshal_signalmap_in(msm);
+    assert_double_equal(signal_scalar[0], 4.0, 0.0);
+    stats = marshal_signalmap_stats(&msm[0]);
+    assert_non_null(stats);
+    assert_int_equal(stats->out.calls, 0);
+    assert_int_equal(stats->in.calls, 1);
+    assert_int_equal(stats->in.elements, 4);
+    assert_int_equal(stats->in.bytes, 4 * sizeof(double));
+    marshal_signalmap_destroy(msm);
+
+    /* Disabled, no statistics are collected. */
+    marshal_stats_mode(MARSHAL_STATS_DISABLED);
+    MarshalGroup mg[2] = { {
+        .name = (char*)"primitive",
+        .kind = MARSHAL_KIND_PRIMITIVE,
+        .dir = MARSHAL_DIRECTION_TXRX,
+        .type = MARSHAL_TYPE_DOUBLE,
+        .count = 4,
+        .source.scalar = source_scalar,
+        .target._double = signal_scalar,
+    } };
+    marshal_group_out(mg);
+    assert_null(marshal_group_stats(&mg[0]));
+}
+
+
 int run_marshal_tests(void)
 {
     void* s = test_setup;
@@ -1085,6 +1244,7 @@ int run_marshal_tests(void)
         cmocka_unit_test_setup_teardown(test_marshal__type_size, s, t),
         cmocka_unit_test_setup_teardown(test_marshal_group__primitive, s, t),
         cmocka_unit_test_setup_teardown(test_marshal_group__binary, s, t),
+        cmocka_unit_test_setup_teardown(test_marshal_group__codec, s, t),
         cmocka_unit_test_setup_teardown(test_marshal__signalmap_generate, s, t),
         cmocka_unit_test_setup_teardown(
             test_marshal__signalmap_scalar_out, s, t),
@@ -1094,6 +1254,7 @@ int run_marshal_tests(void)
             test_marshal__signalmap_binary_out, s, t),
         cmocka_unit_test_setup_teardown(
             test_marshal__signalmap_binary_in, s, t),
+        cmocka_unit_test_setup_teardown(test_marshal__stats, s, t),
     };
 
     return cmocka_run_group_tests_name("MARSHAL", tests, NULL, NULL);
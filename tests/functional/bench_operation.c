@@ -0,0 +1,150 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <dse/logger.h>
+#include <dse/clib/collections/hashlist.h>
+#include <dse/clib/util/threadpool.h>
+#include <dse/clib/functional/functor.h>
+
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+#define ELEMENTS      100000
+#define REPEAT        5
+#define THREADS       4
+
+
+/**
+Functional Operation Benchmark
+==============================
+
+Measures an operation (array -> map stages -> fold to array) over an array
+of 100k elements, with a varying number of map stages, for the standard
+operation (a HashList per map stage) and the fused operation (elements are
+passed through the map stages directly to the fold), each sequential and in
+parallel (on a thread pool). Each scenario reports the best of several runs,
+and the speedup of each mode relative to the standard operation.
+
+Run with:
+
+    $ make -C tests build bench
+*/
+
+
+uint8_t __log_level__ = LOG_QUIET;
+
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+static FunctorType int_scale(void* object, void* reference)
+{
+    int* item = malloc(sizeof(int));
+    *item = *(int*)object * 3 + *(int*)reference;
+    return functor(int, item,
+        &(FunctorType){
+            .destroy = free,
+        });
+}
+
+
+static FunctorType int_odd(void* object, void* reference)
+{
+    (void)reference;
+    if ((*(int*)object & 1) == 0) return nil_functor();
+    int* item = malloc(sizeof(int));
+    *item = *(int*)object;
+    return functor(int, item,
+        &(FunctorType){
+            .destroy = free,
+        });
+}
+
+
+static uint64_t run(int* a, uint32_t flags, DseThreadPool* pool,
+    size_t stages, size_t* count)
+{
+    int         offset = 1;
+    FunctorType object = functor(int, a,
+        &(FunctorType){
+            .count = ELEMENTS,
+            .map = functional_map_array,
+            .fold = functional_fold_array,
+            .flags = flags,
+            .pool = pool,
+        });
+    FunctorType result = { 0 };
+    uint64_t    t = now_ns();
+    switch (stages) {
+    case 1:
+        result = operation(&object, &offset, int_scale);
+        break;
+    case 2:
+        result = operation(&object, &offset, int_scale, int_odd);
+        break;
+    case 4:
+        result = operation(
+            &object, &offset, int_scale, int_scale, int_odd, int_scale);
+        break;
+    default:
+        break;
+    }
+    t = now_ns() - t;
+    *count = result.count;
+    free(result.__object__);
+    return t;
+}
+
+
+int main(void)
+{
+    int* a = malloc(ELEMENTS * sizeof(int));
+    for (int i = 0; i < ELEMENTS; i++) {
+        a[i] = i;
+    }
+
+    DseThreadPool* pool = dse_threadpool_create(THREADS);
+    struct {
+        const char* mode;
+        uint32_t    flags;
+    } mode[] = {
+        { "standard", 0 },
+        { "fused", FUNCTOR_FUSED },
+        { "parallel", FUNCTOR_PARALLEL },
+        { "par_fused", FUNCTOR_PARALLEL | FUNCTOR_FUSED },
+    };
+
+    printf("%-10s %-10s %10s %10s %10s %8s\n", "scenario", "mode", "elements",
+        "result", "ms", "speedup");
+    size_t stages[] = { 1, 2, 4 };
+    for (size_t s = 0; s < ARRAY_SIZE(stages); s++) {
+        char scenario[16];
+        snprintf(scenario, sizeof(scenario), "map_x%zu", stages[s]);
+        uint64_t standard = 0;
+        for (size_t m = 0; m < ARRAY_SIZE(mode); m++) {
+            uint64_t best = UINT64_MAX;
+            size_t   count = 0;
+            for (int r = 0; r < REPEAT; r++) {
+                uint64_t t = run(a, mode[m].flags, pool, stages[s], &count);
+                if (t < best) best = t;
+            }
+            if (m == 0) standard = best;
+            printf("%-10s %-10s %10d %10zu %10.3f %8.2f\n", scenario,
+                mode[m].mode, ELEMENTS, count, best / 1e6,
+                (double)standard / best);
+        }
+    }
+
+    dse_threadpool_destroy(pool);
+    free(a);
+    return 0;
+}
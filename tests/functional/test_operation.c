@@ -3,9 +3,12 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/clib/collections/hashlist.h>
+#include <dse/clib/util/threadpool.h>
 #include <dse/clib/functional/functor.h>
 
 
@@ -505,6 +508,271 @@ void test_functor__map_treeflatten(void** state)
 }
 
 
+// Fused operations (without intermediate HashLists).
+FunctorType int_inc(void* object, void* reference)
+{
+    int* count = reference;
+    int* item = malloc(sizeof(int));
+    *item = *(int*)object + 1;
+    (*count)++;
+    return functor(int, item,
+        &(FunctorType){
+            .destroy = free,
+        });
+}
+void test_functor__fused(void** state)
+{
+    UNUSED(state);
+    int a[1000];
+    for (size_t i = 0; i < ARRAY_SIZE(a); i++) {
+        a[i] = i;
+    }
+    {
+        /* Same result as the non-fused operation. */
+        FunctorType result[2];
+        int         calls[2] = { 0 };
+        for (int i = 0; i < 2; i++) {
+            FunctorType object = functor(int, a,
+                &(FunctorType){
+                    .count = ARRAY_SIZE(a),
+                    .map = functional_map_array,
+                    .fold = functional_fold_array,
+                    .flags = i ? FUNCTOR_FUSED : 0,
+                });
+            result[i] = operation(
+                &object, &calls[i], int_double, drop_even, int_inc, int_inc);
+        }
+        assert_int_equal(result[1].count, result[0].count);
+        assert_int_equal(calls[1], calls[0]);
+        assert_memory_equal(result[1].__object__, result[0].__object__,
+            result[0].count * sizeof(int));
+        free(result[0].__object__);
+        free(result[1].__object__);
+    }
+    {
+        int         b[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+        FunctorType object = functor(int, b,
+            &(FunctorType){
+                .count = ARRAY_SIZE(b),
+                .map = functional_map_array,
+                .fold = functional_fold_array,
+                .flags = FUNCTOR_FUSED,
+            });
+        FunctorType result = operation(&object, NULL, int_double, drop_even);
+        assert_int_equal(result.count, 0);
+        free(result.__object__);
+        result = operation(&object, NULL, drop_even, int_double);
+        assert_int_equal(result.count, 4);
+        int* r_a = result.__object__;
+        assert_int_equal(r_a[0], 2);
+        assert_int_equal(r_a[3], 14);
+        free(result.__object__);
+    }
+    {
+        const char* s[] = { "one", "two", "three", NULL };
+        FunctorType object = functor(char*, s,
+            &(FunctorType){
+                .map = functional_map_ntlist,
+                .fold = functional_fold_ntlist,
+                .flags = FUNCTOR_FUSED,
+            });
+        FunctorType result = operation(&object, NULL, str_rev, str_rev);
+        assert_int_equal(result.count, 3);
+        char** r_a = result.__object__;
+        assert_string_equal(r_a[0], "one");
+        assert_string_equal(r_a[1], "two");
+        assert_string_equal(r_a[2], "three");
+        assert_null(r_a[3]);
+        free(r_a[0]);
+        free(r_a[1]);
+        free(r_a[2]);
+        free(r_a);
+    }
+    {
+        HashList list;
+        hashlist_init(&list, 10);
+        hashlist_append(&list, (void*)"one");
+        hashlist_append(&list, (void*)"two");
+        FunctorType object = functor(char*, &list,
+            &(FunctorType){
+                .map = functional_map_hashlist,
+                .flags = FUNCTOR_FUSED,
+            });
+        FunctorType result = operation(&object, NULL, str_dbl);
+        HashList*   r_l = result.__object__;
+        assert_int_equal(hashlist_length(r_l), 2);
+        assert_string_equal(hashlist_at(r_l, 0), "oneone");
+        assert_string_equal(hashlist_at(r_l, 1), "twotwo");
+        free(hashlist_at(r_l, 0));
+        free(hashlist_at(r_l, 1));
+        hashlist_destroy(r_l);
+        free(r_l);
+        hashlist_destroy(&list);
+    }
+    {
+        /* Flatten (ntlist map returning a HashList). */
+        Thistle t[] = {
+            { .thorn = "one",
+                .thistles = (Thistle[]){ { .thorn = "two" }, {} } },
+            { .thorn = "three" },
+            {},
+        };
+        HashList list;
+        hashlist_init(&list, 10);
+        FunctorType object = functor(Thistle, t,
+            &(FunctorType){
+                .map = functional_map_ntlist,
+                .flags = FUNCTOR_FUSED,
+            });
+        FunctorType result =
+            operation(&object, &list, parse_thistle, handle_thistle);
+        assert_int_equal(hashlist_length(result.__object__), 0);
+        assert_int_equal(hashlist_length(&list), 3);
+        assert_string_equal(hashlist_at(&list, 0), "one");
+        assert_string_equal(hashlist_at(&list, 1), "two");
+        assert_string_equal(hashlist_at(&list, 2), "three");
+        hashlist_destroy(result.__object__);
+        free(result.__object__);
+        hashlist_destroy(&list);
+    }
+}
+
+
+// Parallel map (order preserved).
+typedef struct ThreadCheck {
+    pthread_t thread;
+    size_t    other; /* Calls on other threads. */
+} ThreadCheck;
+FunctorType int_triple(void* object, void* reference)
+{
+    ThreadCheck* check = reference;
+    if (!pthread_equal(pthread_self(), check->thread)) {
+        __atomic_fetch_add(&check->other, 1, __ATOMIC_RELAXED);
+    }
+    int* item = malloc(sizeof(int));
+    *item = *(int*)object * 3;
+    return functor(int, item,
+        &(FunctorType){
+            .destroy = free,
+        });
+}
+void test_functor__parallel(void** state)
+{
+    UNUSED(state);
+    DseThreadPool* pool = dse_threadpool_create(4);
+    int            a[5000];
+    for (size_t i = 0; i < ARRAY_SIZE(a); i++) {
+        a[i] = i;
+    }
+
+    uint32_t flags[] = { FUNCTOR_PARALLEL, FUNCTOR_PARALLEL | FUNCTOR_FUSED };
+    for (size_t f = 0; f < ARRAY_SIZE(flags); f++) {
+        ThreadCheck check = { .thread = pthread_self() };
+        FunctorType object = functor(int, a,
+            &(FunctorType){
+                .count = ARRAY_SIZE(a),
+                .map = functional_map_array,
+                .fold = functional_fold_array,
+                .flags = flags[f],
+                .pool = pool,
+            });
+        FunctorType result =
+            operation(&object, &check, int_triple, drop_even, int_triple);
+        assert_int_equal(result.count, ARRAY_SIZE(a) / 2);
+#ifdef FUNCTIONAL_PARALLEL
+        /* Without parallel.c (weak references) the operation is sequential. */
+        if (functional_parallel_chunks == NULL) {
+            assert_int_equal(check.other, 0);
+        }
+#endif
+        int* r_a = result.__object__;
+        for (size_t i = 0; i < result.count; i++) {
+            assert_int_equal(r_a[i], (i * 2 + 1) * 9);
+        }
+        free(result.__object__);
+
+        /* Below the threshold, sequential (on the calling thread). */
+        check.other = 0;
+        object.count = 100;
+        result = operation(&object, &check, int_triple);
+        assert_int_equal(result.count, 100);
+        assert_int_equal(check.other, 0);
+        free(result.__object__);
+
+        /* Without a fold. */
+        object.count = ARRAY_SIZE(a);
+        object.threshold = 10;
+        object.fold = NULL;
+        result = operation(&object, &check, int_triple);
+        HashList* r_l = result.__object__;
+        assert_int_equal(hashlist_length(r_l), ARRAY_SIZE(a));
+        for (size_t i = 0; i < hashlist_length(r_l); i++) {
+            assert_int_equal(*(int*)hashlist_at(r_l, i), i * 3);
+            free(hashlist_at(r_l, i));
+        }
+        hashlist_destroy(r_l);
+        free(r_l);
+    }
+
+    dse_threadpool_destroy(pool);
+}
+
+
+// Parallel map on a shared pool.
+static void blocked_job(void* arg)
+{
+    int* release = arg;
+    __atomic_store_n(release, 1, __ATOMIC_RELEASE);
+    while (__atomic_load_n(release, __ATOMIC_ACQUIRE) == 1) sched_yield();
+}
+void test_functor__parallel_shared(void** state)
+{
+    UNUSED(state);
+    int a[2000];
+    for (size_t i = 0; i < ARRAY_SIZE(a); i++) {
+        a[i] = i;
+    }
+
+    /* The operation only waits for its own jobs (a job of another user of
+    the pool is blocked until the operation completes). A pool without
+    workers runs all jobs on the calling thread. */
+    size_t threads[] = { 2, 0 };
+    for (size_t t = 0; t < ARRAY_SIZE(threads); t++) {
+        DseThreadPool* pool = dse_threadpool_create(threads[t]);
+        int            release = 0;
+        if (threads[t]) {
+            /* Running on a worker (i.e. no longer queued). */
+            dse_threadpool_submit(pool, blocked_job, &release);
+            while (__atomic_load_n(&release, __ATOMIC_ACQUIRE) == 0) {
+                sched_yield();
+            }
+        }
+
+        ThreadCheck check = { .thread = pthread_self() };
+        FunctorType object = functor(int, a,
+            &(FunctorType){
+                .count = ARRAY_SIZE(a),
+                .map = functional_map_array,
+                .fold = functional_fold_array,
+                .flags = FUNCTOR_PARALLEL,
+                .pool = pool,
+                .threshold = 10,
+            });
+        FunctorType result = operation(&object, &check, int_triple);
+        assert_int_equal(result.count, ARRAY_SIZE(a));
+        int* r_a = result.__object__;
+        for (size_t i = 0; i < result.count; i++) {
+            assert_int_equal(r_a[i], i * 3);
+        }
+        free(result.__object__);
+        if (threads[t] == 0) assert_int_equal(check.other, 0);
+
+        __atomic_store_n(&release, 2, __ATOMIC_RELEASE);
+        dse_threadpool_destroy(pool);
+    }
+}
+
+
 int run_operation_tests(void)
 {
     void* s = test_setup;
@@ -519,6 +787,9 @@ int run_operation_tests(void)
         cmocka_unit_test_setup_teardown(test_functor__filter_ntlist, s, t),
         cmocka_unit_test_setup_teardown(test_functor__map_ntlist_call, s, t),
         cmocka_unit_test_setup_teardown(test_functor__map_treeflatten, s, t),
+        cmocka_unit_test_setup_teardown(test_functor__fused, s, t),
+        cmocka_unit_test_setup_teardown(test_functor__parallel, s, t),
+        cmocka_unit_test_setup_teardown(test_functor__parallel_shared, s, t),
     };
 
     return cmocka_run_group_tests_name("OPERATION", tests, NULL, NULL);
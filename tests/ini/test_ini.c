@@ -3,6 +3,9 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/clib/ini/ini.h>
@@ -57,6 +60,224 @@ void test__ini(void** state)
     ini_close(&ini);
 }
 
+void test__ini_index(void** state)
+{
+    UNUSED(state);
+
+    char path[] = "/tmp/test_ini_XXXXXX";
+    int  fd = mkstemp(path);
+    assert_true(fd >= 0);
+    FILE* f = fdopen(fd, "w");
+    fprintf(f, "# comment\n  first=1\ndup=a\n");
+    for (int i = 0; i < 1000; i++) {
+        fprintf(f, "key%d=%d\n", i, i);
+    }
+    fprintf(f, "dup=b\nlast=2\n");
+    fclose(f);
+
+    IniDesc ini = ini_open(path);
+    assert_string_equal(ini_get_val(&ini, "first"), "1");
+    assert_string_equal(ini_get_val(&ini, "key500"), "500");
+    assert_string_equal(ini_get_val(&ini, "key999"), "999");
+    assert_null(ini_get_val(&ini, "key1000"));
+    assert_null(ini_get_val(&ini, "key"));
+
+    /* Duplicate keys, the first line is used until deleted. */
+    assert_string_equal(ini_get_val(&ini, "dup"), "a");
+    ini_delete_key(&ini, "dup");
+    assert_string_equal(ini_get_val(&ini, "dup"), "b");
+    ini_delete_key(&ini, "dup");
+    assert_null(ini_get_val(&ini, "dup"));
+
+    /* Delete most keys (tombstones are compacted), and update others. */
+    for (int i = 0; i < 1000; i++) {
+        char key[20];
+        snprintf(key, sizeof(key), "key%d", i);
+        if (i % 10) {
+            ini_delete_key(&ini, key);
+        } else {
+            ini_set_val(&ini, key, "x", true);
+        }
+    }
+    ini_set_val(&ini, "new", "3", false);
+    assert_null(ini_get_val(&ini, "key1"));
+    assert_string_equal(ini_get_val(&ini, "key990"), "x");
+    assert_string_equal(ini_get_val(&ini, "last"), "2");
+    assert_string_equal(ini_get_val(&ini, "new"), "3");
+
+    /* Line order is preserved. */
+    ini_write(&ini, path);
+    ini_close(&ini);
+    f = fopen(path, "r");
+    char line[100];
+    assert_non_null(fgets(line, sizeof(line), f));
+    assert_string_equal(line, "first=1\n");
+    for (int i = 0; i < 1000; i += 10) {
+        char expect[20];
+        snprintf(expect, sizeof(expect), "key%d=x\n", i);
+        assert_non_null(fgets(line, sizeof(line), f));
+        assert_string_equal(line, expect);
+    }
+    assert_non_null(fgets(line, sizeof(line), f));
+    assert_string_equal(line, "last=2\n");
+    assert_non_null(fgets(line, sizeof(line), f));
+    assert_string_equal(line, "new=3\n");
+    assert_null(fgets(line, sizeof(line), f));
+    fclose(f);
+    unlink(path);
+}
+
+
+void test__ini_sections(void** state)
+{
+    UNUSED(state);
+
+    char path[] = "/tmp/test_ini_XXXXXX";
+    int  fd = mkstemp(path);
+    assert_true(fd >= 0);
+    FILE* f = fdopen(fd, "w");
+    fprintf(f, "root=r\r\n[a]\r\nname=a1\r\nonly_a=x\r\n");
+    fprintf(f, "[b]\r\nname=b1\r\n  [c]\r\nname=${INI_C:-c1}");
+    fclose(f);
+
+    IniDesc     ini = ini_open(path);
+    const char* val = ini_get_section_val(&ini, "a", "name");
+    assert_string_equal(val, "a1");
+#ifndef _WIN32
+    /* Values reference the mapped file (no copy). */
+    assert_non_null(ini.map);
+    assert_true(val >= ini.map && val < ini.map + ini.map_size);
+#endif
+    assert_string_equal(ini_get_section_val(&ini, "b", "name"), "b1");
+    assert_string_equal(ini_get_section_val(&ini, "c", "name"), "${INI_C:-c1}");
+    assert_null(ini_get_section_val(&ini, "b", "only_a"));
+    assert_null(ini_get_section_val(&ini, "d", "name"));
+    /* Without a section, the first line with the key. */
+    assert_string_equal(ini_get_val(&ini, "name"), "a1");
+    assert_string_equal(ini_get_val(&ini, "root"), "r");
+    assert_string_equal(ini_get_section_val(&ini, NULL, "only_a"), "x");
+
+    /* Modify, and add, keys in sections. */
+    ini_set_section_val(&ini, "b", "name", "b2", false);
+    assert_string_equal(ini_get_section_val(&ini, "b", "name"), "b1");
+    ini_set_section_val(&ini, "b", "name", "b2", true);
+    assert_string_equal(ini_get_section_val(&ini, "b", "name"), "b2");
+    ini_set_section_val(&ini, "a", "new", "a3", false);
+    ini_set_section_val(&ini, "d", "name", "d1", false);
+    ini_set_val(&ini, "root2", "r2", false);
+    ini_expand_vars(&ini);
+    assert_string_equal(ini_get_section_val(&ini, "a", "new"), "a3");
+    assert_string_equal(ini_get_section_val(&ini, "c", "name"), "c1");
+    assert_string_equal(ini_get_section_val(&ini, "d", "name"), "d1");
+    assert_string_equal(ini_get_section_val(&ini, "b", "name"), "b2");
+
+    /* Delete keys in sections. */
+    ini_delete_section_key(&ini, "a", "name");
+    assert_null(ini_get_section_val(&ini, "a", "name"));
+    assert_string_equal(ini_get_val(&ini, "name"), "b2");
+    ini_delete_key(&ini, "name");
+    assert_null(ini_get_section_val(&ini, "b", "name"));
+    assert_string_equal(ini_get_val(&ini, "name"), "c1");
+    assert_string_equal(ini_get_section_val(&ini, "c", "name"), "c1");
+
+    ini_write(&ini, path);
+    ini_close(&ini);
+    assert_null(ini.map);
+
+    const char* expect[] = {
+        "root=r\n",
+        "root2=r2\n",
+        "[a]\n",
+        "only_a=x\n",
+        "new=a3\n",
+        "[b]\n",
+        "[c]\n",
+        "name=c1\n",
+        "[d]\n",
+        "name=d1\n",
+    };
+    char line[100];
+    f = fopen(path, "r");
+    for (size_t i = 0; i < ARRAY_SIZE(expect); i++) {
+        assert_non_null(fgets(line, sizeof(line), f));
+        assert_string_equal(line, expect[i]);
+    }
+    assert_null(fgets(line, sizeof(line), f));
+    fclose(f);
+
+    /* Empty file. */
+    f = fopen(path, "w");
+    fclose(f);
+    ini = ini_open(path);
+    assert_null(ini_get_val(&ini, "root"));
+    ini_close(&ini);
+    unlink(path);
+}
+
+
+void test__ini_sections_insert(void** state)
+{
+    UNUSED(state);
+
+    char path[] = "/tmp/test_ini_XXXXXX";
+    int  fd = mkstemp(path);
+    assert_true(fd >= 0);
+    FILE* f = fdopen(fd, "w");
+    fprintf(f, "[a]\nx=1\n[b]\ndup=b\n[c]\nz=3\n");
+    fclose(f);
+
+    IniDesc ini = ini_open(path);
+    assert_string_equal(ini_get_val(&ini, "dup"), "b");
+    /* A key added to an earlier section is the first line with the key. */
+    ini_set_section_val(&ini, "a", "dup", "a", false);
+    assert_string_equal(ini_get_val(&ini, "dup"), "a");
+    assert_string_equal(ini_get_section_val(&ini, "b", "dup"), "b");
+
+    /* Add keys before the first section, and to a section. */
+    for (int i = 0; i < 1000; i++) {
+        char key[20];
+        snprintf(key, sizeof(key), "key%d", i);
+        ini_set_section_val(&ini, "a", key, "a", false);
+        snprintf(key, sizeof(key), "root%d", i);
+        ini_set_val(&ini, key, "r", false);
+    }
+    assert_string_equal(ini_get_section_val(&ini, "a", "key999"), "a");
+    assert_null(ini_get_section_val(&ini, "b", "key999"));
+    ini_delete_section_key(&ini, "a", "dup");
+    assert_string_equal(ini_get_val(&ini, "dup"), "b");
+
+    /* Line order. */
+    ini_write(&ini, path);
+    ini_close(&ini);
+    f = fopen(path, "r");
+    char line[100];
+    char expect[100];
+    for (int i = 0; i < 1000; i++) {
+        snprintf(expect, sizeof(expect), "root%d=r\n", i);
+        assert_non_null(fgets(line, sizeof(line), f));
+        assert_string_equal(line, expect);
+    }
+    const char* a[] = { "[a]\n", "x=1\n" };
+    for (size_t i = 0; i < ARRAY_SIZE(a); i++) {
+        assert_non_null(fgets(line, sizeof(line), f));
+        assert_string_equal(line, a[i]);
+    }
+    for (int i = 0; i < 1000; i++) {
+        snprintf(expect, sizeof(expect), "key%d=a\n", i);
+        assert_non_null(fgets(line, sizeof(line), f));
+        assert_string_equal(line, expect);
+    }
+    const char* b[] = { "[b]\n", "dup=b\n", "[c]\n", "z=3\n" };
+    for (size_t i = 0; i < ARRAY_SIZE(b); i++) {
+        assert_non_null(fgets(line, sizeof(line), f));
+        assert_string_equal(line, b[i]);
+    }
+    assert_null(fgets(line, sizeof(line), f));
+    fclose(f);
+    unlink(path);
+}
+
+
 int run_ini_tests(void)
 {
     void* s = test_setup;
@@ -64,6 +285,9 @@ int run_ini_tests(void)
 
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test__ini, s, t),
+        cmocka_unit_test_setup_teardown(test__ini_index, s, t),
+        cmocka_unit_test_setup_teardown(test__ini_sections, s, t),
+        cmocka_unit_test_setup_teardown(test__ini_sections_insert, s, t),
     };
 
     return cmocka_run_group_tests_name("INI", tests, NULL, NULL);
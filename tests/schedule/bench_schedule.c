@@ -0,0 +1,156 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <dse/logger.h>
+#include <dse/clib/schedule/schedule.h>
+
+
+#define UNUSED(x)     ((void)x)
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+
+/**
+Schedule Benchmark
+==================
+
+Measures `schedule_tick()` throughput and per-call latency for schedules with
+10, 1k and 100k tasks (mixed `schedule_beats`) in each schedule mode, and a
+catch-up scenario where one call spans many beats (for which the latency
+columns report the duration of that single call).
+
+Run with:
+
+    $ make -C tests build bench
+*/
+
+
+uint8_t __log_level__ = LOG_QUIET;
+
+
+static const uint32_t beats[] = { 1, 2, 5, 10, 20, 50, 100, 1000 };
+static uint64_t       exec_count;
+
+
+static void bench_task_exec(ScheduleTask task)
+{
+    UNUSED(task);
+    exec_count++;
+}
+
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+static int compar_u64(const void* a, const void* b)
+{
+    uint64_t l = *(const uint64_t*)a;
+    uint64_t r = *(const uint64_t*)b;
+    return (l > r) - (l < r);
+}
+
+
+static void setup(Schedule* s, size_t tasks, uint32_t flags)
+{
+    *s = (Schedule){ 0 };
+    schedule_configure(s, (ScheduleVTable){ 0 },
+        (ScheduleTaskVTable){ .exec = bench_task_exec }, 0.001, NULL);
+    schedule_set_flags(s, flags);
+    for (size_t i = 0; i < tasks; i++) {
+        /* Any non-NULL task object. */
+        schedule_add(s, (ScheduleTask)(uintptr_t)(i + 1),
+            beats[i % ARRAY_SIZE(beats)]);
+    }
+}
+
+
+static void bench_step(const char* mode, uint32_t flags, size_t tasks,
+    uint32_t steps)
+{
+    Schedule  s;
+    uint64_t* sample = calloc(steps, sizeof(uint64_t));
+    setup(&s, tasks, flags);
+    schedule_tick(&s, 0.0);
+
+    exec_count = 0;
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < steps; i++) {
+        uint64_t t = now_ns();
+        schedule_tick(&s, (i + 1) * 0.001);
+        sample[i] = now_ns() - t;
+    }
+    uint64_t total = now_ns() - t0;
+
+    qsort(sample, steps, sizeof(uint64_t), compar_u64);
+    printf("%-8s %-22s %8zu %8u %12.0f %10" PRIu64 " %10" PRIu64
+           " %10" PRIu64 " %12" PRIu64 "\n",
+        "step", mode, tasks, steps, steps / (total / 1e9), sample[steps / 2],
+        sample[(steps * 99) / 100], sample[steps - 1], exec_count);
+
+    schedule_destroy(&s);
+    free(sample);
+}
+
+
+static void bench_catchup(
+    const char* mode, uint32_t flags, size_t tasks, uint32_t steps)
+{
+    Schedule s;
+    setup(&s, tasks, flags);
+    schedule_tick(&s, 0.0);
+
+    exec_count = 0;
+    uint64_t t0 = now_ns();
+    schedule_tick(&s, steps * 0.001);
+    uint64_t total = now_ns() - t0;
+
+    printf("%-8s %-22s %8zu %8u %12.0f %10" PRIu64 " %10s %10s %12" PRIu64
+           "\n",
+        "catchup", mode, tasks, s.tick, s.tick / (total / 1e9), total, "-",
+        "-", exec_count);
+
+    schedule_destroy(&s);
+}
+
+
+int main(void)
+{
+    struct {
+        const char* name;
+        uint32_t    flags;
+    } mode[] = {
+        { "default", SCHEDULE_FLAG_NONE },
+        { "eventq", SCHEDULE_FLAG_EVENTQ },
+        { "integer", SCHEDULE_FLAG_INTEGER_TIME },
+        { "integer+skip", SCHEDULE_FLAG_INTEGER_TIME |
+                              SCHEDULE_FLAG_CATCHUP_SKIP },
+        { "eventq+integer+skip", SCHEDULE_FLAG_EVENTQ |
+                                     SCHEDULE_FLAG_INTEGER_TIME |
+                                     SCHEDULE_FLAG_CATCHUP_SKIP },
+    };
+    size_t tasks[] = { 10, 1000, 100000 };
+
+    printf("%-8s %-22s %8s %8s %12s %10s %10s %10s %12s\n", "scenario", "mode",
+        "tasks", "beats", "beats/s", "p50_ns", "p99_ns", "max_ns", "execs");
+    for (size_t t = 0; t < ARRAY_SIZE(tasks); t++) {
+        /* Keep the work per scenario roughly constant. */
+        uint32_t steps = (tasks[t] >= 100000) ? 200 : 2000;
+        for (size_t m = 0; m < ARRAY_SIZE(mode); m++) {
+            bench_step(mode[m].name, mode[m].flags, tasks[t], steps);
+        }
+        for (size_t m = 0; m < ARRAY_SIZE(mode); m++) {
+            bench_catchup(mode[m].name, mode[m].flags, tasks[t], steps * 5);
+        }
+    }
+
+    return 0;
+}
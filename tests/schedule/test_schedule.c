@@ -3,8 +3,10 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <math.h>
+#include <sched.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
+#include <dse/clib/util/threadpool.h>
 #include <dse/clib/schedule/schedule.h>
 
 
@@ -322,6 +324,530 @@ void test_schedule__beat(void** state)
 }
 
 
+typedef struct TraceTask {
+    uint32_t id;
+    uint32_t beats;
+} TraceTask;
+
+uint32_t  trace[1000];
+size_t    trace_count;
+Schedule* trace_schedule;
+
+void trace_task_exec(ScheduleTask task)
+{
+    TraceTask* t = task;
+    if (trace_count < ARRAY_SIZE(trace)) {
+        /* Record both the tick and the task, so ordering is checked. */
+        trace[trace_count++] = (trace_schedule->tick << 8) | t->id;
+    }
+}
+
+static size_t _run_trace(uint32_t flags, uint32_t switch_flags_at_tick,
+    bool add_late, size_t fillers, uint32_t* out, size_t out_len)
+{
+    static TraceTask tasks[] = {
+        { 1, 0 }, { 2, 3 }, { 3, 1 }, { 4, 7 }, { 5, 3 }, { 6, 2 }, { 7, 10 },
+    };
+    static TraceTask late = { 8, 4 };
+    static TraceTask filler[100];
+
+    Schedule s = { 0 };
+    schedule_configure(&s, (ScheduleVTable){ .marshal_out = marshal_out },
+        (ScheduleTaskVTable){ .exec = trace_task_exec }, 0.001, NULL);
+    schedule_set_flags(&s, flags);
+    trace_schedule = &s;
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++) {
+        schedule_add(&s, &tasks[i], tasks[i].beats);
+    }
+    /* Tasks which are not due (each in its own bucket), so that few tasks are
+       due on each tick. */
+    assert_true(fillers <= ARRAY_SIZE(filler));
+    for (size_t i = 0; i < fillers; i++) {
+        filler[i] = (TraceTask){ 9, 1000 + i };
+        schedule_add(&s, &filler[i], filler[i].beats);
+    }
+
+    trace_count = 0;
+    counter_marshal_out = 0;
+    for (double t = 0; t <= 0.03001; t += 0.0005) {
+        if (s.tick == switch_flags_at_tick) {
+            schedule_set_flags(&s, flags ^ SCHEDULE_FLAG_EVENTQ);
+        }
+        if (add_late && s.tick == 13 &&
+            s.count == ARRAY_SIZE(tasks) + fillers) {
+            schedule_add(&s, &late, late.beats);
+        }
+        schedule_tick(&s, t);
+    }
+    assert_int_equal(s.tick, 30);
+    schedule_destroy(&s);
+    assert_null(s.eventq.heap);
+
+    assert_true(trace_count <= out_len);
+    memcpy(out, trace, trace_count * sizeof(uint32_t));
+    /* Marshal out is only called on ticks where schedule_will_alarm(). */
+    return trace_count + (counter_marshal_out << 16);
+}
+
+void test_schedule__eventq(void** state)
+{
+    UNUSED(state);
+
+    uint32_t ref[ARRAY_SIZE(trace)];
+    uint32_t got[ARRAY_SIZE(trace)];
+    size_t   ref_count, got_count;
+
+    /* With fillers the due buckets are merged, without fillers many tasks
+       are due on a tick and the list is scanned. */
+    struct {
+        uint32_t switch_at;
+        bool     add_late;
+        size_t   fillers;
+    } tc[] = {
+        { UINT32_MAX, false, 100 },
+        { UINT32_MAX, true, 100 },
+        { 0, false, 100 },
+        { 6, true, 100 },
+        { 13, true, 100 },
+        { 21, false, 100 },
+        { UINT32_MAX, false, 0 },
+        { UINT32_MAX, true, 0 },
+        { 6, true, 0 },
+        { 13, true, 0 },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(tc); i++) {
+        /* Reference, the default mode. */
+        ref_count = _run_trace(SCHEDULE_FLAG_NONE, UINT32_MAX, tc[i].add_late,
+            tc[i].fillers, ref, ARRAY_SIZE(ref));
+        assert_true((ref_count & 0xffff) > 30);
+
+        /* Event queue mode, optionally switching modes during the run. */
+        got_count = _run_trace(SCHEDULE_FLAG_EVENTQ, tc[i].switch_at,
+            tc[i].add_late, tc[i].fillers, got, ARRAY_SIZE(got));
+        assert_int_equal(got_count, ref_count);
+        assert_memory_equal(got, ref, (ref_count & 0xffff) * sizeof(uint32_t));
+
+        /* Default mode switching to event queue during the run. */
+        got_count = _run_trace(SCHEDULE_FLAG_NONE, tc[i].switch_at,
+            tc[i].add_late, tc[i].fillers, got, ARRAY_SIZE(got));
+        assert_int_equal(got_count, ref_count);
+        assert_memory_equal(got, ref, (ref_count & 0xffff) * sizeof(uint32_t));
+    }
+}
+
+
+static size_t _run_same_period(uint32_t flags, uint32_t* out, size_t out_len)
+{
+    static TraceTask a = { 1, 2 };
+    static TraceTask b = { 2, 2 };
+
+    Schedule s = { 0 };
+    schedule_configure(&s, (ScheduleVTable){ 0 },
+        (ScheduleTaskVTable){ .exec = trace_task_exec }, 0.001, NULL);
+    schedule_set_flags(&s, flags);
+    trace_schedule = &s;
+    schedule_add(&s, &a, a.beats);
+
+    trace_count = 0;
+    schedule_tick(&s, 0.0);
+    schedule_tick(&s, 0.001);
+    /* Same period and phase as a, which is due on the next tick. */
+    schedule_add(&s, &b, b.beats);
+    for (int i = 2; i <= 10; i++) {
+        schedule_tick(&s, i * 0.001);
+    }
+    assert_int_equal(s.tick, 10);
+    schedule_destroy(&s);
+
+    assert_true(trace_count <= out_len);
+    memcpy(out, trace, trace_count * sizeof(uint32_t));
+    return trace_count;
+}
+
+void test_schedule__eventq_same_period(void** state)
+{
+    UNUSED(state);
+
+    uint32_t ref[ARRAY_SIZE(trace)];
+    uint32_t got[ARRAY_SIZE(trace)];
+    size_t   ref_count =
+        _run_same_period(SCHEDULE_FLAG_NONE, ref, ARRAY_SIZE(ref));
+    uint32_t expect[] = {
+        (2 << 8) | 1,
+        (4 << 8) | 1,
+        (4 << 8) | 2,
+        (6 << 8) | 1,
+        (6 << 8) | 2,
+        (8 << 8) | 1,
+        (8 << 8) | 2,
+        (10 << 8) | 1,
+        (10 << 8) | 2,
+    };
+    assert_int_equal(ref_count, ARRAY_SIZE(expect));
+    assert_memory_equal(ref, expect, sizeof(expect));
+
+    size_t got_count =
+        _run_same_period(SCHEDULE_FLAG_EVENTQ, got, ARRAY_SIZE(got));
+    assert_int_equal(got_count, ref_count);
+    assert_memory_equal(got, ref, ref_count * sizeof(uint32_t));
+}
+
+
+typedef struct ParTask {
+    uint32_t group;
+    uint32_t beats;
+    uint32_t position; /* Position of the task within its group. */
+    size_t   count;
+} ParTask;
+
+Schedule* par_schedule;
+uint32_t  par_untagged_tick;
+uint32_t  par_group_seq[4];
+uint32_t  par_errors;
+
+void par_task_exec(ScheduleTask task)
+{
+    ParTask* t = task;
+    t->count++;
+    if (t->group == 0) {
+        par_untagged_tick = par_schedule->tick;
+        return;
+    }
+    /* Untagged tasks of this tick have already run. */
+    if (par_untagged_tick != par_schedule->tick) {
+        __atomic_fetch_add(&par_errors, 1, __ATOMIC_SEQ_CST);
+    }
+    /* Tasks of a group run in schedule order (groups are exclusive). */
+    if (par_group_seq[t->group] > t->position) {
+        __atomic_fetch_add(&par_errors, 1, __ATOMIC_SEQ_CST);
+    }
+    par_group_seq[t->group] = t->position + 1;
+}
+
+void par_marshal_in(Schedule* s, void* data)
+{
+    UNUSED(data);
+    UNUSED(s);
+    counter_marshal_in++;
+}
+
+static void blocked_job(void* arg)
+{
+    int* release = arg;
+    __atomic_store_n(release, 1, __ATOMIC_RELEASE);
+    while (__atomic_load_n(release, __ATOMIC_ACQUIRE) == 1) sched_yield();
+}
+
+void test_schedule__parallel(void** state)
+{
+    UNUSED(state);
+
+    DseThreadPool* shared_pool = dse_threadpool_create(4);
+    struct {
+        uint32_t       flags;
+        DseThreadPool* pool;
+        bool           blocked; /* Pool also runs a job of another user. */
+    } tc[] = {
+        { SCHEDULE_FLAG_PARALLEL, NULL, false },
+        { SCHEDULE_FLAG_PARALLEL, shared_pool, false },
+        { SCHEDULE_FLAG_PARALLEL | SCHEDULE_FLAG_EVENTQ, shared_pool, false },
+        { SCHEDULE_FLAG_PARALLEL, shared_pool, true },
+        { SCHEDULE_FLAG_NONE, NULL, false },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(tc); i++) {
+        /* A tick only waits for the jobs of its own schedule. */
+        int release = 0;
+        if (tc[i].blocked) {
+            dse_threadpool_submit(tc[i].pool, blocked_job, &release);
+            while (__atomic_load_n(&release, __ATOMIC_ACQUIRE) == 0) {
+                sched_yield();
+            }
+        }
+
+        ParTask tasks[] = {
+            { 0, 1, 0, 0 },
+            { 1, 1, 0, 0 },
+            { 2, 2, 0, 0 },
+            { 1, 1, 1, 0 },
+            { 0, 3, 0, 0 },
+            { 3, 1, 0, 0 },
+            { 2, 1, 1, 0 },
+            { 1, 5, 2, 0 },
+            { 3, 1, 1, 0 },
+        };
+
+        Schedule s = { 0 };
+        par_schedule = &s;
+        schedule_configure(&s, (ScheduleVTable){ .marshal_in = par_marshal_in },
+            (ScheduleTaskVTable){ .exec = par_task_exec }, 0.001, NULL);
+        schedule_set_flags(&s, tc[i].flags);
+        schedule_set_threadpool(&s, tc[i].pool);
+        for (size_t j = 0; j < ARRAY_SIZE(tasks); j++) {
+            schedule_add_group(&s, &tasks[j], tasks[j].beats, tasks[j].group);
+        }
+
+        par_errors = 0;
+        par_untagged_tick = UINT32_MAX;
+        counter_marshal_in = 0;
+        for (sim_time = 0; sim_time <= 0.03001; sim_time += 0.0005) {
+            memset(par_group_seq, 0, sizeof(par_group_seq));
+            schedule_tick(&s, sim_time);
+        }
+        assert_int_equal(s.tick, 30);
+        assert_int_equal(par_errors, 0);
+        assert_int_equal(counter_marshal_in, 31);
+        for (size_t j = 0; j < ARRAY_SIZE(tasks); j++) {
+            assert_int_equal(tasks[j].count, 30 / tasks[j].beats);
+        }
+        if (tc[i].flags & SCHEDULE_FLAG_PARALLEL) {
+            assert_non_null(s.parallel.pool);
+        }
+
+        schedule_destroy(&s);
+        assert_null(s.parallel.pool);
+        if (tc[i].blocked) {
+            __atomic_store_n(&release, 2, __ATOMIC_RELEASE);
+            dse_threadpool_wait(tc[i].pool);
+        }
+    }
+    dse_threadpool_destroy(shared_pool);
+}
+
+
+void test_schedule__integer_time(void** state)
+{
+    UNUSED(state);
+
+    Schedule s = { 0 };
+    schedule_configure(&s, (ScheduleVTable){ 0 }, (ScheduleTaskVTable){ 0 },
+        0.001, NULL);
+    schedule_set_flags(&s, SCHEDULE_FLAG_INTEGER_TIME);
+    assert_int_equal(s.beat_ns, 1000000);
+    schedule_add(&s, task_1ms_nocheck, 1);
+
+    // Progress simulation for 100 s with an accumulating step time.
+    counter_1ms = 0;
+    double t = 0;
+    for (uint32_t step = 0; step <= 1000000; step++) {
+        schedule_tick(&s, t);
+        assert_int_equal(s.tick, step / 10);
+        t += 0.0001;
+    }
+    assert_int_equal(counter_1ms, 100000);
+
+    // Large catch-up window.
+    schedule_tick(&s, 1000.0);
+    assert_int_equal(s.tick, 1000000);
+    assert_int_equal(counter_1ms, 1000000);
+
+    schedule_destroy(&s);
+}
+
+
+static size_t _run_catchup(uint32_t flags, uint32_t* out, size_t out_len)
+{
+    static TraceTask tasks[] = {
+        { 1, 0 }, { 2, 7 }, { 3, 10 }, { 4, 50 }, { 5, 10 },
+    };
+    static TraceTask late = { 6, 33 };
+
+    Schedule s = { 0 };
+    schedule_configure(&s, (ScheduleVTable){ .marshal_out = marshal_out },
+        (ScheduleTaskVTable){ .exec = trace_task_exec }, 0.001, NULL);
+    schedule_set_flags(&s, flags);
+    trace_schedule = &s;
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++) {
+        schedule_add(&s, &tasks[i], tasks[i].beats);
+    }
+
+    trace_count = 0;
+    counter_marshal_out = 0;
+    schedule_tick(&s, 0.0);
+    schedule_tick(&s, 0.5);
+    schedule_add(&s, &late, late.beats);
+    schedule_tick(&s, 0.7105);
+    schedule_tick(&s, 1.0);
+    assert_int_equal(s.tick, 1000);
+    schedule_destroy(&s);
+
+    assert_true(trace_count <= out_len);
+    memcpy(out, trace, trace_count * sizeof(uint32_t));
+    return trace_count + (counter_marshal_out << 16);
+}
+
+void test_schedule__catchup_skip(void** state)
+{
+    UNUSED(state);
+
+    uint32_t ref[ARRAY_SIZE(trace)];
+    uint32_t got[ARRAY_SIZE(trace)];
+    /* Large windows require integer time (the floating point calculation
+       overshoots by up to 1%). */
+    size_t ref_count =
+        _run_catchup(SCHEDULE_FLAG_INTEGER_TIME, ref, ARRAY_SIZE(ref));
+    assert_true((ref_count & 0xffff) > 300);
+
+    uint32_t flags[] = {
+        SCHEDULE_FLAG_INTEGER_TIME | SCHEDULE_FLAG_EVENTQ,
+        SCHEDULE_FLAG_INTEGER_TIME | SCHEDULE_FLAG_CATCHUP_SKIP,
+        SCHEDULE_FLAG_INTEGER_TIME | SCHEDULE_FLAG_CATCHUP_SKIP |
+            SCHEDULE_FLAG_EVENTQ,
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(flags); i++) {
+        size_t got_count = _run_catchup(flags[i], got, ARRAY_SIZE(got));
+        assert_int_equal(got_count, ref_count);
+        assert_memory_equal(got, ref, (ref_count & 0xffff) * sizeof(uint32_t));
+    }
+}
+
+
+void test_schedule__marshal_batch(void** state)
+{
+    UNUSED(state);
+
+    ScheduleVTable svt = {
+        .marshal_in = marshal_in,
+        .marshal_out = marshal_out,
+        .marshal_noop = marshal_noop,
+    };
+    uint32_t flags[] = { SCHEDULE_FLAG_NONE, SCHEDULE_FLAG_MARSHAL_BATCH };
+    for (size_t i = 0; i < ARRAY_SIZE(flags); i++) {
+        Schedule s = { 0 };
+        schedule_configure(&s, svt, (ScheduleTaskVTable){ 0 }, 0.001, NULL);
+        schedule_set_flags(&s, flags[i] | SCHEDULE_FLAG_INTEGER_TIME);
+        schedule_add(&s, task_1ms_nocheck, 1);
+
+        // Progress simulation for 50 ms, 5 beats per step.
+        counter_marshal_in = 0;
+        counter_marshal_out = 0;
+        counter_marshal_noop = 0;
+        counter_1ms = 0;
+        delay = 0;
+        for (sim_time = 0; sim_time <= 0.05001; sim_time += 0.005) {
+            schedule_tick(&s, sim_time);
+        }
+        assert_int_equal(s.tick, 50);
+        assert_int_equal(counter_1ms, 50);
+        assert_int_equal(counter_marshal_noop, 11);
+        if (flags[i] == SCHEDULE_FLAG_MARSHAL_BATCH) {
+            assert_int_equal(counter_marshal_out, 11);
+            assert_int_equal(counter_marshal_in, 11);
+            assert_int_equal(s.marshal_batch.saved_out, 40);
+            assert_int_equal(s.marshal_batch.saved_in, 40);
+        } else {
+            assert_int_equal(counter_marshal_out, 51);
+            assert_int_equal(counter_marshal_in, 51);
+            assert_int_equal(s.marshal_batch.saved_out, 0);
+            assert_int_equal(s.marshal_batch.saved_in, 0);
+        }
+
+        schedule_destroy(&s);
+    }
+}
+
+
+/* Profile clock, each reading advances the clock by 1 uSec. */
+uint64_t profile_clock;
+
+uint64_t profile_clock_ns(void)
+{
+    profile_clock += 1000;
+    return profile_clock;
+}
+
+void task_slow(void)
+{
+    /* Runs for 2 ms (beat is 1 ms). */
+    profile_clock += 2000000;
+}
+
+const char* profile_task_name(ScheduleTask task)
+{
+    return (task == task_slow) ? "slow" : NULL;
+}
+
+void test_schedule__profile(void** state)
+{
+    UNUSED(state);
+
+    Schedule s = { 0 };
+    schedule_configure(&s, (ScheduleVTable){ 0 },
+        (ScheduleTaskVTable){ .name = profile_task_name }, 0.001, NULL);
+    schedule_add(&s, task_1ms_nocheck, 1);
+    schedule_add(&s, task_slow, 5);
+    s.profile.clock_ns = profile_clock_ns;
+
+    // Disabled, no profile.
+    for (sim_time = 0; sim_time <= 0.01001; sim_time += 0.0005) {
+        schedule_tick(&s, sim_time);
+    }
+    assert_null(schedule_profile_task(&s, 0));
+    assert_int_equal(s.profile.beat.count, 0);
+
+    // Enabled.
+    schedule_set_flags(&s, SCHEDULE_FLAG_PROFILE);
+    for (; sim_time <= 0.03001; sim_time += 0.0005) {
+        schedule_tick(&s, sim_time);
+    }
+    const ScheduleProfile* fast = schedule_profile_task(&s, 0);
+    const ScheduleProfile* slow = schedule_profile_task(&s, 1);
+    assert_non_null(fast);
+    assert_non_null(slow);
+    assert_null(schedule_profile_task(&s, 2));
+    assert_int_equal(fast->count, 20);
+    assert_int_equal(slow->count, 4);
+    assert_int_equal(s.profile.beat.count, 20);
+    assert_int_equal(fast->overruns, 0);
+    assert_int_equal(slow->overruns, 4);
+    assert_int_equal(s.profile.beat.overruns, 4);
+    assert_int_equal(fast->max_ns, 1000);
+    assert_int_equal(slow->min_ns, 2001000);
+    assert_int_equal(slow->max_ns, 2001000);
+    uint64_t p50 = schedule_profile_percentile(slow, 50.0);
+    assert_true(p50 >= slow->min_ns);
+    assert_true(p50 <= slow->max_ns);
+    assert_int_equal(schedule_profile_percentile(slow, 100.0), slow->max_ns);
+
+    // Export as CSV.
+    FILE* f = tmpfile();
+    assert_int_equal(schedule_profile_write_csv(&s, f), 0);
+    rewind(f);
+    char line[200];
+    assert_non_null(fgets(line, sizeof(line), f));
+    assert_string_equal(line,
+        "name,count,min_ns,mean_ns,p50_ns,p99_ns,max_ns,jitter_ns,overruns\n");
+    assert_non_null(fgets(line, sizeof(line), f));
+    assert_memory_equal(line, "beat,20,", 8);
+    assert_non_null(fgets(line, sizeof(line), f));
+    assert_memory_equal(line, "task_0,20,", 10);
+    assert_non_null(fgets(line, sizeof(line), f));
+    assert_memory_equal(line, "slow,4,", 7);
+    assert_null(fgets(line, sizeof(line), f));
+    fclose(f);
+
+    // Export as signals (i.e. for MDF).
+    const char** signal;
+    double*      scalar;
+    size_t       count = schedule_profile_signals(&s, &signal, &scalar);
+    assert_int_equal(count, 12);
+    assert_string_equal(signal[0], "beat.mean_ns");
+    assert_string_equal(signal[4], "task_0.mean_ns");
+    assert_string_equal(signal[9], "slow.max_ns");
+    assert_string_equal(signal[11], "slow.overruns");
+    assert_double_equal(scalar[9], slow->max_ns, 0.0);
+    assert_double_equal(scalar[11], 4, 0.0);
+
+    // Reset.
+    schedule_profile_reset(&s);
+    assert_int_equal(slow->count, 0);
+    assert_int_equal(s.profile.beat.count, 0);
+
+    schedule_destroy(&s);
+    assert_null(s.profile.task);
+    assert_null(s.profile.signal);
+}
+
+
 int run_schedule_tests(void)
 {
     void* s = test_setup;
@@ -336,6 +862,14 @@ int run_schedule_tests(void)
         cmocka_unit_test_setup_teardown(
             test_schedule__delay_shift_backward, s, t),
         cmocka_unit_test_setup_teardown(test_schedule__beat, s, t),
+        cmocka_unit_test_setup_teardown(test_schedule__eventq, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_schedule__eventq_same_period, s, t),
+        cmocka_unit_test_setup_teardown(test_schedule__parallel, s, t),
+        cmocka_unit_test_setup_teardown(test_schedule__integer_time, s, t),
+        cmocka_unit_test_setup_teardown(test_schedule__catchup_skip, s, t),
+        cmocka_unit_test_setup_teardown(test_schedule__marshal_batch, s, t),
+        cmocka_unit_test_setup_teardown(test_schedule__profile, s, t),
     };
 
     return cmocka_run_group_tests_name("SCHEDULE", tests, NULL, NULL);
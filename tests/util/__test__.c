@@ -13,6 +13,10 @@ extern int run_binary_tests(void);
 extern int run_yaml_tests(void);
 extern int run_ascii85_tests(void);
 extern int run_cleanup_tests(void);
+extern int run_threadpool_tests(void);
+extern int run_strings_tests(void);
+extern int run_codec_tests(void);
+extern int run_logger_tests(void);
 
 
 int main()
@@ -24,6 +28,10 @@ int main()
     rc |= run_yaml_tests();
     rc |= run_ascii85_tests();
     rc |= run_cleanup_tests();
+    rc |= run_threadpool_tests();
+    rc |= run_strings_tests();
+    rc |= run_codec_tests();
+    rc |= run_logger_tests();
     return rc;
 }
 
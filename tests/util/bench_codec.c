@@ -0,0 +1,187 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <dse/logger.h>
+#include <dse/clib/util/strings.h>
+
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+#define REPEAT        5
+#define CHUNK_SIZE    4096
+
+
+/**
+Binary to Text Codec Benchmark
+==============================
+
+Measures the throughput of the binary to text codecs (ASCII85, Base64 and
+Z85) as one-shot encode/decode (allocating), and of ASCII85 as a stream
+(chunks to a caller provided buffer), for payloads of various sizes. A
+per-byte ASCII85 encoder (the previous implementation) is included as a
+reference. Each scenario reports the best of several runs, and the size of
+the encoded text relative to the payload.
+
+Run with:
+
+    $ make -C tests build bench
+*/
+
+
+uint8_t __log_level__ = LOG_QUIET;
+
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+static void report(
+    const char* scenario, size_t size, uint64_t ns, size_t text_len)
+{
+    printf("%-20s %10zu %12.3f %10.1f %6.3f\n", scenario, size, ns / 1e6,
+        (double)size / (ns / 1e9) / (1024 * 1024), (double)text_len / size);
+}
+
+
+static size_t encode_ref(const char* data, size_t size, char* target)
+{
+    char* en = target;
+    while (size) {
+        uint32_t x = 0;
+        for (int chunk = 3; chunk >= 0; chunk--) {
+            x |= (uint8_t)*data << (chunk * 8);
+            data++;
+            if (--size == 0) break;
+        }
+        if (x == 0 && size >= 4) {
+            *en++ = 'z';
+            continue;
+        }
+        for (int byte = 4; byte >= 0; byte--) {
+            en[byte] = (x % 85) + 33;
+            x /= 85;
+        }
+        en += 5;
+    }
+    return en - target;
+}
+
+
+static size_t encode_stream(const char* data, size_t size, char* target)
+{
+    DseAscii85Stream s;
+    size_t           len = 0;
+    dse_ascii85_stream_init(&s);
+    for (size_t i = 0; i < size; i += CHUNK_SIZE) {
+        size_t n = (size - i < CHUNK_SIZE) ? size - i : CHUNK_SIZE;
+        len += dse_ascii85_encode_update(&s, data + i, n, target + len);
+    }
+    len += dse_ascii85_encode_final(&s, target + len);
+    return len;
+}
+
+
+static size_t decode_stream(const char* data, size_t size, char* target)
+{
+    DseAscii85Stream s;
+    size_t           len = 0;
+    dse_ascii85_stream_init(&s);
+    for (size_t i = 0; i < size; i += CHUNK_SIZE) {
+        size_t n = (size - i < CHUNK_SIZE) ? size - i : CHUNK_SIZE;
+        len += dse_ascii85_decode_update(&s, data + i, n, target + len);
+    }
+    len += dse_ascii85_decode_final(&s, target + len);
+    return len;
+}
+
+
+typedef size_t (*BenchFunc)(const char* source, size_t len, char* target);
+
+static void run(const char* scenario, BenchFunc func, const char* source,
+    size_t source_len, char* target, size_t size, size_t text_len)
+{
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < REPEAT; r++) {
+        uint64_t t = now_ns();
+        func(source, source_len, target);
+        t = now_ns() - t;
+        if (t < best) best = t;
+    }
+    report(scenario, size, best, text_len);
+}
+
+
+static void bench(size_t size)
+{
+    char* data = malloc(size);
+    srand(42);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = rand();
+    }
+
+    const char* codec_names[] = { "ascii85", "base64", "z85" };
+    for (size_t c = 0; c < ARRAY_SIZE(codec_names); c++) {
+        const DseTextCodec* codec = dse_text_codec_find(codec_names[c]);
+        char                scenario[32];
+        uint64_t            best[2] = { UINT64_MAX, UINT64_MAX };
+        size_t              text_len = 0;
+        for (int r = 0; r < REPEAT; r++) {
+            uint64_t t = now_ns();
+            char*    text = codec->encode(data, size);
+            t = now_ns() - t;
+            if (t < best[0]) best[0] = t;
+            text_len = strlen(text);
+
+            size_t len = 0;
+            t = now_ns();
+            char* decoded = codec->decode(text, &len);
+            t = now_ns() - t;
+            if (t < best[1]) best[1] = t;
+            if (len != size || memcmp(decoded, data, size)) {
+                printf("%s: decode failed\n", codec->name);
+            }
+            free(decoded);
+            free(text);
+        }
+        snprintf(scenario, sizeof(scenario), "%s_encode", codec->name);
+        report(scenario, size, best[0], text_len);
+        snprintf(scenario, sizeof(scenario), "%s_decode", codec->name);
+        report(scenario, size, best[1], text_len);
+    }
+
+    char*  text = dse_ascii85_encode(data, size);
+    size_t text_len = strlen(text);
+    char*  target = malloc(DSE_ASCII85_DECODE_SIZE(text_len));
+    run("ascii85_encode_ref", encode_ref, data, size, target, size, text_len);
+    run("ascii85_enc_stream", encode_stream, data, size, target, size,
+        text_len);
+    run("ascii85_dec_stream", decode_stream, text, text_len, target, size,
+        text_len);
+
+    free(target);
+    free(text);
+    free(data);
+}
+
+
+int main(void)
+{
+    size_t size[] = { 1024, 64 * 1024, 4 * 1024 * 1024 };
+
+    printf("%-20s %10s %12s %10s %6s\n", "scenario", "bytes", "ms", "MB/s",
+        "ratio");
+    for (size_t i = 0; i < ARRAY_SIZE(size); i++) {
+        bench(size[i]);
+    }
+
+    return 0;
+}
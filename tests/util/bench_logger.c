@@ -0,0 +1,115 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dse/logger.h>
+#include <dse/clib/util/logger.h>
+
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+#define MESSAGES      100000
+#define BURST         256
+
+
+/**
+Logger Benchmark
+================
+
+Measures the latency of a log call (as seen by the calling thread) for the
+synchronous logger, and for the asynchronous logger with the drop and block
+policies (writing text or a binary trace). Messages are logged in bursts with
+a short pause between bursts, and the output is written to `/dev/null`.
+Reports the median, 99th percentile and maximum latency of a call.
+
+Run with:
+
+    $ make -C tests build bench
+*/
+
+
+uint8_t __log_level__ = LOG_INFO;
+
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+static int compare(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+
+static void bench(const char* scenario, FILE* report, uint64_t* sample)
+{
+    struct timespec pause = { .tv_sec = 0, .tv_nsec = 100000 };
+    for (int i = 0; i < MESSAGES; i++) {
+        uint64_t t = now_ns();
+        log_info("signal %s changed: value=%f, step=%d", "foo", i * 0.5, i);
+        sample[i] = now_ns() - t;
+        if (i % BURST == BURST - 1) nanosleep(&pause, NULL);
+    }
+    qsort(sample, MESSAGES, sizeof(uint64_t), compare);
+    fprintf(report, "%-20s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+        scenario, sample[MESSAGES / 2], sample[MESSAGES * 99 / 100],
+        sample[MESSAGES - 1]);
+}
+
+
+int main(void)
+{
+    uint64_t* sample = calloc(MESSAGES, sizeof(uint64_t));
+    FILE*     devnull = fopen("/dev/null", "w");
+    FILE*     report = fdopen(dup(fileno(stdout)), "w");
+    setvbuf(report, NULL, _IONBF, 0);
+    if (sample == NULL || devnull == NULL || report == NULL) return 1;
+
+    fprintf(report, "%-20s %10s %10s %10s\n", "scenario", "p50 ns", "p99 ns",
+        "max ns");
+
+    /* Synchronous logger (stdout redirected). */
+    fflush(stdout);
+    if (freopen("/dev/null", "w", stdout) == NULL) return 1;
+    bench("sync", report, sample);
+
+    /* Asynchronous logger. */
+    struct {
+        const char*     scenario;
+        DseLoggerPolicy policy;
+        DseLoggerFormat format;
+    } scenario[] = {
+        { "async_drop", DSE_LOGGER_DROP, DSE_LOGGER_TEXT },
+        { "async_block", DSE_LOGGER_BLOCK, DSE_LOGGER_TEXT },
+        { "async_binary_drop", DSE_LOGGER_DROP, DSE_LOGGER_BINARY },
+        { "async_binary_block", DSE_LOGGER_BLOCK, DSE_LOGGER_BINARY },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(scenario); i++) {
+        DseLoggerConfig config = { .stream = devnull,
+            .policy = scenario[i].policy,
+            .format = scenario[i].format };
+        dse_logger_start(&config);
+        bench(scenario[i].scenario, report, sample);
+        dse_logger_stop();
+        DseLoggerStats stats = dse_logger_stats();
+        fprintf(report, "%-20s records=%" PRIu64 " dropped=%" PRIu64
+            " blocked=%" PRIu64 "\n", "", stats.records, stats.dropped,
+            stats.blocked);
+    }
+
+    fclose(report);
+    fclose(devnull);
+    free(sample);
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <dse/logger.h>
+#include <dse/clib/util/strings.h>
+
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+#define REPEAT        5
+#define CHUNK_SIZE    16
+
+
+/**
+Buffer Append Benchmark
+=======================
+
+Measures the time to build a buffer from many small appends with an exact
+size realloc on each append (the previous `dse_buffer_append` behaviour),
+`dse_buffer_append`, `dse_bytebuf_append` and `dse_strbuf_append`. Each
+scenario reports the best of several runs.
+
+Run with:
+
+    $ make -C tests build bench
+*/
+
+
+uint8_t __log_level__ = LOG_QUIET;
+
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+static void report(const char* scenario, size_t appends, uint64_t ns)
+{
+    printf("%-18s %8zu %12.3f %10.1f\n", scenario, appends, ns / 1e6,
+        (double)ns / appends);
+}
+
+
+static size_t append_exact(size_t appends, const char* chunk)
+{
+    char*  buffer = NULL;
+    size_t size = 0;
+    for (size_t i = 0; i < appends; i++) {
+        buffer = realloc(buffer, size + CHUNK_SIZE);
+        memcpy(buffer + size, chunk, CHUNK_SIZE);
+        size += CHUNK_SIZE;
+    }
+    free(buffer);
+    return size;
+}
+
+
+static size_t append_buffer(size_t appends, const char* chunk)
+{
+    void*    buffer = NULL;
+    uint32_t size = 0;
+    uint32_t buffer_size = 0;
+    for (size_t i = 0; i < appends; i++) {
+        dse_buffer_append(&buffer, &size, &buffer_size, chunk, CHUNK_SIZE);
+    }
+    free(buffer);
+    return size;
+}
+
+
+static size_t append_bytebuf(size_t appends, const char* chunk)
+{
+    DseByteBuf b;
+    dse_bytebuf_init(&b);
+    for (size_t i = 0; i < appends; i++) {
+        dse_bytebuf_append(&b, chunk, CHUNK_SIZE);
+    }
+    size_t size = b.len;
+    dse_bytebuf_destroy(&b);
+    return size;
+}
+
+
+static size_t append_strbuf(size_t appends, const char* chunk)
+{
+    DseStrBuf b;
+    dse_strbuf_init(&b);
+    for (size_t i = 0; i < appends; i++) {
+        dse_strbuf_append(&b, chunk);
+    }
+    size_t size = b.len;
+    dse_strbuf_destroy(&b);
+    return size;
+}
+
+
+static void bench(size_t appends)
+{
+    struct {
+        const char* scenario;
+        size_t (*func)(size_t, const char*);
+    } scenario[] = {
+        { "realloc_exact", append_exact },
+        { "buffer_append", append_buffer },
+        { "bytebuf_append", append_bytebuf },
+        { "strbuf_append", append_strbuf },
+    };
+    const char chunk[CHUNK_SIZE + 1] = "0123456789abcdef";
+
+    for (size_t s = 0; s < ARRAY_SIZE(scenario); s++) {
+        uint64_t best = UINT64_MAX;
+        for (int r = 0; r < REPEAT; r++) {
+            uint64_t t = now_ns();
+            size_t   size = scenario[s].func(appends, chunk);
+            t = now_ns() - t;
+            if (t < best) best = t;
+            if (size != appends * CHUNK_SIZE) {
+                printf("%s: unexpected size %zu\n", scenario[s].scenario, size);
+            }
+        }
+        report(scenario[s].scenario, appends, best);
+    }
+}
+
+
+int main(void)
+{
+    size_t appends[] = { 1000, 100000, 1000000 };
+
+    printf("%-18s %8s %12s %10s\n", "scenario", "appends", "ms",
+        "ns/append");
+    for (size_t i = 0; i < ARRAY_SIZE(appends); i++) {
+        bench(appends[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <dse/logger.h>
+#include <dse/clib/util/yaml.h>
+
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+#define REPEAT        5
+
+
+/**
+YAML Startup Benchmark
+======================
+
+Measures the time to load a generated stack YAML file (with 100, 1k and 10k
+model instances) with the YamlNode parser, the compact DOM parser and from a
+compact DOM snapshot (mapped, and converted to YamlNode documents). Each
+scenario reports the best of several runs.
+
+Run with:
+
+    $ make -C tests build bench
+*/
+
+
+uint8_t __log_level__ = LOG_QUIET;
+
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+static void generate(const char* filename, size_t models)
+{
+    FILE* f = fopen(filename, "w");
+    fprintf(f, "---\nkind: Stack\nmetadata:\n  name: bench_stack\nspec:\n");
+    fprintf(f, "  models:\n");
+    for (size_t i = 0; i < models; i++) {
+        fprintf(f,
+            "    - name: model_%zu\n"
+            "      uid: %zu\n"
+            "      model:\n"
+            "        name: Model%zu\n"
+            "      runtime:\n"
+            "        env:\n"
+            "          SIMBUS_LOGLEVEL: 4\n"
+            "          MODEL_INDEX: %zu\n"
+            "      channels:\n"
+            "        - name: signal\n"
+            "          alias: signal_channel\n"
+            "          selectors:\n"
+            "            channel: signal_vector\n"
+            "        - name: network\n"
+            "          alias: network_channel\n",
+            i, i + 1, i % 10, i);
+    }
+    for (size_t i = 0; i < 10; i++) {
+        fprintf(f,
+            "---\nkind: Model\nmetadata:\n  name: Model%zu\nspec:\n"
+            "  runtime:\n    dynlib:\n      - os: linux\n        arch: amd64\n"
+            "        path: lib/model%zu.so\n",
+            i, i);
+    }
+    fclose(f);
+}
+
+
+static void report(const char* scenario, size_t models, uint64_t ns,
+    size_t docs, size_t size)
+{
+    printf("%-18s %8zu %12.3f %6zu %12zu\n", scenario, models, ns / 1e6, docs,
+        size);
+}
+
+
+static void bench(size_t models)
+{
+    char filename[64];
+    char snapshot[80];
+    snprintf(filename, sizeof(filename), "/tmp/bench_yaml_%d.yaml", getpid());
+    snprintf(snapshot, sizeof(snapshot), "%s.snapshot", filename);
+    generate(filename, models);
+    unlink(snapshot);
+
+    uint64_t best[4] = { UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX };
+    size_t   docs = 0;
+    size_t   size = 0;
+    for (int r = 0; r < REPEAT; r++) {
+        uint64_t t = now_ns();
+        YamlDocList* doc_list = dse_yaml_load_file(filename, NULL);
+        t = now_ns() - t;
+        if (t < best[0]) best[0] = t;
+        docs = hashlist_length(doc_list);
+        dse_yaml_destroy_doc_list(doc_list);
+
+        t = now_ns();
+        YamlCompact* c = dse_yaml_compact_load_file(filename);
+        t = now_ns() - t;
+        if (t < best[1]) best[1] = t;
+        size = dse_yaml_compact_size(c);
+        if (r == 0) dse_yaml_compact_save(c, snapshot, filename);
+        dse_yaml_compact_destroy(c);
+
+        t = now_ns();
+        c = dse_yaml_compact_load_cached(filename, snapshot);
+        uint64_t t_map = now_ns() - t;
+        if (t_map < best[2]) best[2] = t_map;
+        doc_list = dse_yaml_compact_to_doc_list(c, NULL);
+        t = now_ns() - t;
+        if (t < best[3]) best[3] = t;
+        dse_yaml_destroy_doc_list(doc_list);
+        dse_yaml_compact_destroy(c);
+    }
+    report("parse", models, best[0], docs, 0);
+    report("compact", models, best[1], docs, size);
+    report("snapshot", models, best[2], docs, size);
+    report("snapshot+doclist", models, best[3], docs, size);
+
+    unlink(snapshot);
+    unlink(filename);
+}
+
+
+int main(void)
+{
+    size_t models[] = { 100, 1000, 10000 };
+
+    printf("%-18s %8s %12s %6s %12s\n", "scenario", "models", "ms", "docs",
+        "image_bytes");
+    for (size_t i = 0; i < ARRAY_SIZE(models); i++) {
+        bench(models[i]);
+    }
+
+    return 0;
+}
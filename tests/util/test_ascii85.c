@@ -5,16 +5,13 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <dse/testing.h>
+#include <dse/clib/util/strings.h>
 
 
 #define UNUSED(x)     ((void)x)
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
 
 
-extern char* dse_ascii85_encode(const char* source, size_t len);
-extern char* dse_ascii85_decode(const char* source, size_t* len);
-
-
 int test_ascii85_setup(void** state)
 {
     UNUSED(state);
@@ -151,6 +148,80 @@ void test_ascii85__roundtrip(void** state)
 }
 
 
+void test_ascii85__zero(void** state)
+{
+    UNUSED(state);
+
+    /* A zero group is encoded as 'z' only when followed by 4 more bytes. */
+    TC_EN tc[] = {
+        { .base = "\0\0\0\0", .enc = "!!!!!" },
+        { .base = "\0\0\0\0\0\0\0", .enc = "!!!!!!!!!" },
+        { .base = "\0\0\0\0\0\0\0\0", .enc = "z!!!!!" },
+        { .base = "\0\0\0\0\0\0\0\0\0", .enc = "z!!!!!!!" },
+        { .base = "\0\0\0\0\0\0\0\0\0\0\0\0", .enc = "zz!!!!!" },
+        { .base = "\0\0\0\0abcd\0\0\0\0", .enc = "z@:E_W!!!!!" },
+    };
+    size_t len[] = { 4, 7, 8, 9, 12, 12 };
+    for (size_t i = 0; i < ARRAY_SIZE(tc); i++) {
+        char* encoded = dse_ascii85_encode(tc[i].base, len[i]);
+        assert_string_equal(encoded, tc[i].enc);
+        size_t dec_len = 0;
+        char*  decoded = dse_ascii85_decode(encoded, &dec_len);
+        assert_int_equal(dec_len, len[i]);
+        assert_memory_equal(decoded, tc[i].base, len[i]);
+        free(encoded);
+        free(decoded);
+    }
+}
+
+
+void test_ascii85__stream(void** state)
+{
+    UNUSED(state);
+
+    /* Data with non-zero and zero groups, at various alignments. */
+    char data[1003];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (i % 97 < 40) ? 0 : (char)(i * 7 + 1);
+    }
+    size_t chunk_size[] = { 1, 3, 4, 7, 20, 64, 1003 };
+
+    for (size_t len = 0; len <= sizeof(data); len += 17) {
+        char*  expect = dse_ascii85_encode(data, len);
+        size_t expect_len = strlen(expect);
+        for (size_t c = 0; c < ARRAY_SIZE(chunk_size); c++) {
+            size_t cs = chunk_size[c];
+            char   enc[DSE_ASCII85_ENCODE_SIZE(sizeof(data))];
+            char   dec[DSE_ASCII85_DECODE_SIZE(sizeof(enc))];
+            size_t enc_len = 0;
+            size_t dec_len = 0;
+
+            DseAscii85Stream s;
+            dse_ascii85_stream_init(&s);
+            for (size_t i = 0; i < len; i += cs) {
+                size_t n = (len - i < cs) ? len - i : cs;
+                enc_len +=
+                    dse_ascii85_encode_update(&s, data + i, n, enc + enc_len);
+            }
+            enc_len += dse_ascii85_encode_final(&s, enc + enc_len);
+            assert_int_equal(enc_len, expect_len);
+            assert_memory_equal(enc, expect, enc_len);
+
+            dse_ascii85_stream_init(&s);
+            for (size_t i = 0; i < enc_len; i += cs) {
+                size_t n = (enc_len - i < cs) ? enc_len - i : cs;
+                dec_len +=
+                    dse_ascii85_decode_update(&s, enc + i, n, dec + dec_len);
+            }
+            dec_len += dse_ascii85_decode_final(&s, dec + dec_len);
+            assert_int_equal(dec_len, len);
+            assert_memory_equal(dec, data, len);
+        }
+        free(expect);
+    }
+}
+
+
 int run_ascii85_tests(void)
 {
     void* s = test_ascii85_setup;
@@ -160,6 +231,8 @@ int run_ascii85_tests(void)
         cmocka_unit_test_setup_teardown(test_ascii85__encode, s, t),
         cmocka_unit_test_setup_teardown(test_ascii85__decode, s, t),
         cmocka_unit_test_setup_teardown(test_ascii85__roundtrip, s, t),
+        cmocka_unit_test_setup_teardown(test_ascii85__zero, s, t),
+        cmocka_unit_test_setup_teardown(test_ascii85__stream, s, t),
     };
 
     return cmocka_run_group_tests_name("ASCII85", tests, NULL, NULL);
@@ -2,6 +2,7 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <errno.h>
 #include <dse/testing.h>
 #include <dse/clib/util/strings.h>
 
@@ -33,14 +34,14 @@ void test_buffer_append__general(void** state)
     assert_int_equal(buffer_size, OBJ_1_LEN);
     assert_memory_equal(buffer, OBJ_1, OBJ_1_LEN);
 
-    /* Realloc. */
+    /* Realloc (geometric growth). */
     save_ptr = buffer;
     dse_buffer_append(&buffer, &size, &buffer_size, (void*)OBJ_2, OBJ_2_LEN);
     assert_non_null(buffer);
     // FLAKE: assert_ptr_not_equal(buffer, save_ptr);  // Sometimes the pointers
     // are equal?
     assert_int_equal(size, OBJ_1_LEN + OBJ_2_LEN);
-    assert_int_equal(buffer_size, OBJ_1_LEN + OBJ_2_LEN);
+    assert_int_equal(buffer_size, OBJ_1_LEN * 2);
     assert_memory_equal(buffer, OBJ_1, OBJ_1_LEN);
     assert_memory_equal(buffer + OBJ_1_LEN, OBJ_2, OBJ_2_LEN);
 
@@ -51,7 +52,7 @@ void test_buffer_append__general(void** state)
     assert_non_null(buffer);
     assert_ptr_equal(buffer, save_ptr);
     assert_int_equal(size, OBJ_2_LEN);
-    assert_int_equal(buffer_size, OBJ_1_LEN + OBJ_2_LEN);
+    assert_int_equal(buffer_size, OBJ_1_LEN * 2);
     assert_memory_equal(buffer, OBJ_2, OBJ_2_LEN);
 
 
@@ -81,11 +82,89 @@ void test_buffer_append__extended(void** state)
 }
 
 
+void test_buffer_append__growth(void** state)
+{
+    UNUSED(state);
+
+    void*    buffer = NULL;
+    uint32_t size = 0;
+    uint32_t buffer_size = 0;
+    uint32_t reallocs = 0;
+
+    /* Repeated appends, the buffer grows geometrically. */
+    for (int i = 0; i < 10000; i++) {
+        uint32_t _buffer_size = buffer_size;
+        dse_buffer_append(&buffer, &size, &buffer_size, OBJ_1, OBJ_1_LEN);
+        if (buffer_size != _buffer_size) reallocs++;
+    }
+    assert_int_equal(size, 10000 * OBJ_1_LEN);
+    assert_true(buffer_size >= size);
+    assert_true(reallocs < 20);
+    assert_memory_equal(buffer + 9999 * OBJ_1_LEN, OBJ_1, OBJ_1_LEN);
+
+    free(buffer);
+}
+
+
+void test_bytebuf(void** state)
+{
+    UNUSED(state);
+
+    DseByteBuf b;
+    dse_bytebuf_init(&b);
+    assert_int_equal(b.len, 0);
+
+    /* Inline. */
+    assert_int_equal(dse_bytebuf_append(&b, OBJ_1, OBJ_1_LEN), 0);
+    assert_null(b.heap);
+    assert_int_equal(b.len, OBJ_1_LEN);
+    assert_memory_equal(dse_bytebuf_data(&b), OBJ_1, OBJ_1_LEN);
+
+    /* Heap, with geometric growth. */
+    for (int i = 0; i < 100; i++) {
+        assert_int_equal(dse_bytebuf_append(&b, OBJ_2, OBJ_2_LEN), 0);
+    }
+    assert_non_null(b.heap);
+    assert_int_equal(b.len, OBJ_1_LEN + 100 * OBJ_2_LEN);
+    assert_true(b.size >= b.len);
+    assert_memory_equal(dse_bytebuf_data(&b), OBJ_1, OBJ_1_LEN);
+    assert_memory_equal(
+        (uint8_t*)dse_bytebuf_data(&b) + b.len - OBJ_2_LEN, OBJ_2, OBJ_2_LEN);
+
+    /* Reserve and shrink. */
+    assert_int_equal(dse_bytebuf_reserve(&b, 10000), 0);
+    assert_true(b.size >= 10000);
+    assert_int_equal(dse_bytebuf_shrink(&b), 0);
+    assert_int_equal(b.size, b.len);
+    dse_bytebuf_clear(&b);
+    assert_int_equal(b.len, 0);
+    dse_bytebuf_append(&b, OBJ_1, OBJ_1_LEN);
+    assert_int_equal(dse_bytebuf_shrink(&b), 0);
+    assert_null(b.heap);
+    assert_memory_equal(dse_bytebuf_data(&b), OBJ_1, OBJ_1_LEN);
+
+    /* Release (from inline). */
+    size_t len = 0;
+    void*  data = dse_bytebuf_release(&b, &len);
+    assert_non_null(data);
+    assert_int_equal(len, OBJ_1_LEN);
+    assert_memory_equal(data, OBJ_1, OBJ_1_LEN);
+    assert_int_equal(b.len, 0);
+    free(data);
+
+    assert_int_equal(dse_bytebuf_append(&b, NULL, 1), EINVAL);
+    assert_int_equal(dse_bytebuf_append(NULL, OBJ_1, 1), EINVAL);
+    dse_bytebuf_destroy(&b);
+    dse_bytebuf_destroy(NULL);
+}
+
 int run_binary_tests(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_buffer_append__general),
         cmocka_unit_test(test_buffer_append__extended),
+        cmocka_unit_test(test_buffer_append__growth),
+        cmocka_unit_test(test_bytebuf),
     };
 
     return cmocka_run_group_tests_name("BINARY", tests, NULL, NULL);
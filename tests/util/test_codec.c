@@ -0,0 +1,154 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <dse/testing.h>
+#include <dse/clib/util/strings.h>
+
+
+#define UNUSED(x)     ((void)x)
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+
+typedef struct TC_CODEC {
+    const char* base;
+    size_t      base_len;
+    const char* enc;
+} TC_CODEC;
+
+
+void test_codec__base64(void** state)
+{
+    UNUSED(state);
+
+    /* RFC 4648 test vectors. */
+    TC_CODEC tc[] = {
+        { .base = "", .base_len = 0, .enc = "" },
+        { .base = "f", .base_len = 1, .enc = "Zg==" },
+        { .base = "fo", .base_len = 2, .enc = "Zm8=" },
+        { .base = "foo", .base_len = 3, .enc = "Zm9v" },
+        { .base = "foob", .base_len = 4, .enc = "Zm9vYg==" },
+        { .base = "fooba", .base_len = 5, .enc = "Zm9vYmE=" },
+        { .base = "foobar", .base_len = 6, .enc = "Zm9vYmFy" },
+        { .base = "foo\0bar\xff\xfe", .base_len = 9, .enc = "Zm9vAGJhcv/+" },
+        { .base = "Please encode this sentence!",
+            .base_len = 28,
+            .enc = "UGxlYXNlIGVuY29kZSB0aGlzIHNlbnRlbmNlIQ==" },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(tc); i++) {
+        char* encoded = dse_base64_encode(tc[i].base, tc[i].base_len);
+        assert_string_equal(encoded, tc[i].enc);
+        size_t len = 0;
+        char*  decoded = dse_base64_decode(encoded, &len);
+        assert_non_null(decoded);
+        assert_int_equal(len, tc[i].base_len);
+        assert_memory_equal(decoded, tc[i].base, len);
+        assert_int_equal(decoded[len], '\0');
+        free(encoded);
+        free(decoded);
+    }
+
+    /* Padding is optional. */
+    size_t len = 0;
+    char*  decoded = dse_base64_decode("Zm9vYg", &len);
+    assert_int_equal(len, 4);
+    assert_memory_equal(decoded, "foob", 4);
+    free(decoded);
+
+    /* Invalid encodings. */
+    const char* invalid[] = { "Zm9vY", "Zm9v*mFy", "Zm9vYmFy!", "Zm=v" };
+    for (size_t i = 0; i < ARRAY_SIZE(invalid); i++) {
+        errno = 0;
+        assert_null(dse_base64_decode(invalid[i], &len));
+        assert_int_equal(errno, EINVAL);
+        assert_int_equal(len, 0);
+    }
+}
+
+
+void test_codec__z85(void** state)
+{
+    UNUSED(state);
+
+    /* ZeroMQ RFC 32 test vector, and partial groups. */
+    TC_CODEC tc[] = {
+        { .base = "", .base_len = 0, .enc = "" },
+        { .base = "\x86\x4f\xd2\x6f\xb5\x59\xf7\x5b",
+            .base_len = 8,
+            .enc = "HelloWorld" },
+        { .base = "\x86", .base_len = 1, .enc = "H5" },
+        { .base = "\x86\x4f\xd2\x6f\xb5", .base_len = 5, .enc = "HelloWe" },
+        { .base = "\0\0\0\0", .base_len = 4, .enc = "00000" },
+        { .base = "\xff\xff\xff\xff", .base_len = 4, .enc = "%nSc0" },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(tc); i++) {
+        char* encoded = dse_z85_encode(tc[i].base, tc[i].base_len);
+        assert_string_equal(encoded, tc[i].enc);
+        size_t len = 0;
+        char*  decoded = dse_z85_decode(encoded, &len);
+        assert_non_null(decoded);
+        assert_int_equal(len, tc[i].base_len);
+        assert_memory_equal(decoded, tc[i].base, len);
+        assert_int_equal(decoded[len], '\0');
+        free(encoded);
+        free(decoded);
+    }
+
+    /* Invalid encodings (character, length and overflow). */
+    const char* invalid[] = { "Hello~orld", "HelloW", "#####" };
+    for (size_t i = 0; i < ARRAY_SIZE(invalid); i++) {
+        size_t len = 0;
+        errno = 0;
+        assert_null(dse_z85_decode(invalid[i], &len));
+        assert_int_equal(errno, EINVAL);
+        assert_int_equal(len, 0);
+    }
+}
+
+
+void test_codec__roundtrip(void** state)
+{
+    UNUSED(state);
+
+    const char* names[] = { "ascii85", "base64", "z85" };
+    char        data[301];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (i % 50 < 10) ? 0 : (char)(i * 13 + 7);
+    }
+
+    for (size_t n = 0; n < ARRAY_SIZE(names); n++) {
+        const DseTextCodec* codec = dse_text_codec_find(names[n]);
+        assert_non_null(codec);
+        assert_string_equal(codec->name, names[n]);
+        for (size_t len = 0; len <= sizeof(data); len += 7) {
+            char*  encoded = codec->encode(data, len);
+            size_t dec_len = 0;
+            char*  decoded = codec->decode(encoded, &dec_len);
+            assert_non_null(decoded);
+            assert_int_equal(dec_len, len);
+            assert_memory_equal(decoded, data, len);
+            free(encoded);
+            free(decoded);
+        }
+    }
+
+    errno = 0;
+    assert_null(dse_text_codec_find("base32"));
+    assert_int_equal(errno, EINVAL);
+    assert_null(dse_text_codec_find(NULL));
+}
+
+
+int run_codec_tests(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_codec__base64),
+        cmocka_unit_test(test_codec__z85),
+        cmocka_unit_test(test_codec__roundtrip),
+    };
+
+    return cmocka_run_group_tests_name("CODEC", tests, NULL, NULL);
+}
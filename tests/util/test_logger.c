@@ -0,0 +1,442 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#define _GNU_SOURCE
+#define LOG_MODULE "test_logger"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <dse/testing.h>
+#include <dse/logger.h>
+#include <dse/clib/util/logger.h>
+
+
+#define THREADS  4
+#define MESSAGES 2000
+
+
+typedef struct LoggerMock {
+    FILE*   stream;
+    uint8_t log_level;
+} LoggerMock;
+
+
+static int test_setup(void** state)
+{
+    LoggerMock* mock = calloc(1, sizeof(LoggerMock));
+    mock->stream = tmpfile();
+    mock->log_level = __log_level__;
+    __log_level__ = LOG_TRACE;
+    *state = mock;
+    return 0;
+}
+
+
+static int test_teardown(void** state)
+{
+    LoggerMock* mock = *state;
+    dse_logger_stop();
+    __log_level__ = mock->log_level;
+    fclose(mock->stream);
+    free(mock);
+    return 0;
+}
+
+
+static char* read_stream(FILE* stream)
+{
+    long size = ftell(stream);
+    char* text = calloc(size + 1, 1);
+    rewind(stream);
+    assert_int_equal(fread(text, 1, size, stream), size);
+    return text;
+}
+
+
+static size_t count_lines(const char* text, const char* match)
+{
+    size_t count = 0;
+    for (const char* p = text; (p = strstr(p, match)); p++) count++;
+    return count;
+}
+
+
+void test_logger__format(void** state)
+{
+    LoggerMock* mock = *state;
+
+    DseLoggerConfig config = { .stream = mock->stream };
+    assert_int_equal(dse_logger_start(&config), 0);
+    assert_int_equal(dse_logger_start(&config), EALREADY);
+
+    const char* null_str = NULL;
+    log_notice("int %d %5i %-4u| %x %*d %c %%", -42, 7, 3u, 255, 6, 12, 'z');
+    log_notice("long %ld %lld %zu %jd %td %hd", -1L, 1LL << 40, (size_t)12,
+        (intmax_t)-5, (ptrdiff_t)9, (short)3);
+    log_notice("float %.2f %8.3e %.*f %Lg", 3.14159, 1234.5, 1, 2.25,
+        (long double)0.5);
+    log_notice("string %s %-6s| %.3s %s", "abc", "de", "fghij", null_str);
+    log_notice("positional %1$d %1$d", 5);
+    log_info("info %d", 1);
+    dse_logger_flush();
+
+    char* text = read_stream(mock->stream);
+    char  expect[1024];
+    snprintf(expect, sizeof(expect),
+        "int -42     7 3   | ff     12 z %%" LOG_COLOUR_NONE "\n"
+        "long -1 1099511627776 12 -5 9 3" LOG_COLOUR_NONE "\n"
+        "float 3.14 1.234e+03 2.2 0.5" LOG_COLOUR_NONE "\n"
+        "string abc de    | fgh (null)" LOG_COLOUR_NONE "\n");
+    assert_memory_equal(text, expect, strlen(expect));
+
+    /* Positional arguments are formatted on the calling thread. */
+    const char* p = text + strlen(expect);
+    const char* positional = "positional 5 5" LOG_COLOUR_NONE "\n";
+    assert_memory_equal(p, positional, strlen(positional));
+    p += strlen(positional);
+    snprintf(expect, sizeof(expect), LOG_COLOUR_NONE "[INFO]   info 1 (%s:",
+        __func__);
+    assert_memory_equal(p, expect, strlen(expect));
+    free(text);
+
+    DseLoggerStats stats = dse_logger_stats();
+    assert_int_equal(stats.records, 6);
+    assert_int_equal(stats.dropped, 0);
+}
+
+
+void test_logger__oversized(void** state)
+{
+    LoggerMock* mock = *state;
+
+    DseLoggerConfig config = { .stream = mock->stream };
+    assert_int_equal(dse_logger_start(&config), 0);
+
+    /* Oversized messages are written (in full) to the console. */
+    char large[2000];
+    memset(large, 'x', sizeof(large) - 1);
+    large[sizeof(large) - 1] = '\0';
+    FILE* console = tmpfile();
+    fflush(stdout);
+    int stdout_fd = dup(fileno(stdout));
+    dup2(fileno(console), fileno(stdout));
+    log_notice("before %d", 1);
+    log_notice("large %s", large);
+    log_notice("after %d", 2);
+    fflush(stdout);
+    dup2(stdout_fd, fileno(stdout));
+    close(stdout_fd);
+    dse_logger_flush();
+
+    char* text = read_stream(console);
+    assert_non_null(strstr(text, large));
+    free(text);
+    fclose(console);
+
+    /* Pending records are flushed first. */
+    text = read_stream(mock->stream);
+    assert_non_null(strstr(text, "before 1"));
+    assert_non_null(strstr(text, "after 2"));
+    assert_null(strstr(text, "large"));
+    free(text);
+
+    DseLoggerStats stats = dse_logger_stats();
+    assert_int_equal(stats.records, 2);
+}
+
+
+void test_logger__precision(void** state)
+{
+    LoggerMock* mock = *state;
+
+    DseLoggerConfig config = { .stream = mock->stream };
+    assert_int_equal(dse_logger_start(&config), 0);
+
+    /* Strings with a precision need not be terminated, the string is at the
+       end of a page which is followed by an inaccessible page. */
+    long  page = sysconf(_SC_PAGESIZE);
+    char* map = mmap(NULL, 2 * page, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    assert_true(map != MAP_FAILED);
+    assert_int_equal(mprotect(map + page, page, PROT_NONE), 0);
+    char* name = map + page - 4;
+    memcpy(name, "abcd", 4);
+    log_notice("name %.*s %.4s %.2s %-6.*s| %.*s", 4, name, name, name, 3,
+        name, -1, "ef");
+    dse_logger_flush();
+    munmap(map, 2 * page);
+
+    char*       text = read_stream(mock->stream);
+    const char* expect = "name abcd abcd ab abc   | ef" LOG_COLOUR_NONE "\n";
+    assert_string_equal(text, expect);
+    free(text);
+}
+
+
+static void* _log_thread(void* arg)
+{
+    int id = *(int*)arg;
+    for (int i = 0; i < MESSAGES; i++) {
+        log_notice("thread %d message %d %s", id, i, "payload");
+    }
+    return NULL;
+}
+
+
+void test_logger__threads(void** state)
+{
+    LoggerMock* mock = *state;
+
+    DseLoggerConfig config = { .stream = mock->stream,
+        .ring_size = 4096,
+        .policy = DSE_LOGGER_BLOCK };
+    assert_int_equal(dse_logger_start(&config), 0);
+
+    pthread_t thread[THREADS];
+    int       id[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        id[i] = i;
+        pthread_create(&thread[i], NULL, _log_thread, &id[i]);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    dse_logger_flush();
+
+    char* text = read_stream(mock->stream);
+    assert_int_equal(count_lines(text, "\n"), THREADS * MESSAGES);
+    for (int i = 0; i < THREADS; i++) {
+        /* Messages of each thread are in order. */
+        char first[64], last[64];
+        snprintf(first, sizeof(first), "thread %d message 0 payload", i);
+        snprintf(last, sizeof(last), "thread %d message %d payload", i,
+            MESSAGES - 1);
+        assert_non_null(strstr(text, first));
+        assert_true(strstr(text, first) < strstr(text, last));
+    }
+    free(text);
+
+    DseLoggerStats stats = dse_logger_stats();
+    assert_int_equal(stats.records, THREADS * MESSAGES);
+    assert_int_equal(stats.dropped, 0);
+}
+
+
+void test_logger__drop(void** state)
+{
+    LoggerMock* mock = *state;
+
+    DseLoggerConfig config = { .stream = mock->stream, .ring_size = 4096 };
+    assert_int_equal(dse_logger_start(&config), 0);
+    for (int i = 0; i < MESSAGES; i++) {
+        log_notice("message %d %s", i, "payload");
+    }
+    dse_logger_flush();
+
+    DseLoggerStats stats = dse_logger_stats();
+    assert_int_equal(stats.records + stats.dropped, MESSAGES);
+    char* text = read_stream(mock->stream);
+    assert_int_equal(count_lines(text, "payload"), stats.records);
+    if (stats.dropped) {
+        assert_non_null(strstr(text, "records dropped"));
+    }
+    free(text);
+}
+
+
+void test_logger__binary(void** state)
+{
+    LoggerMock* mock = *state;
+
+    DseLoggerConfig config = { .stream = mock->stream,
+        .format = DSE_LOGGER_BINARY };
+    assert_int_equal(dse_logger_start(&config), 0);
+    for (int i = 0; i < 3; i++) {
+        log_notice("loop %d %s %.1f", i, "abc", i * 0.5);
+    }
+    log_notice("positional %1$d %1$d", 5);
+    log_info("info %s", "x");
+    int info_line = __LINE__ - 1;
+    dse_logger_stop();
+
+    /* Second session, on the same stream. */
+    assert_int_equal(dse_logger_start(&config), 0);
+    log_notice("loop %d %s %.1f", 9, "restart", 1.0);
+    dse_logger_stop();
+
+    /* Each call site is defined once (per session). */
+    char*  data = read_stream(mock->stream);
+    size_t size = ftell(mock->stream);
+    size_t sites = 0;
+    for (char* p = data; (p = memmem(p, size - (p - data), "loop %d", 7));
+         p++) {
+        sites++;
+    }
+    assert_int_equal(sites, 2);
+    free(data);
+
+    /* Decode. */
+    FILE* text = tmpfile();
+    rewind(mock->stream);
+    assert_int_equal(dse_logger_decode(mock->stream, text, false), 0);
+    char* decoded = read_stream(text);
+    char  expect[1024];
+    snprintf(expect, sizeof(expect),
+        "loop 0 abc 0.0" LOG_COLOUR_NONE "\n"
+        "loop 1 abc 0.5" LOG_COLOUR_NONE "\n"
+        "loop 2 abc 1.0" LOG_COLOUR_NONE "\n"
+        "positional 5 5" LOG_COLOUR_NONE "\n"
+        LOG_COLOUR_NONE "[INFO]   info x (%s:%d)" LOG_COLOUR_NONE "\n"
+        "loop 9 restart 1.0" LOG_COLOUR_NONE "\n",
+        __func__, info_line);
+    assert_string_equal(decoded, expect);
+    free(decoded);
+    fclose(text);
+
+    /* Timestamps. */
+    text = tmpfile();
+    rewind(mock->stream);
+    assert_int_equal(dse_logger_decode(mock->stream, text, true), 0);
+    decoded = read_stream(text);
+    assert_int_equal(decoded[0], '[');
+    assert_int_equal(count_lines(decoded, "\n["), 5);
+    free(decoded);
+    fclose(text);
+
+    /* Not a trace. */
+    text = tmpfile();
+    fputs("loop 0 abc 0.0\n", text);
+    rewind(text);
+    assert_int_equal(dse_logger_decode(text, mock->stream, false), EINVAL);
+    assert_int_equal(dse_logger_decode(NULL, text, false), EINVAL);
+    fclose(text);
+}
+
+
+static int _decode_corrupt(const char* data, size_t size, uint64_t s_len)
+{
+    /* The string argument is preceded by its length slot. */
+    char* trace = malloc(size);
+    memcpy(trace, data, size);
+    char* s = memmem(trace, size, "abcdefgh", 8);
+    assert_non_null(s);
+    memcpy(s - sizeof(uint64_t), &s_len, sizeof(uint64_t));
+
+    FILE* in = tmpfile();
+    FILE* out = tmpfile();
+    fwrite(trace, 1, size, in);
+    rewind(in);
+    int rc = dse_logger_decode(in, out, false);
+    fclose(out);
+    fclose(in);
+    free(trace);
+    return rc;
+}
+
+
+void test_logger__binary_corrupt(void** state)
+{
+    LoggerMock* mock = *state;
+
+    DseLoggerConfig config = { .stream = mock->stream,
+        .format = DSE_LOGGER_BINARY };
+    assert_int_equal(dse_logger_start(&config), 0);
+    log_notice("corrupt %s %d", "abcdefgh", 42);
+    dse_logger_stop();
+
+    char*  data = read_stream(mock->stream);
+    size_t size = ftell(mock->stream);
+    assert_int_equal(_decode_corrupt(data, size, 8), 0);
+    /* Length beyond the arguments of the event. */
+    assert_int_equal(_decode_corrupt(data, size, 1000), EINVAL);
+    assert_int_equal(_decode_corrupt(data, size, UINT64_MAX - 1), EINVAL);
+    /* String not terminated at its length. */
+    assert_int_equal(_decode_corrupt(data, size, 4), EINVAL);
+    free(data);
+}
+
+
+/* Calls below the compile-time minimum level are removed (including the
+evaluation of their arguments). */
+#undef LOG_LEVEL_MIN
+#define LOG_LEVEL_MIN LOG_INFO
+
+static int _log_eliminated(void)
+{
+    int count = 0;
+    log_trace("trace %d", count++);
+    log_debug("debug %d", count++);
+    log_info("info %d", count++);
+    return count;
+}
+
+#undef LOG_LEVEL_MIN
+#define LOG_LEVEL_MIN LOG_TRACE
+
+
+void test_logger__module(void** state)
+{
+    LoggerMock* mock = *state;
+
+    DseLoggerConfig config = { .stream = mock->stream };
+    assert_int_equal(dse_logger_start(&config), 0);
+
+    /* Module level, otherwise the global level. */
+    __log_level__ = LOG_INFO;
+    log_trace("hidden %d", 1);
+    assert_int_equal(dse_logger_set_module_level("test_logger", LOG_TRACE), 0);
+    log_trace("trace %d", 2);
+    assert_int_equal(_log_eliminated(), 1);
+    assert_int_equal(
+        dse_logger_set_module_level("test_logger", LOG_LEVEL_INHERIT), 0);
+    log_trace("hidden %d", 3);
+    dse_logger_flush();
+
+    char* text = read_stream(mock->stream);
+    assert_null(strstr(text, "hidden"));
+    assert_non_null(strstr(text, "trace 2"));
+    assert_non_null(strstr(text, "info 0"));
+    assert_int_equal(count_lines(text, "\n"), 2);
+    free(text);
+
+    /* Levels set before a module is registered. */
+    uint8_t level = LOG_LEVEL_INHERIT;
+    assert_int_equal(dse_logger_set_module_level("loaded", LOG_DEBUG), 0);
+    __log_module_register__("loaded", &level);
+    assert_int_equal(level, LOG_DEBUG);
+    assert_int_equal(dse_logger_set_module_level("loaded", LOG_ERROR), 0);
+    assert_int_equal(level, LOG_ERROR);
+    __log_module_unregister__(&level);
+    assert_int_equal(dse_logger_set_module_level("loaded", LOG_TRACE), 0);
+    assert_int_equal(level, LOG_ERROR);
+
+    /* Bad arguments. */
+    assert_int_equal(dse_logger_set_module_level(NULL, LOG_TRACE), EINVAL);
+    assert_int_equal(dse_logger_set_module_level("loaded", 42), EINVAL);
+}
+
+
+int run_logger_tests(void)
+{
+    void* s = test_setup;
+    void* t = test_teardown;
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_logger__format, s, t),
+        cmocka_unit_test_setup_teardown(test_logger__oversized, s, t),
+        cmocka_unit_test_setup_teardown(test_logger__precision, s, t),
+        cmocka_unit_test_setup_teardown(test_logger__threads, s, t),
+        cmocka_unit_test_setup_teardown(test_logger__drop, s, t),
+        cmocka_unit_test_setup_teardown(test_logger__module, s, t),
+        cmocka_unit_test_setup_teardown(test_logger__binary, s, t),
+        cmocka_unit_test_setup_teardown(test_logger__binary_corrupt, s, t),
+    };
+
+    return cmocka_run_group_tests_name("LOGGER", tests, NULL, NULL);
+}
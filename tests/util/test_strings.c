@@ -0,0 +1,213 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dse/testing.h>
+#include <dse/clib/util/strings.h>
+
+
+#define UNUSED(x) ((void)x)
+
+
+void test_strings__expand_vars(void** state)
+{
+    UNUSED(state);
+
+    setenv("STRINGS_FOO", "foo", 1);
+    setenv("STRINGS_EMPTY", "", 1);
+    unsetenv("STRINGS_BAR");
+
+    struct {
+        const char* source;
+        const char* expect;
+    } tc[] = {
+        { "", "" },
+        { "plain", "plain" },
+        { "${STRINGS_FOO}", "foo" },
+        { "a${STRINGS_FOO}b${STRINGS_FOO}c", "afoobfooc" },
+        { "${STRINGS_BAR:-bar}", "bar" },
+        { "${STRINGS_BAR:-}", "" },
+        { "${STRINGS_BAR}", "STRINGS_BAR" },
+        { "${STRINGS_FOO:-bar}", "foo" },
+        { "${STRINGS_EMPTY:-bar}", "" },
+        { "${STRINGS_BAR:-a:-b}", "a:-b" },
+        { "x${STRINGS_FOO", "x${STRINGS_FOO" },
+        { "$STRINGS_FOO}", "$STRINGS_FOO}" },
+    };
+    for (size_t i = 0; i < sizeof(tc) / sizeof(tc[0]); i++) {
+        char* result = dse_expand_vars(tc[i].source);
+        assert_non_null(result);
+        assert_string_equal(result, tc[i].expect);
+        free(result);
+    }
+
+    assert_null(dse_expand_vars_env(NULL, NULL, NULL));
+    unsetenv("STRINGS_FOO");
+    unsetenv("STRINGS_EMPTY");
+}
+
+
+void test_strings__expand_vars_long(void** state)
+{
+    UNUSED(state);
+
+    /* Results are not limited in length. */
+    size_t value_len = 4000;
+    char*  value = malloc(value_len + 1);
+    memset(value, 'v', value_len);
+    value[value_len] = '\0';
+    setenv("STRINGS_LONG", value, 1);
+
+    const char* source = "<${STRINGS_LONG}${STRINGS_LONG}>";
+    size_t      len = 0;
+    char*       result = dse_expand_vars_env(source, NULL, &len);
+    assert_non_null(result);
+    assert_int_equal(len, value_len * 2 + 2);
+    assert_int_equal(strlen(result), len);
+    assert_int_equal(result[0], '<');
+    assert_int_equal(result[len - 1], '>');
+    assert_memory_equal(result + 1, value, value_len);
+    assert_memory_equal(result + 1 + value_len, value, value_len);
+    free(result);
+
+    unsetenv("STRINGS_LONG");
+    free(value);
+}
+
+
+void test_strings__env_snapshot(void** state)
+{
+    UNUSED(state);
+
+    setenv("STRINGS_SNAP", "before", 1);
+    DseEnvSnapshot* env = dse_env_snapshot_create();
+    assert_non_null(env);
+    setenv("STRINGS_SNAP", "after", 1);
+    setenv("STRINGS_SNAP_NEW", "new", 1);
+
+    /* The snapshot is not affected by later changes. */
+    assert_string_equal(dse_env_snapshot_get(env, "STRINGS_SNAP"), "before");
+    assert_null(dse_env_snapshot_get(env, "STRINGS_SNAP_NEW"));
+    assert_null(dse_env_snapshot_get(env, "STRINGS_SNA"));
+    assert_null(dse_env_snapshot_get(env, "STRINGS_SNAP_"));
+    assert_null(dse_env_snapshot_get(env, NULL));
+    assert_null(dse_env_snapshot_get(NULL, "STRINGS_SNAP"));
+
+    char* result = dse_expand_vars_env(
+        "${STRINGS_SNAP}/${STRINGS_SNAP_NEW:-none}", env, NULL);
+    assert_string_equal(result, "before/none");
+    free(result);
+    result = dse_expand_vars_env(
+        "${STRINGS_SNAP}/${STRINGS_SNAP_NEW:-none}", NULL, NULL);
+    assert_string_equal(result, "after/new");
+    free(result);
+
+    dse_env_snapshot_destroy(env);
+    dse_env_snapshot_destroy(NULL);
+    unsetenv("STRINGS_SNAP");
+    unsetenv("STRINGS_SNAP_NEW");
+}
+
+
+void test_strings__strbuf(void** state)
+{
+    UNUSED(state);
+
+    DseStrBuf b;
+    dse_strbuf_init(&b);
+    assert_string_equal(dse_strbuf_str(&b), "");
+
+    /* Inline. */
+    assert_int_equal(dse_strbuf_append(&b, "foo"), 0);
+    assert_int_equal(dse_strbuf_append_n(&b, "barbaz", 3), 0);
+    assert_null(b.heap);
+    assert_int_equal(b.len, 6);
+    assert_string_equal(dse_strbuf_str(&b), "foobar");
+
+    /* Heap, with geometric growth. */
+    for (int i = 0; i < 100; i++) {
+        assert_int_equal(dse_strbuf_appendf(&b, "/%03d", i), 0);
+    }
+    assert_non_null(b.heap);
+    assert_int_equal(b.len, 6 + 100 * 4);
+    assert_int_equal(strlen(dse_strbuf_str(&b)), b.len);
+    assert_memory_equal(dse_strbuf_str(&b), "foobar/000/001", 14);
+    assert_string_equal(dse_strbuf_str(&b) + b.len - 4, "/099");
+
+    /* Formatted append which crosses from inline to heap. */
+    DseStrBuf f = { 0 };
+    assert_int_equal(dse_strbuf_appendf(&f, "%s", "short"), 0);
+    assert_int_equal(dse_strbuf_appendf(&f, "%0100d", 7), 0);
+    assert_int_equal(f.len, 105);
+    assert_non_null(f.heap);
+    assert_int_equal(f.heap[104], '7');
+    assert_int_equal(f.heap[105], '\0');
+    assert_memory_equal(f.heap, "short000", 8);
+    dse_strbuf_destroy(&f);
+
+    /* Reserve and shrink. */
+    assert_int_equal(dse_strbuf_reserve(&b, 10000), 0);
+    assert_true(b.size > 10000);
+    assert_int_equal(dse_strbuf_shrink(&b), 0);
+    assert_int_equal(b.size, b.len + 1);
+    dse_strbuf_clear(&b);
+    assert_string_equal(dse_strbuf_str(&b), "");
+    dse_strbuf_append(&b, "foo");
+    assert_int_equal(dse_strbuf_shrink(&b), 0);
+    assert_null(b.heap);
+    assert_string_equal(dse_strbuf_str(&b), "foo");
+
+    /* Release (from inline). */
+    char* str = dse_strbuf_release(&b);
+    assert_string_equal(str, "foo");
+    assert_int_equal(b.len, 0);
+    assert_string_equal(dse_strbuf_str(&b), "");
+    free(str);
+
+    assert_int_equal(dse_strbuf_append(&b, NULL), EINVAL);
+    assert_int_equal(dse_strbuf_append(NULL, "foo"), EINVAL);
+    dse_strbuf_destroy(&b);
+    dse_strbuf_destroy(NULL);
+}
+
+
+void test_strings__path_cat(void** state)
+{
+    UNUSED(state);
+
+    char* path = dse_path_cat("a/b", "c");
+    assert_string_equal(path, "a/b/c");
+    free(path);
+    path = dse_path_cat(NULL, "c");
+    assert_string_equal(path, "c");
+    free(path);
+    path = dse_path_cat("a", NULL);
+    assert_string_equal(path, "a");
+    free(path);
+    assert_null(dse_path_cat(NULL, NULL));
+
+    /* Longer than the inline storage of a string buffer. */
+    char dir[100];
+    memset(dir, 'd', sizeof(dir) - 1);
+    dir[sizeof(dir) - 1] = '\0';
+    path = dse_path_cat(dir, "file");
+    assert_int_equal(strlen(path), strlen(dir) + 5);
+    assert_string_equal(path + strlen(dir), "/file");
+    free(path);
+}
+
+int run_strings_tests(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_strings__expand_vars),
+        cmocka_unit_test(test_strings__expand_vars_long),
+        cmocka_unit_test(test_strings__env_snapshot),
+        cmocka_unit_test(test_strings__strbuf),
+        cmocka_unit_test(test_strings__path_cat),
+    };
+
+    return cmocka_run_group_tests_name("STRINGS", tests, NULL, NULL);
+}
@@ -0,0 +1,98 @@
+// Copyright 2025 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <dse/testing.h>
+#include <dse/clib/util/threadpool.h>
+
+
+#define UNUSED(x)     ((void)x)
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+
+typedef struct JobArg {
+    DseThreadPool* pool;
+    size_t*        counter;
+    size_t         children;
+} JobArg;
+
+
+static void _count_job(void* arg)
+{
+    JobArg* a = arg;
+    __atomic_fetch_add(a->counter, 1, __ATOMIC_SEQ_CST);
+}
+
+
+static void _nested_job(void* arg)
+{
+    JobArg* a = arg;
+    for (size_t i = 0; i < a->children; i++) {
+        dse_threadpool_submit(a->pool, _count_job, a);
+    }
+    __atomic_fetch_add(a->counter, 1, __ATOMIC_SEQ_CST);
+}
+
+
+void test_threadpool__submit_wait(void** state)
+{
+    UNUSED(state);
+
+    size_t threads[] = { 0, 1, 4 };
+    for (size_t t = 0; t < ARRAY_SIZE(threads); t++) {
+        DseThreadPool* pool = dse_threadpool_create(threads[t]);
+        assert_non_null(pool);
+        assert_int_equal(dse_threadpool_size(pool), threads[t]);
+
+        /* Several rounds, each ending with a barrier. */
+        size_t counter = 0;
+        JobArg arg = { .counter = &counter };
+        for (size_t round = 1; round <= 10; round++) {
+            for (size_t i = 0; i < 100; i++) {
+                dse_threadpool_submit(pool, _count_job, &arg);
+            }
+            dse_threadpool_wait(pool);
+            assert_int_equal(counter, round * 100);
+        }
+
+        /* Jobs which submit jobs. */
+        counter = 0;
+        JobArg nested = { .pool = pool, .counter = &counter, .children = 50 };
+        for (size_t i = 0; i < 4; i++) {
+            dse_threadpool_submit(pool, _nested_job, &nested);
+        }
+        dse_threadpool_wait(pool);
+        assert_int_equal(counter, 4 * 51);
+
+        dse_threadpool_destroy(pool);
+    }
+}
+
+
+void test_threadpool__bad_args(void** state)
+{
+    UNUSED(state);
+
+    assert_int_equal(dse_threadpool_submit(NULL, _count_job, NULL), -EINVAL);
+    DseThreadPool* pool = dse_threadpool_create(1);
+    assert_int_equal(dse_threadpool_submit(pool, NULL, NULL), -EINVAL);
+    dse_threadpool_wait(pool);
+    dse_threadpool_destroy(pool);
+
+    /* NULL pool is tolerated. */
+    assert_int_equal(dse_threadpool_size(NULL), 0);
+    dse_threadpool_wait(NULL);
+    dse_threadpool_destroy(NULL);
+}
+
+
+int run_threadpool_tests(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_threadpool__submit_wait),
+        cmocka_unit_test(test_threadpool__bad_args),
+    };
+
+    return cmocka_run_group_tests_name("THREADPOOL", tests, NULL, NULL);
+}
@@ -2,7 +2,11 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include <yaml.h>
 #include <dse/testing.h>
 #include <dse/clib/util/yaml.h>
@@ -430,6 +434,591 @@ void test_yaml_interpolation(void** state)
 }
 
 
+void test_yaml_interpolation_tree(void** state)
+{
+    UNUSED(state);
+
+    YamlNode* yaml_doc = dse_yaml_load_single_doc(UINT_FILE);
+    assert_non_null(yaml_doc);
+
+    /* All scalars are expanded in one traversal. */
+    setenv("FOO3", "43", 1);
+    DseEnvSnapshot* env = dse_env_snapshot_create();
+    unsetenv("FOO3");
+    assert_int_equal(dse_yaml_interpolate_env_tree(yaml_doc, env), 0);
+    dse_env_snapshot_destroy(env);
+    assert_string_equal(dse_yaml_get_scalar(yaml_doc, "bar2"), "123");
+    assert_string_equal(dse_yaml_get_scalar(yaml_doc, "foo2/foo3"), "43");
+
+    /* Without a snapshot (the environment at the time of the call). */
+    dse_yaml_destroy_node(yaml_doc);
+    yaml_doc = dse_yaml_load_single_doc(UINT_FILE);
+    assert_int_equal(dse_yaml_interpolate_env_tree(yaml_doc, NULL), 0);
+    assert_string_equal(dse_yaml_get_scalar(yaml_doc, "foo2/foo3"), "42");
+    assert_int_equal(dse_yaml_interpolate_env_tree(NULL, NULL), EINVAL);
+
+    dse_yaml_destroy_node(yaml_doc);
+}
+
+typedef struct ValuesConfig {
+    bool        lc_true;
+    bool        numeric_false;
+    int         numeric_int;
+    int         negative;
+    uint32_t    hex;
+    double      positive;
+    const char* simple;
+    const char* quotes;
+    int         missing;
+} ValuesConfig;
+
+
+void test_yaml_get_values(void** state)
+{
+    UNUSED(state);
+
+    YamlNode* doc = dse_yaml_load_single_doc(FILE);
+    assert_non_null(doc);
+
+    YamlValueDesc desc[] = {
+        { "bools/lc_true", YAML_VALUE_BOOL, offsetof(ValuesConfig, lc_true) },
+        { "bools/numeric_false", YAML_VALUE_BOOL,
+            offsetof(ValuesConfig, numeric_false) },
+        { "integers/negative", YAML_VALUE_INT,
+            offsetof(ValuesConfig, negative) },
+        { "integers/hex", YAML_VALUE_UINT, offsetof(ValuesConfig, hex) },
+        { "doubles/positive", YAML_VALUE_DOUBLE,
+            offsetof(ValuesConfig, positive) },
+        { "strings/simple", YAML_VALUE_STRING,
+            offsetof(ValuesConfig, simple) },
+        { "integers/quotes", YAML_VALUE_SCALAR,
+            offsetof(ValuesConfig, quotes) },
+    };
+    ValuesConfig config = { .numeric_false = true, .missing = 7 };
+    assert_int_equal(dse_yaml_get_values(doc, desc, ARRAY_SIZE(desc), &config),
+        EINVAL); /* bools/numeric_false is not a bool. */
+    assert_true(config.lc_true);
+    assert_true(config.numeric_false); /* Not modified. */
+    assert_int_equal(config.negative, -10);
+    assert_int_equal(config.hex, 0x23);
+    assert_double_equal(config.positive, 10.02, 0.0);
+    assert_string_equal(config.simple, "simple");
+    assert_string_equal(config.quotes, "42");
+    assert_int_equal(config.missing, 7);
+
+    /* All values set (second call uses the cached values). */
+    desc[1].type = YAML_VALUE_INT;
+    desc[1].offset = offsetof(ValuesConfig, numeric_int);
+    config.numeric_int = 7;
+    assert_int_equal(
+        dse_yaml_get_values(doc, desc, ARRAY_SIZE(desc), &config), 0);
+    assert_int_equal(config.numeric_int, 0);
+    assert_true(config.numeric_false);
+    assert_int_equal(config.hex, 0x23);
+
+    /* Missing path, and bad arguments. */
+    YamlValueDesc missing = { "integers/missing", YAML_VALUE_INT,
+        offsetof(ValuesConfig, missing) };
+    assert_int_equal(dse_yaml_get_values(doc, &missing, 1, &config), EINVAL);
+    assert_int_equal(config.missing, 7);
+    assert_int_equal(dse_yaml_get_values(doc, NULL, 0, &config), 0);
+    assert_int_equal(dse_yaml_get_values(NULL, desc, 1, &config), EINVAL);
+    assert_int_equal(dse_yaml_get_values(doc, desc, 1, NULL), EINVAL);
+
+    dse_yaml_destroy_node(doc);
+}
+
+
+typedef struct UintConfig {
+    unsigned int foo;
+    int          foo3;
+    bool         b;
+    double       bar1;
+    int          missing;
+} UintConfig;
+
+
+void test_yaml_get_values_paths(void** state)
+{
+    UNUSED(state);
+
+    /* Paths without a parent, a missing parent, and values of a parent which
+    are not adjacent (with interpolation, as the getters). */
+    YamlNode* doc = dse_yaml_load_single_doc(UINT_FILE);
+    assert_non_null(doc);
+    doc->__inter__ = dse_yaml_interpolate_env;
+    YamlValueDesc desc[] = {
+        { "foo", YAML_VALUE_UINT, offsetof(UintConfig, foo) },
+        { "foo2/foo3", YAML_VALUE_INT, offsetof(UintConfig, foo3) },
+        { "b", YAML_VALUE_BOOL, offsetof(UintConfig, b) },
+        { "bar1", YAML_VALUE_DOUBLE, offsetof(UintConfig, bar1) },
+        { "missing/foo3", YAML_VALUE_INT, offsetof(UintConfig, missing) },
+        { "foo2/foo", YAML_VALUE_INT, offsetof(UintConfig, missing) },
+    };
+    UintConfig config = { .missing = 7 };
+    assert_int_equal(
+        dse_yaml_get_values(doc, desc, ARRAY_SIZE(desc), &config), EINVAL);
+    assert_int_equal(config.foo, 123);
+    assert_int_equal(config.foo3, 42);
+    assert_true(config.b);
+    assert_double_equal(config.bar1, 10.0, 0.0);
+    assert_int_equal(config.missing, 7);
+
+    dse_yaml_destroy_node(doc);
+}
+
+
+void test_yaml_get_cached(void** state)
+{
+    UNUSED(state);
+
+    YamlNode* doc = dse_yaml_load_single_doc(UINT_FILE);
+    assert_non_null(doc);
+    int      int_value = 0;
+    uint32_t uint_value = 0;
+    double   double_value = 0;
+
+    /* Repeated calls return the cached value. */
+    for (int i = 0; i < 3; i++) {
+        assert_int_equal(dse_yaml_get_int(doc, "foo2/foo3", &int_value), 22);
+        assert_int_equal(dse_yaml_get_double(doc, "bar1", &double_value), 0);
+        assert_double_equal(double_value, 10.0, 0.0);
+    }
+
+    /* Interpolation replaces the scalar, and invalidates the values. */
+    setenv("FOO3", "44", 1);
+    doc->__inter__ = dse_yaml_interpolate_env;
+    assert_int_equal(dse_yaml_get_int(doc, "foo2/foo3", &int_value), 0);
+    assert_int_equal(int_value, 44);
+    assert_int_equal(dse_yaml_get_uint(doc, "bar2", &uint_value), 0);
+    assert_int_equal(uint_value, 123);
+    unsetenv("FOO3");
+
+    dse_yaml_destroy_node(doc);
+}
+
+void test_yaml_compact(void** state)
+{
+    UNUSED(state);
+
+    YamlCompact* c = dse_yaml_compact_load_file(FILENAME);
+    assert_non_null(c);
+    YamlDocList* doc_list = dse_yaml_load_file(FILENAME, NULL);
+    assert_non_null(doc_list);
+    assert_int_equal(dse_yaml_compact_doc_count(c), hashlist_length(doc_list));
+    assert_true(dse_yaml_compact_size(c) > 0);
+
+    /* Same results as the YamlNode DOM. */
+    const char* path[] = { "kind", "metadata/name",
+        "spec/connection/transport/redispubsub/uri",
+        "spec/connection/transport/redispubsub/timeout", "spec/models", "foo",
+        "foo1", "bar", "missing", "kind/missing", "spec/models/missing" };
+    for (size_t d = 0; d < hashlist_length(doc_list); d++) {
+        YamlNode*              doc = hashlist_at(doc_list, d);
+        const YamlCompactNode* cdoc = dse_yaml_compact_doc(c, d);
+        assert_non_null(cdoc);
+        for (size_t i = 0; i < ARRAY_SIZE(path); i++) {
+            YamlNode*              n = dse_yaml_find_node(doc, path[i]);
+            const YamlCompactNode* cn =
+                dse_yaml_compact_find_node(c, cdoc, path[i]);
+            if (n == NULL) {
+                assert_null(cn);
+                continue;
+            }
+            assert_non_null(cn);
+            assert_int_equal(cn->node_type, n->node_type);
+            if (n->scalar) {
+                assert_string_equal(dse_yaml_compact_scalar(c, cn), n->scalar);
+            } else {
+                assert_null(dse_yaml_compact_scalar(c, cn));
+            }
+        }
+    }
+    assert_null(dse_yaml_compact_doc(c, hashlist_length(doc_list)));
+
+    /* Sequences keep document order. */
+    const YamlCompactNode* doc = dse_yaml_compact_doc(c, 0);
+    const YamlCompactNode* models =
+        dse_yaml_compact_find_node(c, doc, "spec/models");
+    assert_int_equal(models->count, 2);
+    const YamlCompactNode* m = dse_yaml_compact_child(c, models, 1);
+    assert_string_equal(dse_yaml_compact_get_scalar(c, m, "model/name"),
+        "DynamicModel");
+    assert_string_equal(dse_yaml_compact_get_scalar(c, m, "uid"), "42");
+    assert_null(dse_yaml_compact_child(c, models, 2));
+
+    dse_yaml_destroy_doc_list(doc_list);
+    dse_yaml_compact_destroy(c);
+
+    /* Duplicate keys, last wins. */
+    c = dse_yaml_compact_load_file(DICT_DUP_FILE);
+    assert_non_null(c);
+    doc = dse_yaml_compact_doc(c, 0);
+    assert_string_equal(
+        dse_yaml_compact_get_scalar(c, doc, "annotations/init_value"), "bar");
+    assert_int_equal(
+        dse_yaml_compact_find_node(c, doc, "annotations")->count, 4);
+    dse_yaml_compact_destroy(c);
+
+    /* Simple arrays. */
+    c = dse_yaml_compact_load_file(FILE);
+    assert_non_null(c);
+    YamlNode* ydoc = dse_yaml_load_single_doc(FILE);
+    doc = dse_yaml_compact_doc(c, 0);
+    for (size_t i = 0; i < ydoc->mapping.number_nodes; i++) {
+        if (ydoc->mapping.nodes[i] == NULL) continue;
+        const char* key = ydoc->mapping.nodes[i]->key;
+        assert_non_null(dse_yaml_compact_find_node(c, doc, key));
+    }
+    dse_yaml_destroy_node(ydoc);
+    dse_yaml_compact_destroy(c);
+
+    /* Missing file. */
+    assert_null(dse_yaml_compact_load_file("util/data/missing.yaml"));
+    dse_yaml_compact_destroy(NULL);
+}
+
+
+void test_yaml_path_compiled(void** state)
+{
+    UNUSED(state);
+
+    YamlDocList* doc_list = dse_yaml_load_file(FILENAME, NULL);
+    assert_non_null(doc_list);
+    YamlNode* doc = hashlist_at(doc_list, 0);
+
+    /* Same results as the uncompiled path. */
+    const char* path[] = { "kind", "metadata/name", "/metadata//name/",
+        "spec/models", "spec/models/missing", "kind/missing", "missing", "" };
+    for (size_t i = 0; i < ARRAY_SIZE(path); i++) {
+        YamlPath* p = dse_yaml_path_compile(path[i]);
+        assert_non_null(p);
+        assert_ptr_equal(dse_yaml_find_node_compiled(doc, p),
+            dse_yaml_find_node(doc, path[i]));
+        dse_yaml_path_destroy(p);
+    }
+    YamlPath* p = dse_yaml_path_compile("spec/connection/transport");
+    assert_int_equal(p->count, 3);
+    assert_string_equal(p->segment[2], "transport");
+    dse_yaml_path_destroy(p);
+    assert_null(dse_yaml_path_compile(NULL));
+
+    /* Sequence and doclist queries. */
+    YamlPath*       models = dse_yaml_path_compile("spec/models");
+    YamlPath*       name = dse_yaml_path_compile("name");
+    YamlPath*       uid = dse_yaml_path_compile("uid");
+    const YamlPath* selector[] = { name, uid };
+    const char*     value[] = { "dynamic_model_instance", "42" };
+    YamlNode*       node =
+        dse_yaml_find_node_in_seq_compiled(doc, models, selector, value, 2);
+    assert_non_null(node);
+    assert_string_equal(
+        dse_yaml_get_scalar(node, "model/name"), "DynamicModel");
+    value[1] = "43";
+    assert_null(
+        dse_yaml_find_node_in_seq_compiled(doc, models, selector, value, 2));
+
+    YamlPath* foo = dse_yaml_path_compile("foo");
+    YamlPath* foo1 = dse_yaml_path_compile("foo1");
+    node = dse_yaml_find_node_in_doclist_compiled(doc_list, "abc", foo);
+    assert_non_null(node);
+    assert_string_equal(node->scalar, "abc");
+    const YamlPath* doc_selector[] = { foo, foo1 };
+    const char*     doc_value[] = { "abc", "efg" };
+    node = dse_yaml_find_doc_in_doclist_compiled(
+        doc_list, "abc", doc_selector, doc_value, 2);
+    assert_ptr_equal(node, hashlist_at(doc_list, 2));
+    node = dse_yaml_find_doc_in_doclist_compiled(
+        doc_list, "Model", doc_selector, doc_value, 0);
+    assert_ptr_equal(node, hashlist_at(doc_list, 1));
+
+    dse_yaml_path_destroy(foo1);
+    dse_yaml_path_destroy(foo);
+    dse_yaml_path_destroy(uid);
+    dse_yaml_path_destroy(name);
+    dse_yaml_path_destroy(models);
+    dse_yaml_destroy_doc_list(doc_list);
+}
+
+
+void test_yaml_doc_index(void** state)
+{
+    UNUSED(state);
+
+    YamlDocList*  doc_list = dse_yaml_load_file(FILENAME, NULL);
+    const char*   indexed[] = { "foo" };
+    YamlDocIndex* index = dse_yaml_doc_index_create(doc_list, indexed, 1);
+    assert_non_null(index);
+
+    /* Same results as the doclist functions. */
+    struct {
+        const char* kind;
+        const char* selector[2];
+        const char* value[2];
+        uint32_t    len;
+    } tc[] = {
+        { "Stack", { "metadata/name" }, { "dynamic_model_stack" }, 1 },
+        { "Model", { "metadata/name" }, { "simbus" }, 1 },
+        { "Model", { "metadata/name" }, { "dynamic_model_stack" }, 1 },
+        { "Model", { 0 }, { 0 }, 0 },
+        { "abc", { "foo", "foo1" }, { "abc", "efg" }, 2 },
+        { "abc", { "foo1", "foo" }, { "efg", "abc" }, 2 },
+        { "abc", { "foo1" }, { "efg" }, 1 },
+        { "abc", { "foo1" }, { "xyz" }, 1 },
+        { "Stack", { "spec/models" }, { "none" }, 1 },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(tc); i++) {
+        YamlNode* expect = dse_yaml_find_doc_in_doclist(
+            doc_list, tc[i].kind, tc[i].selector, tc[i].value, tc[i].len);
+        YamlNode* doc = dse_yaml_find_doc_in_doc_index(
+            index, tc[i].kind, tc[i].selector, tc[i].value, tc[i].len);
+        assert_ptr_equal(doc, expect);
+    }
+    const char* path[][2] = { { "Stack", "spec/models" },
+        { "Model", "metadata/name" }, { "Model", "foo" },
+        { "Model", "missing" } };
+    for (size_t i = 0; i < ARRAY_SIZE(path); i++) {
+        assert_ptr_equal(
+            dse_yaml_find_node_in_doc_index(index, path[i][0], path[i][1]),
+            dse_yaml_find_node_in_doclist(doc_list, path[i][0], path[i][1]));
+    }
+
+    /* Documents appended to the doc list are indexed. */
+    const char* selector[] = { "metadata/name" };
+    const char* value[] = { "simbus" };
+    doc_list = dse_yaml_load_file(FILENAME, doc_list);
+    assert_int_equal(hashlist_length(doc_list), 6);
+    YamlNode* doc =
+        dse_yaml_find_doc_in_doc_index(index, "Model", selector, value, 1);
+    assert_ptr_equal(doc, hashlist_at(doc_list, 1));
+
+    dse_yaml_doc_index_destroy(index);
+    dse_yaml_destroy_doc_list(doc_list);
+    assert_null(dse_yaml_doc_index_create(NULL, NULL, 0));
+    dse_yaml_doc_index_destroy(NULL);
+}
+
+
+void test_yaml_load_files(void** state)
+{
+    UNUSED(state);
+
+    const char* files[] = { FILENAME, FILE, EMPTY_FILE, UINT_FILE,
+        DICT_DUP_FILE, FILENAME };
+    YamlDocList* expect = NULL;
+    for (size_t i = 0; i < ARRAY_SIZE(files); i++) {
+        expect = dse_yaml_load_file(files[i], expect);
+    }
+
+    size_t threads[] = { 0, 1, 4 };
+    for (size_t t = 0; t < ARRAY_SIZE(threads); t++) {
+        YamlDocList* doc_list = dse_yaml_load_files(
+            files, ARRAY_SIZE(files), NULL, threads[t]);
+        assert_non_null(doc_list);
+        assert_int_equal(errno, 0);
+        assert_int_equal(hashlist_length(doc_list), hashlist_length(expect));
+        /* Same documents, in the same order. */
+        for (uint32_t i = 0; i < hashlist_length(doc_list); i++) {
+            YamlNode* doc = hashlist_at(doc_list, i);
+            YamlNode* e = hashlist_at(expect, i);
+            assert_int_equal(doc->node_type, e->node_type);
+            const char* paths[] = { "kind", "metadata/name", "foo",
+                "annotations/init_value" };
+            for (size_t p = 0; p < ARRAY_SIZE(paths); p++) {
+                const char* a = dse_yaml_get_scalar(doc, paths[p]);
+                const char* b = dse_yaml_get_scalar(e, paths[p]);
+                if (b == NULL) {
+                    assert_null(a);
+                } else {
+                    assert_string_equal(a, b);
+                }
+            }
+        }
+        dse_yaml_destroy_doc_list(doc_list);
+    }
+
+    /* Append to an existing list, with a missing file. */
+    const char*  more[] = { UINT_FILE, "util/data/missing.yaml" };
+    YamlDocList* doc_list = dse_yaml_load_file(FILENAME, NULL);
+    doc_list = dse_yaml_load_files(more, ARRAY_SIZE(more), doc_list, 2);
+    assert_int_not_equal(errno, 0);
+    assert_int_equal(hashlist_length(doc_list), 4);
+    assert_string_equal(
+        dse_yaml_get_scalar(hashlist_at(doc_list, 3), "foo"), "123");
+
+    dse_yaml_destroy_doc_list(doc_list);
+    dse_yaml_destroy_doc_list(expect);
+}
+
+
+static void _copy_file(const char* from, const char* to, const char* append)
+{
+    /* Note: FILE is redefined in this test. */
+    char    buf[4096];
+    int     in = open(from, O_RDONLY);
+    int     out = open(to, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ssize_t n;
+    assert_true(in >= 0);
+    assert_true(out >= 0);
+    while ((n = read(in, buf, sizeof(buf))) > 0) {
+        assert_int_equal(write(out, buf, n), n);
+    }
+    if (append) {
+        n = strlen(append);
+        assert_int_equal(write(out, append, n), n);
+    }
+    close(in);
+    close(out);
+}
+
+
+void test_yaml_compact_snapshot(void** state)
+{
+    UNUSED(state);
+
+    char dir[] = "/tmp/test_yaml_XXXXXX";
+    assert_non_null(mkdtemp(dir));
+    char source[64];
+    char snapshot[64];
+    snprintf(source, sizeof(source), "%s/test.yaml", dir);
+    snprintf(snapshot, sizeof(snapshot), "%s/test.yaml.snapshot", dir);
+    _copy_file(FILENAME, source, NULL);
+
+    /* No snapshot yet. */
+    assert_null(dse_yaml_compact_load_snapshot(snapshot, source));
+    YamlCompact* c = dse_yaml_compact_load_cached(source, snapshot);
+    assert_non_null(c);
+    size_t size = dse_yaml_compact_size(c);
+    dse_yaml_compact_destroy(c);
+
+    /* Snapshot is mapped. */
+    c = dse_yaml_compact_load_snapshot(snapshot, source);
+    assert_non_null(c);
+    assert_int_equal(dse_yaml_compact_size(c), size);
+    assert_int_equal(dse_yaml_compact_doc_count(c), 3);
+    const YamlCompactNode* doc = dse_yaml_compact_doc(c, 0);
+    assert_string_equal(dse_yaml_compact_get_scalar(c, doc,
+                            "spec/connection/transport/redispubsub/uri"),
+        "redis://localhost:6379");
+
+    /* Conversion to YamlNode documents. */
+    YamlDocList* doc_list = dse_yaml_compact_to_doc_list(c, NULL);
+    YamlDocList* expect = dse_yaml_load_file(FILENAME, NULL);
+    assert_int_equal(hashlist_length(doc_list), hashlist_length(expect));
+    YamlNode*   ydoc = hashlist_at(doc_list, 0);
+    const char* selector[] = { "name" };
+    const char* value[] = { "dynamic_model_instance" };
+    YamlNode*   node =
+        dse_yaml_find_node_in_seq(ydoc, "spec/models", selector, value, 1);
+    assert_non_null(node);
+    assert_string_equal(dse_yaml_get_scalar(node, "uid"), "42");
+    assert_null(dse_yaml_get_scalar(node, "channels/alias"));
+    node = dse_yaml_find_node_in_doclist(doc_list, "abc", "bar");
+    assert_int_equal(hashlist_length(&node->sequence), 2);
+    dse_yaml_destroy_doc_list(expect);
+    dse_yaml_destroy_doc_list(doc_list);
+    dse_yaml_compact_destroy(c);
+
+    /* Modified source, the snapshot is stale. */
+    _copy_file(FILENAME, source, "---\nkind: Extra\n");
+    assert_null(dse_yaml_compact_load_snapshot(snapshot, source));
+    assert_int_equal(errno, ESTALE);
+    c = dse_yaml_compact_load_cached(source, snapshot);
+    assert_int_equal(dse_yaml_compact_doc_count(c), 4);
+    dse_yaml_compact_destroy(c);
+    c = dse_yaml_compact_load_snapshot(snapshot, source);
+    assert_non_null(c);
+    assert_int_equal(dse_yaml_compact_doc_count(c), 4);
+    dse_yaml_compact_destroy(c);
+
+    /* Snapshot where a child references its parent (a cycle). The image and
+       child offsets are both at byte 40 of their headers. */
+    int      fd = open(snapshot, O_RDWR);
+    uint64_t image_offset;
+    uint64_t child_offset;
+    uint32_t parent = 0;
+    assert_true(fd >= 0);
+    assert_int_equal(pread(fd, &image_offset, 8, 40), 8);
+    assert_int_equal(pread(fd, &child_offset, 8, image_offset + 40), 8);
+    assert_int_equal(pwrite(fd, &parent, 4, image_offset + child_offset), 4);
+    close(fd);
+    assert_null(dse_yaml_compact_load_snapshot(snapshot, source));
+    assert_int_equal(errno, EINVAL);
+
+    /* Corrupt snapshot. */
+    _copy_file(FILENAME, snapshot, NULL);
+    assert_null(dse_yaml_compact_load_snapshot(snapshot, source));
+    assert_int_equal(errno, EINVAL);
+
+    unlink(snapshot);
+    unlink(source);
+    rmdir(dir);
+}
+
+
+void test_yaml_query_file(void** state)
+{
+    UNUSED(state);
+
+    const char* path[] = { "spec/models", "metadata/name", "foo", "bar",
+        "kind", "spec/connection/transport/redispubsub/timeout", "missing",
+        "spec/models/name" };
+    YamlNode*   node[ARRAY_SIZE(path)];
+    int rc = dse_yaml_query_file(FILENAME, path, node, ARRAY_SIZE(path));
+    assert_int_equal(rc, 0);
+
+    /* Same subtrees as the first document containing each path. */
+    YamlDocList* doc_list = dse_yaml_load_file(FILENAME, NULL);
+    for (size_t i = 0; i < ARRAY_SIZE(path); i++) {
+        YamlNode* expect = NULL;
+        for (uint32_t d = 0; d < hashlist_length(doc_list) && !expect; d++) {
+            expect = dse_yaml_find_node(hashlist_at(doc_list, d), path[i]);
+        }
+        if (i >= 6) {
+            /* Missing, or a path into a sequence. */
+            assert_null(node[i]);
+            continue;
+        }
+        assert_non_null(node[i]);
+        assert_null(node[i]->parent);
+        assert_int_equal(node[i]->node_type, expect->node_type);
+        assert_string_equal(node[i]->name, expect->name);
+        if (expect->scalar) {
+            assert_string_equal(node[i]->scalar, expect->scalar);
+        }
+    }
+    assert_string_equal(node[1]->scalar, "dynamic_model_stack");
+    assert_string_equal(node[4]->scalar, "Stack");
+    assert_string_equal(node[5]->scalar, "60");
+    assert_int_equal(hashlist_length(&node[0]->sequence), 2);
+    const char* selector[] = { "name" };
+    const char* value[] = { "dynamic_model_instance" };
+    YamlNode*   m = dse_yaml_find_node_in_seq(node[0], "", selector, value, 1);
+    assert_non_null(m);
+    assert_non_null(dse_yaml_find_node(m, "channels"));
+    assert_int_equal(hashlist_length(&node[3]->sequence), 2);
+    assert_string_equal(
+        dse_yaml_get_scalar(hashlist_at(&node[3]->sequence, 1), "b"),
+        "second");
+    for (size_t i = 0; i < ARRAY_SIZE(path); i++) {
+        dse_yaml_destroy_node(node[i]);
+    }
+    dse_yaml_destroy_doc_list(doc_list);
+
+    /* Whole document (empty path), and a missing file. */
+    const char* root[] = { "" };
+    rc = dse_yaml_query_file(UINT_FILE, root, node, 1);
+    assert_int_equal(rc, 0);
+    assert_non_null(node[0]);
+    assert_string_equal(dse_yaml_get_scalar(node[0], "foo2/foo3"),
+        "${FOO3:-42}");
+    dse_yaml_destroy_node(node[0]);
+    rc = dse_yaml_query_file("util/data/missing.yaml", root, node, 1);
+    assert_int_equal(rc, EINVAL);
+    assert_null(node[0]);
+}
+
+
 int run_yaml_tests(void)
 {
     const struct CMUnitTest tests[] = {
@@ -444,9 +1033,19 @@ int run_yaml_tests(void)
         cmocka_unit_test(test_yaml_get_double),
         cmocka_unit_test(test_yaml_get_bool),
         cmocka_unit_test(test_yaml_get_string),
+        cmocka_unit_test(test_yaml_get_values),
+        cmocka_unit_test(test_yaml_get_values_paths),
+        cmocka_unit_test(test_yaml_get_cached),
         cmocka_unit_test(test_yaml_get_parser),
         cmocka_unit_test(test_yaml_duplicated_dict_entry),
         cmocka_unit_test(test_yaml_interpolation),
+        cmocka_unit_test(test_yaml_interpolation_tree),
+        cmocka_unit_test(test_yaml_compact),
+        cmocka_unit_test(test_yaml_path_compiled),
+        cmocka_unit_test(test_yaml_doc_index),
+        cmocka_unit_test(test_yaml_load_files),
+        cmocka_unit_test(test_yaml_compact_snapshot),
+        cmocka_unit_test(test_yaml_query_file),
     };
 
     return cmocka_run_group_tests_name("YAML", tests, NULL, NULL);